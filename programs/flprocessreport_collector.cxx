@@ -0,0 +1,316 @@
+// flprocessreport_collector.cxx
+//
+// Collect the counters pushed by the process report modules of the jobs
+// running on the same node (see the module 'live.socket' property) and
+// print a combined cut flow and throughput report on demand (SIGUSR1),
+// every given interval and at exit (SIGINT, SIGTERM).
+//
+// Usage: flprocessreport-collector <socket path> [report interval in seconds]
+//
+// A single receiver thread decodes the messages and adds them to atomic
+// counters; the report reads them without locking the receiver. Counters of
+// a cut whose name is not known yet, e.g. when the collector started after
+// the job, are kept until the job sends its cut names again. Cuts beyond
+// MAX_CUTS distinct names are dropped, and counted in the report.
+
+// Standard library:
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// System:
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// This project:
+#include <falaise/snemo/processing/live_publisher.h>
+
+typedef snemo::processing::live_publisher publisher_type;
+
+namespace {
+
+  /// Combined counters: written by the receiver thread only
+  struct aggregate_type
+  {
+    static const size_t MAX_CUTS = 4096;
+    static const size_t NCOUNTERS = publisher_type::COUNTERS_PER_CUT;
+
+    aggregate_type() : events(0), messages(0), invalid(0), jobs(0), ncuts(0), dropped_cuts(0)
+    {
+      for (size_t i = 0; i < MAX_CUTS * NCOUNTERS; i++) counters[i] = 0;
+    }
+
+    std::atomic<uint64_t> events;              //!< Number of events
+    std::atomic<uint64_t> messages;            //!< Number of received messages
+    std::atomic<uint64_t> invalid;             //!< Number of invalid messages
+    std::atomic<size_t> jobs;                  //!< Number of distinct jobs
+    std::atomic<size_t> ncuts;                 //!< Number of published cuts
+    std::atomic<size_t> dropped_cuts;          //!< Number of cuts beyond MAX_CUTS
+    std::string names[MAX_CUTS];               //!< Cut names, immutable once published
+    char group_start[MAX_CUTS];                //!< Cuts starting a serie
+    std::atomic<uint64_t> counters[MAX_CUTS * NCOUNTERS]; //!< Cut counters
+  };
+
+  /// Cut names table of a job, known to the receiver thread only
+  struct table_type
+  {
+    std::vector<int> cuts;          //!< Aggregate index per job index, -1: unknown name, -2: dropped
+    std::vector<uint64_t> pending;  //!< Counters received before the name of their cut
+  };
+
+  /// Receiver thread state
+  struct receiver_type
+  {
+    static const size_t MAX_TABLE_CUTS = 1 << 20; //!< Size limit of the table of a job
+
+    std::map<std::string, size_t> indexes;  //!< Aggregate index per cut name
+    std::set<std::string> dropped;          //!< Cut names beyond MAX_CUTS
+    std::set<std::string> jobs;             //!< Job identifiers
+    std::map<std::string, table_type> tables; //!< Tables per job and version
+  };
+
+  std::atomic<bool> stop_requested(false);
+
+  /// Return the table of a version of the cut names of a job
+  table_type & table_of(receiver_type & receiver_, const std::string & job_, const uint32_t version_)
+  {
+    return receiver_.tables[job_ + "#" + std::to_string(version_)];
+  }
+
+  void add_counters(aggregate_type & aggregate_, const size_t index_, const uint64_t * counters_)
+  {
+    for (size_t j = 0; j < aggregate_type::NCOUNTERS; j++) {
+      aggregate_.counters[index_ * aggregate_type::NCOUNTERS + j]
+        .fetch_add(counters_[j], std::memory_order_relaxed);
+    }
+    return;
+  }
+
+  bool add_names(receiver_type & receiver_, const publisher_type::names_type & names_,
+                 aggregate_type & aggregate_)
+  {
+    if (names_.ncuts > receiver_type::MAX_TABLE_CUTS) return false;
+    table_type & table = table_of(receiver_, names_.job, names_.version);
+    if (table.cuts.size() < names_.ncuts) table.cuts.resize(names_.ncuts, -1);
+    for (size_t i = 0; i < names_.names.size(); i++) {
+      const size_t job_index = names_.first + i;
+      if (table.cuts[job_index] != -1) continue;
+      const std::string & a_name = names_.names[i];
+      std::map<std::string, size_t>::iterator found = receiver_.indexes.find(a_name);
+      if (found != receiver_.indexes.end()) {
+        table.cuts[job_index] = found->second;
+      } else if (receiver_.indexes.size() < aggregate_type::MAX_CUTS) {
+        const size_t index = receiver_.indexes.size();
+        receiver_.indexes[a_name] = index;
+        aggregate_.names[index]       = a_name;
+        aggregate_.group_start[index] = names_.group_start[i];
+        // Readers only see the new cut once its name is written
+        aggregate_.ncuts.store(index + 1, std::memory_order_release);
+        table.cuts[job_index] = index;
+      } else {
+        table.cuts[job_index] = -2;
+        if (receiver_.dropped.insert(a_name).second) {
+          aggregate_.dropped_cuts.store(receiver_.dropped.size(), std::memory_order_relaxed);
+        }
+      }
+      // Counters received before the name
+      const size_t offset = job_index * aggregate_type::NCOUNTERS;
+      if (table.cuts[job_index] >= 0 && offset < table.pending.size()) {
+        add_counters(aggregate_, table.cuts[job_index], &table.pending[offset]);
+        std::fill(table.pending.begin() + offset, table.pending.begin() + offset + aggregate_type::NCOUNTERS, 0);
+      }
+    }
+    return true;
+  }
+
+  bool add_delta(receiver_type & receiver_, const publisher_type::delta_type & delta_,
+                 aggregate_type & aggregate_)
+  {
+    for (size_t i = 0; i < delta_.indexes.size(); i++) {
+      if (delta_.indexes[i] >= receiver_type::MAX_TABLE_CUTS) return false;
+    }
+    table_type & table = table_of(receiver_, delta_.job, delta_.version);
+    for (size_t i = 0; i < delta_.indexes.size(); i++) {
+      const size_t job_index = delta_.indexes[i];
+      const uint64_t * counters = &delta_.counters[i * aggregate_type::NCOUNTERS];
+      if (job_index < table.cuts.size() && table.cuts[job_index] != -1) {
+        if (table.cuts[job_index] >= 0) add_counters(aggregate_, table.cuts[job_index], counters);
+        continue;
+      }
+      const size_t offset = job_index * aggregate_type::NCOUNTERS;
+      if (table.pending.size() < offset + aggregate_type::NCOUNTERS) {
+        table.pending.resize(offset + aggregate_type::NCOUNTERS, 0);
+      }
+      for (size_t j = 0; j < aggregate_type::NCOUNTERS; j++) table.pending[offset + j] += counters[j];
+    }
+    aggregate_.events.fetch_add(delta_.events, std::memory_order_relaxed);
+    return true;
+  }
+
+  void receive(const int fd_, aggregate_type & aggregate_)
+  {
+    receiver_type receiver;
+    std::vector<char> buffer(1 << 20);
+    publisher_type::names_type names;
+    publisher_type::delta_type delta;
+    while (! stop_requested.load()) {
+      const ssize_t size = ::recv(fd_, &buffer[0], buffer.size(), 0);
+      if (size < 0) continue; // Timeout: check the stop request
+      const publisher_type::message_type type = publisher_type::decode(&buffer[0], size, names, delta);
+      bool valid = false;
+      if (type == publisher_type::MESSAGE_NAMES) {
+        valid = add_names(receiver, names, aggregate_);
+      } else if (type == publisher_type::MESSAGE_COUNTERS) {
+        valid = add_delta(receiver, delta, aggregate_);
+      }
+      if (! valid) {
+        aggregate_.invalid.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      const std::string & job = (type == publisher_type::MESSAGE_NAMES ? names.job : delta.job);
+      if (receiver.jobs.insert(job).second) {
+        aggregate_.jobs.store(receiver.jobs.size(), std::memory_order_relaxed);
+      }
+      aggregate_.messages.fetch_add(1, std::memory_order_relaxed);
+    }
+    return;
+  }
+
+  double seconds_since(const std::chrono::steady_clock::time_point & start_)
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+  void render(const aggregate_type & aggregate_, const double elapsed_,
+              const double interval_, const uint64_t previous_events_, std::ostream & out_)
+  {
+    const uint64_t events = aggregate_.events.load(std::memory_order_relaxed);
+    out_ << "Combined report of " << aggregate_.jobs.load(std::memory_order_relaxed) << " jobs ("
+         << aggregate_.messages.load(std::memory_order_relaxed) << " messages, "
+         << aggregate_.invalid.load(std::memory_order_relaxed) << " invalid)" << std::endl;
+    out_ << std::fixed << std::setprecision(1);
+    out_ << " ↳ Events     : " << events << std::endl;
+    const size_t dropped_cuts = aggregate_.dropped_cuts.load(std::memory_order_relaxed);
+    if (dropped_cuts > 0) {
+      out_ << " ↳ Dropped    : " << dropped_cuts << " cuts beyond the limit of "
+           << aggregate_type::MAX_CUTS << " cuts" << std::endl;
+    }
+    out_ << " ↳ Throughput : " << (elapsed_ > 0.0 ? events / elapsed_ : 0.0) << " Hz since start";
+    if (interval_ > 0.0) {
+      out_ << ", " << (events - previous_events_) / interval_ << " Hz since last report";
+    }
+    out_ << std::endl;
+
+    const size_t ncuts = aggregate_.ncuts.load(std::memory_order_acquire);
+    if (ncuts > 0) {
+      out_ << std::left << std::setw(30) << "Cut" << std::right
+           << std::setw(14) << "processed" << std::setw(14) << "accepted"
+           << std::setw(14) << "rejected" << std::setw(10) << "eff. %" << std::setw(10) << "cumul. %"
+           << std::endl;
+    }
+    uint64_t reference = 0;
+    for (size_t i = 0; i < ncuts; i++) {
+      const std::atomic<uint64_t> * counters = &aggregate_.counters[i * aggregate_type::NCOUNTERS];
+      const uint64_t processed = counters[0].load(std::memory_order_relaxed);
+      const uint64_t accepted  = counters[1].load(std::memory_order_relaxed);
+      const uint64_t rejected  = counters[2].load(std::memory_order_relaxed);
+      if (aggregate_.group_start[i]) reference = processed;
+      out_ << std::left << std::setw(30) << aggregate_.names[i] << std::right
+           << std::setw(14) << processed << std::setw(14) << accepted << std::setw(14) << rejected
+           << std::setw(10) << (processed > 0 ? 100.0 * accepted / processed : 0.0)
+           << std::setw(10) << (reference > 0 ? 100.0 * accepted / reference : 0.0)
+           << std::endl;
+    }
+    out_.unsetf(std::ios::floatfield);
+    out_ << std::endl;
+    return;
+  }
+
+}
+
+int main(int argc_, char ** argv_)
+{
+  if (argc_ < 2) {
+    std::cerr << "Usage: " << argv_[0] << " <socket path> [report interval in seconds]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string socket_path = argv_[1];
+  const double interval = (argc_ > 2 ? std::atof(argv_[2]) : 0.0);
+
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Socket path '" << socket_path << "' is too long !" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+  const int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+  ::unlink(socket_path.c_str());
+  if (fd < 0 || ::bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+    std::cerr << "Cannot listen on '" << socket_path << "' : " << std::strerror(errno) << " !" << std::endl;
+    return EXIT_FAILURE;
+  }
+  // Large receive buffer to absorb bursts, short timeout to see stop requests
+  int buffer_size = 8 << 20;
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+  timeval timeout;
+  timeout.tv_sec  = 0;
+  timeout.tv_usec = 200000;
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  // Signals are handled synchronously by the main thread only
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  sigaddset(&signals, SIGUSR1);
+  pthread_sigmask(SIG_BLOCK, &signals, 0);
+
+  aggregate_type * aggregate = new aggregate_type;
+  std::thread receiver(receive, fd, std::ref(*aggregate));
+  std::cerr << "Collecting live reports on '" << socket_path << "' (SIGUSR1 to print a report)" << std::endl;
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double last_report = 0.0;
+  uint64_t last_events = 0;
+  while (true) {
+    int signal = 0;
+    if (interval > 0.0) {
+      timespec wait;
+      wait.tv_sec  = (time_t) interval;
+      wait.tv_nsec = (long) ((interval - wait.tv_sec) * 1e9);
+      signal = sigtimedwait(&signals, 0, &wait);
+    } else {
+      sigwait(&signals, &signal);
+    }
+    if (signal == SIGINT || signal == SIGTERM) break;
+    if (signal < 0 && errno != EAGAIN) continue;
+    const double now = seconds_since(start);
+    render(*aggregate, now, now - last_report, last_events, std::cout);
+    last_report = now;
+    last_events = aggregate->events.load(std::memory_order_relaxed);
+  }
+
+  stop_requested.store(true);
+  receiver.join();
+  ::close(fd);
+  ::unlink(socket_path.c_str());
+  const double now = seconds_since(start);
+  render(*aggregate, now, now - last_report, last_events, std::cout);
+  delete aggregate;
+  return EXIT_SUCCESS;
+}
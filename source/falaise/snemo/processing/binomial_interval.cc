@@ -0,0 +1,94 @@
+/// \file falaise/snemo/processing/binomial_interval.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/binomial_interval.h>
+
+// Standard library:
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Third party:
+// - Boost:
+#include <boost/math/special_functions/beta.hpp>
+#include <boost/math/special_functions/erf.hpp>
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    // static
+    binomial_interval::method_type binomial_interval::get_method(const std::string & label_)
+    {
+      if (label_ == get_label(METHOD_WILSON)) return METHOD_WILSON;
+      if (label_ == get_label(METHOD_CLOPPER_PEARSON)) return METHOD_CLOPPER_PEARSON;
+      DT_THROW_IF(true, std::logic_error, "Invalid binomial interval method '" << label_ << "' !");
+      return METHOD_WILSON;
+    }
+
+    // static
+    const std::string & binomial_interval::get_label(const method_type method_)
+    {
+      static const std::string wilson_label("wilson");
+      static const std::string clopper_pearson_label("clopper_pearson");
+      return method_ == METHOD_WILSON ? wilson_label : clopper_pearson_label;
+    }
+
+    // static
+    void binomial_interval::wilson(const uint64_t k_, const uint64_t n_, const double confidence_level_,
+                                   double & low_, double & high_)
+    {
+      if (n_ == 0) {
+        low_  = 0.0;
+        high_ = 1.0;
+        return;
+      }
+      // Two-sided normal quantile
+      const double z = std::sqrt(2.0) * boost::math::erf_inv(confidence_level_);
+      const double n = (double) n_;
+      const double p = (double) k_ / n;
+      const double z2n = z * z / n;
+      const double center = (p + 0.5 * z2n) / (1.0 + z2n);
+      const double half = z / (1.0 + z2n) * std::sqrt(p * (1.0 - p) / n + 0.25 * z2n / n);
+      low_  = std::max(0.0, center - half);
+      high_ = std::min(1.0, center + half);
+      return;
+    }
+
+    // static
+    void binomial_interval::clopper_pearson(const uint64_t k_, const uint64_t n_, const double confidence_level_,
+                                            double & low_, double & high_)
+    {
+      if (n_ == 0) {
+        low_  = 0.0;
+        high_ = 1.0;
+        return;
+      }
+      const double alpha = 1.0 - confidence_level_;
+      const double k = (double) k_;
+      const double n = (double) n_;
+      low_  = (k_ == 0  ? 0.0 : boost::math::ibeta_inv(k, n - k + 1.0, 0.5 * alpha));
+      high_ = (k_ == n_ ? 1.0 : boost::math::ibeta_inv(k + 1.0, n - k, 1.0 - 0.5 * alpha));
+      return;
+    }
+
+    // static
+    void binomial_interval::compute(const method_type method_,
+                                    const uint64_t k_, const uint64_t n_, const double confidence_level_,
+                                    double & low_, double & high_)
+    {
+      if (method_ == METHOD_CLOPPER_PEARSON) {
+        clopper_pearson(k_, n_, confidence_level_, low_, high_);
+      } else {
+        wilson(k_, n_, confidence_level_, low_, high_);
+      }
+      return;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/binomial_interval.cc
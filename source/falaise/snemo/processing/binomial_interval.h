@@ -0,0 +1,83 @@
+/// \file falaise/snemo/processing/binomial_interval.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Binomial confidence intervals on an efficiency k/n: the Wilson score
+ *   interval, cheap enough to be evaluated at every snapshot, and the exact
+ *   Clopper-Pearson interval computed from quantiles of the beta law.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_BINOMIAL_INTERVAL_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_BINOMIAL_INTERVAL_H 1
+
+// Standard library
+#include <string>
+#include <stdint.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Binomial confidence intervals
+    class binomial_interval
+    {
+    public:
+
+      /// Interval method
+      enum method_type {
+        METHOD_WILSON          = 0,
+        METHOD_CLOPPER_PEARSON = 1
+      };
+
+      /// Return the method from its label ('wilson' or 'clopper_pearson')
+      static method_type get_method(const std::string & label_);
+
+      /// Return the label of a method
+      static const std::string & get_label(const method_type method_);
+
+      /// Wilson score interval
+      static void wilson(const uint64_t k_, const uint64_t n_, const double confidence_level_,
+                         double & low_, double & high_);
+
+      /// Clopper-Pearson exact interval
+      static void clopper_pearson(const uint64_t k_, const uint64_t n_, const double confidence_level_,
+                                  double & low_, double & high_);
+
+      /// Compute an interval with a given method
+      static void compute(const method_type method_,
+                          const uint64_t k_, const uint64_t n_, const double confidence_level_,
+                          double & low_, double & high_);
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_BINOMIAL_INTERVAL_H
+
+// end of falaise/snemo/processing/binomial_interval.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
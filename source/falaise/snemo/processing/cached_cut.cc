@@ -0,0 +1,165 @@
+/// \file falaise/snemo/processing/cached_cut.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/cached_cut.h>
+
+// Standard library:
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <time.h>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/things.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    // Registration instantiation macro :
+    CUT_REGISTRATION_IMPLEMENT(cached_cut, "snemo::processing::cached_cut")
+
+    namespace {
+
+      /// Generation shared by all cached cuts, 0 until a first invalidation
+      std::atomic<uint64_t> & the_generation()
+      {
+        static std::atomic<uint64_t> generation(0);
+        return generation;
+      }
+
+      int64_t thread_cpu_ns()
+      {
+        struct timespec ts;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+      }
+
+    }
+
+    // static
+    void cached_cut::invalidate_all()
+    {
+      the_generation().fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    const std::string & cached_cut::get_cached_cut_name() const
+    {
+      return _cached_cut_name_;
+    }
+
+    uint64_t cached_cut::get_number_of_hits() const
+    {
+      return _hits_;
+    }
+
+    uint64_t cached_cut::get_number_of_misses() const
+    {
+      return _misses_;
+    }
+
+    int64_t cached_cut::get_evaluation_time() const
+    {
+      return _evaluation_ns_;
+    }
+
+    double cached_cut::get_saved_time() const
+    {
+      if (_misses_ == 0) return 0.0;
+      return (double) _hits_ * _evaluation_ns_ / _misses_;
+    }
+
+    cached_cut::cached_cut(datatools::logger::priority logging_priority_)
+      : cuts::i_cut(logging_priority_)
+    {
+      _set_defaults();
+      return;
+    }
+
+    cached_cut::~cached_cut()
+    {
+      if (is_initialized()) this->cached_cut::reset();
+      return;
+    }
+
+    void cached_cut::_set_defaults()
+    {
+      _cached_cut_name_.clear();
+      _cached_cut_.reset();
+      _record_        = 0;
+      _generation_    = 0;
+      _decision_      = cuts::SELECTION_INAPPLICABLE;
+      _hits_          = 0;
+      _misses_        = 0;
+      _evaluation_ns_ = 0;
+      return;
+    }
+
+    void cached_cut::initialize(const datatools::properties & configuration_,
+                                datatools::service_manager & /* service_manager_ */,
+                                cuts::cut_handle_dict_type & cut_dict_)
+    {
+      DT_THROW_IF(is_initialized(), std::logic_error,
+                  "Cut named '" << get_name() << "' is already initialized !");
+      this->i_cut::_common_initialize(configuration_);
+
+      DT_THROW_IF(! configuration_.has_key("cut"), std::logic_error,
+                  "Missing 'cut' property in cut '" << get_name() << "' !");
+      _cached_cut_name_ = configuration_.fetch_string("cut");
+      cuts::cut_handle_dict_type::iterator found = cut_dict_.find(_cached_cut_name_);
+      DT_THROW_IF(found == cut_dict_.end(), std::logic_error,
+                  "Can't find any cut named '" << _cached_cut_name_
+                  << "' from the external dictionnary for cut '" << get_name() << "' !");
+      _cached_cut_ = found->second.grab_initialized_cut_handle();
+
+      _set_initialized(true);
+      return;
+    }
+
+    void cached_cut::reset()
+    {
+      _set_defaults();
+      this->i_cut::_reset();
+      _set_initialized(false);
+      return;
+    }
+
+    int cached_cut::_accept()
+    {
+      DT_THROW_IF(! is_user_data_type<datatools::things>(), std::logic_error,
+                  "Cut '" << get_name() << "' only supports 'datatools::things' user data !");
+      datatools::things & data = grab_user_data<datatools::things>();
+
+      const uint64_t generation = the_generation().load(std::memory_order_relaxed);
+      if (generation != 0 && generation == _generation_ && &data == _record_) {
+        _hits_++;
+        return _decision_;
+      }
+      if (generation == 0 && _misses_ == 0) {
+        DT_LOG_WARNING(get_logging_priority(), "No process report module invalidates the decisions of cut '"
+                       << get_name() << "': they are not cached !");
+      }
+
+      cuts::i_cut & the_cut = _cached_cut_.grab();
+      const int64_t start = thread_cpu_ns();
+      the_cut.set_user_data(data);
+      const int decision = the_cut.process();
+      the_cut.reset_user_data();
+      _evaluation_ns_ += thread_cpu_ns() - start;
+      _misses_++;
+
+      _record_     = &data;
+      _generation_ = generation;
+      _decision_   = decision;
+      return decision;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/cached_cut.cc
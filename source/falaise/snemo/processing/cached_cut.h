@@ -0,0 +1,133 @@
+/// \file falaise/snemo/processing/cached_cut.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   A cut that memoizes the decision of another cut for the current
+ *   event. Composite cuts that share leaf cuts can refer to cached
+ *   wrappers of these leaves so that each leaf is evaluated at most once
+ *   per event, whatever the number of composites using it.
+ *
+ *   Decisions are keyed by the address of the record and a generation
+ *   number that every process report module advances on each record it
+ *   sees: the record itself is never modified. Decisions thus hold until
+ *   the next process report module of the pipeline, which also invalidates
+ *   them between stages: a process report module must separate stages that
+ *   modify the data the wrapped cuts look at. Without any process report
+ *   module in the pipeline, records cannot be told apart and decisions are
+ *   not cached. The CPU time spent in the wrapped cut is measured on cache
+ *   misses to estimate the time saved by hits.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_CACHED_CUT_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_CACHED_CUT_H 1
+
+// Standard library
+#include <string>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/cuts
+#include <bayeux/cuts/i_cut.h>
+
+namespace datatools {
+  class things;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Memoizing wrapper of a cut
+    class cached_cut : public cuts::i_cut
+    {
+    public:
+
+      /// Return the name of the wrapped cut
+      const std::string & get_cached_cut_name() const;
+
+      /// Return the number of decisions taken from the cache
+      uint64_t get_number_of_hits() const;
+
+      /// Return the number of evaluations of the wrapped cut
+      uint64_t get_number_of_misses() const;
+
+      /// Return the CPU time spent evaluating the wrapped cut (ns)
+      int64_t get_evaluation_time() const;
+
+      /// Return the estimated CPU time saved by cache hits (ns)
+      double get_saved_time() const;
+
+      /// Invalidate the decisions of all the cached cuts
+      static void invalidate_all();
+
+      /// Constructor
+      cached_cut(datatools::logger::priority logging_priority_ = datatools::logger::PRIO_FATAL);
+
+      /// Destructor
+      virtual ~cached_cut();
+
+      /// Initialization
+      virtual void initialize(const datatools::properties & configuration_,
+                              datatools::service_manager & service_manager_,
+                              cuts::cut_handle_dict_type & cut_dict_);
+
+      /// Reset
+      virtual void reset();
+
+    protected:
+
+      /// Selection
+      virtual int _accept();
+
+    private:
+
+      /// Set default values to class members
+      void _set_defaults();
+
+    private:
+
+      std::string _cached_cut_name_;      //!< Name of the wrapped cut
+      cuts::cut_handle_type _cached_cut_; //!< Handle of the wrapped cut
+      const datatools::things * _record_; //!< Record of the cached decision
+      uint64_t _generation_;              //!< Generation of the cached decision (0: none)
+      int _decision_;                     //!< Cached decision
+      uint64_t _hits_;                    //!< Number of cache hits
+      uint64_t _misses_;                  //!< Number of cache misses
+      int64_t _evaluation_ns_;            //!< CPU time spent in the wrapped cut
+
+      // Macro to automate the registration of the cut :
+      CUT_REGISTRATION_INTERFACE(cached_cut)
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_CACHED_CUT_H
+
+// end of falaise/snemo/processing/cached_cut.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
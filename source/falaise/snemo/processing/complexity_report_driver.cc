@@ -0,0 +1,734 @@
+/// \file falaise/snemo/processing/complexity_report_driver.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/complexity_report_driver.h>
+
+// This project:
+#include <falaise/snemo/processing/state_io.h>
+
+// Standard library:
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/things.h>
+#include <bayeux/datatools/object_configuration_description.h>
+
+// - Falaise:
+#include <falaise/snemo/datamodels/data_model.h>
+#include <falaise/snemo/datamodels/calibrated_data.h>
+#include <falaise/snemo/datamodels/tracker_clustering_data.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      /// Solve a.x = b by Gaussian elimination with partial pivoting, a being
+      /// a n x n matrix. Return false if a is singular.
+      bool solve(std::vector<double> a_, std::vector<double> b_, const size_t n_,
+                 std::vector<double> & x_)
+      {
+        double scale = 0.0;
+        for (size_t i = 0; i < n_; i++) scale = std::max(scale, std::abs(a_[i * n_ + i]));
+        if (scale <= 0.0) return false;
+        for (size_t col = 0; col < n_; col++) {
+          size_t pivot = col;
+          for (size_t row = col + 1; row < n_; row++) {
+            if (std::abs(a_[row * n_ + col]) > std::abs(a_[pivot * n_ + col])) pivot = row;
+          }
+          if (std::abs(a_[pivot * n_ + col]) <= 1e-12 * scale) return false;
+          if (pivot != col) {
+            for (size_t j = 0; j < n_; j++) std::swap(a_[col * n_ + j], a_[pivot * n_ + j]);
+            std::swap(b_[col], b_[pivot]);
+          }
+          for (size_t row = col + 1; row < n_; row++) {
+            const double f = a_[row * n_ + col] / a_[col * n_ + col];
+            for (size_t j = col; j < n_; j++) a_[row * n_ + j] -= f * a_[col * n_ + j];
+            b_[row] -= f * b_[col];
+          }
+        }
+        x_.assign(n_, 0.0);
+        for (size_t i = n_; i-- > 0;) {
+          double sum = b_[i];
+          for (size_t j = i + 1; j < n_; j++) sum -= a_[i * n_ + j] * x_[j];
+          x_[i] = sum / a_[i * n_ + i];
+        }
+        return true;
+      }
+
+      /// Polynomial fit of the cost of degree 1 or 2 from the moments of a measure
+      bool fit_polynomial(const complexity_report_driver::statistics_type & stats_,
+                          const size_t degree_, std::vector<double> & coefficients_)
+      {
+        const size_t n = degree_ + 1;
+        std::vector<double> a(n * n), b(n);
+        for (size_t i = 0; i < n; i++) {
+          for (size_t j = 0; j < n; j++) a[i * n + j] = stats_.sum_x[i + j];
+          b[i] = stats_.sum_xt[i];
+        }
+        return solve(a, b, n, coefficients_);
+      }
+
+      int64_t steady_ns()
+      {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>
+          (std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+
+    }
+
+    complexity_report_driver::bin_type::bin_type()
+    {
+      events    = 0;
+      sum_cost  = 0.0;
+      sum_cost2 = 0.0;
+      min_cost  = 0.0;
+      max_cost  = 0.0;
+      return;
+    }
+
+    complexity_report_driver::statistics_type::statistics_type()
+    {
+      measure   = MEASURE_CALORIMETER_HITS;
+      bin_width = 1.0;
+      reset();
+      return;
+    }
+
+    void complexity_report_driver::statistics_type::reset()
+    {
+      bins.assign(bins.size(), bin_type());
+      std::fill(sum_x, sum_x + 5, 0.0);
+      std::fill(sum_xt, sum_xt + 3, 0.0);
+      std::fill(sum_log, sum_log + 5, 0.0);
+      return;
+    }
+
+    // static
+    const std::string & complexity_report_driver::get_id()
+    {
+      static const std::string _id("XRD");
+      return _id;
+    }
+
+    // static
+    const std::string & complexity_report_driver::get_measure_name(const measure_type measure_)
+    {
+      static const std::string _names[MEASURE_NBR + 1] = {
+        "calorimeter_hits", "tracker_hits", "clusters", ""
+      };
+      return _names[measure_ < MEASURE_NBR ? measure_ : MEASURE_NBR];
+    }
+
+    void complexity_report_driver::set_initialized(const bool initialized_)
+    {
+      _initialized_ = initialized_;
+      return;
+    }
+
+    bool complexity_report_driver::is_initialized() const
+    {
+      return _initialized_;
+    }
+
+    void complexity_report_driver::set_logging_priority(const datatools::logger::priority priority_)
+    {
+      _logging_priority_ = priority_;
+      return;
+    }
+
+    datatools::logger::priority complexity_report_driver::get_logging_priority() const
+    {
+      return _logging_priority_;
+    }
+
+    uint64_t complexity_report_driver::get_number_of_timed_events() const
+    {
+      return _timed_events_;
+    }
+
+    uint64_t complexity_report_driver::get_number_of_represented_events() const
+    {
+      return _represented_events_;
+    }
+
+    bool complexity_report_driver::is_estimate() const
+    {
+      return _represented_events_ != _timed_events_;
+    }
+
+    const std::vector<complexity_report_driver::statistics_type> &
+    complexity_report_driver::get_statistics() const
+    {
+      return _statistics_;
+    }
+
+    /// Constructor
+    complexity_report_driver::complexity_report_driver()
+    {
+      _set_defaults();
+      return;
+    }
+
+    /// Destructor
+    complexity_report_driver::~complexity_report_driver()
+    {
+      if (is_initialized()) {
+        reset();
+      }
+      return;
+    }
+
+    /// Initialize the driver through configuration properties
+    void complexity_report_driver::initialize(const datatools::properties & setup_)
+    {
+      DT_THROW_IF(is_initialized(), std::logic_error, "Driver is already initialized !");
+
+      // Logging priority
+      datatools::logger::priority lp = datatools::logger::extract_logging_configuration(setup_);
+      DT_THROW_IF(lp == datatools::logger::PRIO_UNDEFINED,
+                  std::logic_error,
+                  "Invalid logging priority level for complexity report driver !");
+      set_logging_priority(lp);
+
+      if (setup_.has_key("CD_label")) {
+        _CD_label_ = setup_.fetch_string("CD_label");
+      }
+
+      if (setup_.has_key("TCD_label")) {
+        _TCD_label_ = setup_.fetch_string("TCD_label");
+      }
+
+      if (setup_.has_key("bins")) {
+        const int nbins = setup_.fetch_integer("bins");
+        DT_THROW_IF(nbins < 1, std::domain_error, "Invalid number of complexity bins " << nbins << " !");
+        _nbins_ = nbins;
+      }
+
+      double bin_width = 1.0;
+      if (setup_.has_key("bin_width")) {
+        bin_width = setup_.fetch_real("bin_width");
+        DT_THROW_IF(bin_width <= 0.0, std::domain_error, "Invalid complexity bin width " << bin_width << " !");
+      }
+
+      std::vector<std::string> measure_names;
+      if (setup_.has_key("measures")) {
+        setup_.fetch("measures", measure_names);
+      } else {
+        for (int i = 0; i < MEASURE_NBR; i++) measure_names.push_back(get_measure_name((measure_type) i));
+      }
+      DT_THROW_IF(measure_names.empty(), std::logic_error, "No complexity measure !");
+
+      for (size_t i = 0; i < measure_names.size(); i++) {
+        const std::string & a_name = measure_names[i];
+        int found = -1;
+        for (int m = 0; m < MEASURE_NBR; m++) {
+          if (a_name == get_measure_name((measure_type) m)) found = m;
+        }
+        DT_THROW_IF(found < 0, std::logic_error, "Unknown complexity measure '" << a_name << "' !");
+        for (size_t j = 0; j < _statistics_.size(); j++) {
+          DT_THROW_IF(_statistics_[j].measure == found, std::logic_error,
+                      "Complexity measure '" << a_name << "' is set twice !");
+        }
+        statistics_type stats;
+        stats.measure   = (measure_type) found;
+        stats.bin_width = bin_width;
+        if (setup_.has_key(a_name + ".bin_width")) {
+          stats.bin_width = setup_.fetch_real(a_name + ".bin_width");
+          DT_THROW_IF(stats.bin_width <= 0.0, std::domain_error,
+                      "Invalid bin width " << stats.bin_width << " for measure '" << a_name << "' !");
+        }
+        stats.bins.assign(_nbins_ + 1, bin_type());
+        _statistics_.push_back(stats);
+      }
+
+      const size_t n = _statistics_.size() + 1;
+      _normal_.assign(n * n, 0.0);
+      _rhs_.assign(n, 0.0);
+      _values_.assign(_statistics_.size(), 0.0);
+
+      set_initialized(true);
+      return;
+    }
+
+    /// Reset the driver
+    void complexity_report_driver::reset()
+    {
+      DT_THROW_IF(! is_initialized(), std::logic_error, "Driver is not initialized !");
+      _set_defaults();
+      return;
+    }
+
+    void complexity_report_driver::_set_defaults()
+    {
+      _initialized_      = false;
+      _logging_priority_ = datatools::logger::PRIO_WARNING;
+      _CD_label_  = snemo::datamodel::data_info::default_calibrated_data_label();
+      _TCD_label_ = snemo::datamodel::data_info::default_tracker_clustering_data_label();
+      _nbins_        = 20;
+      _has_last_     = false;
+      _last_ns_      = 0;
+      _timed_events_ = 0;
+      _represented_events_ = 0;
+      _missing_banks_ = 0;
+      _statistics_.clear();
+      _normal_.clear();
+      _rhs_.clear();
+      _sum_cost2_ = 0.0;
+      _values_.clear();
+      return;
+    }
+
+    void complexity_report_driver::process(const datatools::things & data_, const uint64_t weight_)
+    {
+      const int64_t now = steady_ns();
+      const bool has_last = _has_last_;
+      const double cost = 1e-6 * (now - _last_ns_);
+      _last_ns_  = now;
+      _has_last_ = true;
+      // The first event has no reference time
+      if (! has_last || weight_ == 0) return;
+      if (! _measure_(data_)) {
+        _missing_banks_ += weight_;
+        return;
+      }
+      _fill_(cost, weight_);
+      return;
+    }
+
+    bool complexity_report_driver::_measure_(const datatools::things & data_)
+    {
+      const snemo::datamodel::calibrated_data * cd = 0;
+      const snemo::datamodel::tracker_clustering_data * tcd = 0;
+      for (size_t k = 0; k < _statistics_.size(); k++) {
+        const measure_type measure = _statistics_[k].measure;
+        if (measure == MEASURE_CALORIMETER_HITS || measure == MEASURE_TRACKER_HITS) {
+          if (cd == 0) {
+            if (! data_.has(_CD_label_) || ! data_.is_a<snemo::datamodel::calibrated_data>(_CD_label_)) return false;
+            cd = &data_.get<snemo::datamodel::calibrated_data>(_CD_label_);
+          }
+          _values_[k] = (measure == MEASURE_CALORIMETER_HITS
+                         ? cd->calibrated_calorimeter_hits().size()
+                         : cd->calibrated_tracker_hits().size());
+        } else if (measure == MEASURE_CLUSTERS) {
+          if (tcd == 0) {
+            if (! data_.has(_TCD_label_) || ! data_.is_a<snemo::datamodel::tracker_clustering_data>(_TCD_label_)) return false;
+            tcd = &data_.get<snemo::datamodel::tracker_clustering_data>(_TCD_label_);
+          }
+          _values_[k] = (tcd->has_default_solution()
+                         ? tcd->get_default_solution().get_clusters().size()
+                         : 0);
+        }
+      }
+      return true;
+    }
+
+    void complexity_report_driver::_fill_(const double cost_, const uint64_t weight_)
+    {
+      _timed_events_++;
+      _represented_events_ += weight_;
+      const double t = cost_;
+      const double w = weight_;
+      for (size_t k = 0; k < _statistics_.size(); k++) {
+        statistics_type & stats = _statistics_[k];
+        const double x = _values_[k];
+
+        bin_type & a_bin = stats.bins[std::min((size_t) (x / stats.bin_width), _nbins_)];
+        if (a_bin.events == 0 || t < a_bin.min_cost) a_bin.min_cost = t;
+        if (a_bin.events == 0 || t > a_bin.max_cost) a_bin.max_cost = t;
+        a_bin.events    += weight_;
+        a_bin.sum_cost  += w * t;
+        a_bin.sum_cost2 += w * t * t;
+
+        double xp = w;
+        for (size_t p = 0; p < 5; p++) {
+          stats.sum_x[p] += xp;
+          if (p < 3) stats.sum_xt[p] += xp * t;
+          xp *= x;
+        }
+
+        if (x > 0.0 && t > 0.0) {
+          const double lx = std::log(x);
+          const double lt = std::log(t);
+          stats.sum_log[0] += w;
+          stats.sum_log[1] += w * lx;
+          stats.sum_log[2] += w * lx * lx;
+          stats.sum_log[3] += w * lt;
+          stats.sum_log[4] += w * lx * lt;
+        }
+      }
+
+      // Weighted normal equations of the linear model on (1, x_1, ..., x_d)
+      const size_t n = _rhs_.size();
+      for (size_t i = 0; i < n; i++) {
+        const double ui = w * (i == 0 ? 1.0 : _values_[i - 1]);
+        for (size_t j = 0; j < n; j++) {
+          _normal_[i * n + j] += ui * (j == 0 ? 1.0 : _values_[j - 1]);
+        }
+        _rhs_[i] += ui * t;
+      }
+      _sum_cost2_ += w * t * t;
+      return;
+    }
+
+    bool complexity_report_driver::fit_linear_model(std::vector<double> & coefficients_,
+                                                    double & rms_, double & r2_) const
+    {
+      const size_t n = _rhs_.size();
+      coefficients_.assign(n, 0.0);
+      rms_ = 0.0;
+      r2_  = 0.0;
+      if (n == 0) return false;
+      const double nevents = _normal_[0];
+
+      // Measures that never vary are left out of the model
+      std::vector<size_t> active(1, 0);
+      for (size_t i = 1; i < n; i++) {
+        const double sum  = _normal_[i];
+        const double sum2 = _normal_[i * n + i];
+        if (nevents * sum2 - sum * sum > 1e-9 * nevents * sum2) active.push_back(i);
+      }
+      if (_timed_events_ < active.size() + 1) return false;
+
+      const size_t m = active.size();
+      std::vector<double> a(m * m), b(m), x;
+      for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < m; j++) a[i * m + j] = _normal_[active[i] * n + active[j]];
+        b[i] = _rhs_[active[i]];
+      }
+      if (! solve(a, b, m, x)) return false;
+
+      double ssr = _sum_cost2_;
+      for (size_t i = 0; i < m; i++) {
+        coefficients_[active[i]] = x[i];
+        ssr -= x[i] * b[i];
+      }
+      ssr = std::max(ssr, 0.0);
+      const double sst = _sum_cost2_ - _rhs_[0] * _rhs_[0] / nevents;
+      rms_ = std::sqrt(ssr / nevents);
+      r2_  = (sst > 0.0 ? 1.0 - ssr / sst : 0.0);
+      return true;
+    }
+
+    void complexity_report_driver::report(std::ostream & out_)
+    {
+      out_ << "Event complexity versus processing cost" << std::endl;
+      out_ << " ↳ Timed events              : " << _timed_events_ << std::endl;
+      if (is_estimate()) {
+        out_ << " ↳ Represented events        : " << _represented_events_
+             << " (weighted estimates below)" << std::endl;
+      }
+      if (_missing_banks_ > 0) {
+        out_ << " ↳ Events without needed bank: " << _missing_banks_ << std::endl;
+      }
+      if (_timed_events_ == 0) return;
+
+      const std::ios::fmtflags flags = out_.flags();
+      const std::streamsize precision = out_.precision();
+      out_.setf(std::ios::fixed, std::ios::floatfield);
+      out_ << std::setprecision(4);
+      out_ << " ↳ Mean cost                 : " << _rhs_[0] / _normal_[0] << " ms" << std::endl;
+
+      std::vector<double> coefficients;
+      double rms = 0.0, r2 = 0.0;
+      if (fit_linear_model(coefficients, rms, r2)) {
+        out_ << " ↳ Linear model (ms)         : " << coefficients[0];
+        for (size_t k = 0; k < _statistics_.size(); k++) {
+          out_ << (coefficients[k + 1] < 0.0 ? " - " : " + ") << std::abs(coefficients[k + 1])
+               << " × " << get_measure_name(_statistics_[k].measure);
+        }
+        out_ << std::endl;
+        out_ << " ↳ Residual RMS              : " << rms << " ms (R² = "
+             << std::setprecision(3) << r2 << ")" << std::endl;
+      } else {
+        out_ << " ↳ Linear model              : not enough varying events" << std::endl;
+      }
+
+      for (size_t k = 0; k < _statistics_.size(); k++) {
+        const statistics_type & stats = _statistics_[k];
+        const std::string & a_name = get_measure_name(stats.measure);
+        out_ << " ↳ Measure '" << a_name << "'" << std::endl;
+        out_ << std::setprecision(2);
+        out_ << "   ↳ Mean complexity         : " << stats.sum_x[1] / stats.sum_x[0] << std::endl;
+
+        std::vector<double> c;
+        out_ << std::setprecision(4);
+        if (fit_polynomial(stats, 2, c)) {
+          out_ << "   ↳ Quadratic fit (ms)      : " << c[0]
+               << (c[1] < 0.0 ? " - " : " + ") << std::abs(c[1]) << " x"
+               << (c[2] < 0.0 ? " - " : " + ") << std::abs(c[2]) << " x²" << std::endl;
+        } else if (fit_polynomial(stats, 1, c)) {
+          out_ << "   ↳ Linear fit (ms)         : " << c[0]
+               << (c[1] < 0.0 ? " - " : " + ") << std::abs(c[1]) << " x" << std::endl;
+        }
+
+        const double * l = stats.sum_log;
+        const double den = l[0] * l[2] - l[1] * l[1];
+        if (l[0] >= 3.0 && den > 0.0) {
+          const double exponent = (l[0] * l[4] - l[1] * l[3]) / den;
+          out_ << std::setprecision(2);
+          out_ << "   ↳ Power law exponent      : " << exponent
+               << (exponent > 1.1 ? " (superlinear)" : (exponent < 0.9 ? " (sublinear)" : " (linear)"))
+               << std::endl;
+        }
+
+        out_ << "   ↳ Cost profile" << std::endl;
+        out_ << "     " << std::setw(16) << "complexity" << std::setw(12) << "events"
+             << std::setw(12) << "mean (ms)" << std::setw(12) << "rms (ms)"
+             << std::setw(12) << "min (ms)" << std::setw(12) << "max (ms)" << std::endl;
+        for (size_t b = 0; b < stats.bins.size(); b++) {
+          const bin_type & a_bin = stats.bins[b];
+          if (a_bin.events == 0) continue;
+          std::ostringstream range;
+          range << std::setprecision(stats.bin_width < 1.0 ? 2 : 0) << std::fixed;
+          if (b == _nbins_) {
+            range << "≥ " << b * stats.bin_width;
+          } else if (stats.bin_width == 1.0) {
+            range << b;
+          } else {
+            range << "[" << b * stats.bin_width << ", " << (b + 1) * stats.bin_width << "[";
+          }
+          const double mean = a_bin.sum_cost / a_bin.events;
+          const double variance = std::max(a_bin.sum_cost2 / a_bin.events - mean * mean, 0.0);
+          out_ << "     " << std::setw(16) << range.str() << std::setw(12) << a_bin.events
+               << std::setprecision(3)
+               << std::setw(12) << mean << std::setw(12) << std::sqrt(variance)
+               << std::setw(12) << a_bin.min_cost << std::setw(12) << a_bin.max_cost << std::endl;
+        }
+      }
+      out_.flags(flags);
+      out_.precision(precision);
+      return;
+    }
+
+    void complexity_report_driver::store_state(state_writer & writer_) const
+    {
+      writer_.write_uint64(_timed_events_);
+      writer_.write_uint64(_represented_events_);
+      writer_.write_uint64(_missing_banks_);
+      writer_.write_uint64(_statistics_.size());
+      for (size_t k = 0; k < _statistics_.size(); k++) {
+        const statistics_type & stats = _statistics_[k];
+        writer_.write_uint32(stats.measure);
+        writer_.write_double(stats.bin_width);
+        std::vector<double> values;
+        for (size_t b = 0; b < stats.bins.size(); b++) {
+          const bin_type & a_bin = stats.bins[b];
+          values.push_back(a_bin.events);
+          values.push_back(a_bin.sum_cost);
+          values.push_back(a_bin.sum_cost2);
+          values.push_back(a_bin.min_cost);
+          values.push_back(a_bin.max_cost);
+        }
+        writer_.write_doubles(values);
+        values.assign(stats.sum_x, stats.sum_x + 5);
+        values.insert(values.end(), stats.sum_xt, stats.sum_xt + 3);
+        values.insert(values.end(), stats.sum_log, stats.sum_log + 5);
+        writer_.write_doubles(values);
+      }
+      writer_.write_doubles(_normal_);
+      writer_.write_doubles(_rhs_);
+      writer_.write_double(_sum_cost2_);
+      return;
+    }
+
+    void complexity_report_driver::load_state(state_reader & reader_)
+    {
+      const uint64_t timed_events  = reader_.read_uint64();
+      const uint64_t represented_events = reader_.read_uint64();
+      const uint64_t missing_banks = reader_.read_uint64();
+      const uint64_t nmeasures     = reader_.read_uint64();
+      bool compatible = (nmeasures == _statistics_.size());
+      std::vector<statistics_type> resumed(nmeasures);
+      for (size_t k = 0; k < nmeasures; k++) {
+        statistics_type & stats = resumed[k];
+        stats.measure   = (measure_type) reader_.read_uint32();
+        stats.bin_width = reader_.read_double();
+        std::vector<double> values;
+        reader_.read_doubles(values);
+        stats.bins.resize(values.size() / 5);
+        for (size_t b = 0; b < stats.bins.size(); b++) {
+          bin_type & a_bin = stats.bins[b];
+          a_bin.events    = (uint64_t) values[5 * b];
+          a_bin.sum_cost  = values[5 * b + 1];
+          a_bin.sum_cost2 = values[5 * b + 2];
+          a_bin.min_cost  = values[5 * b + 3];
+          a_bin.max_cost  = values[5 * b + 4];
+        }
+        reader_.read_doubles(values);
+        if (values.size() == 13) {
+          std::copy(values.begin(), values.begin() + 5, stats.sum_x);
+          std::copy(values.begin() + 5, values.begin() + 8, stats.sum_xt);
+          std::copy(values.begin() + 8, values.end(), stats.sum_log);
+        } else {
+          compatible = false;
+        }
+        if (compatible) {
+          const statistics_type & current = _statistics_[k];
+          compatible = (stats.measure == current.measure
+                        && stats.bin_width == current.bin_width
+                        && stats.bins.size() == current.bins.size());
+        }
+      }
+      std::vector<double> normal, rhs;
+      reader_.read_doubles(normal);
+      reader_.read_doubles(rhs);
+      const double sum_cost2 = reader_.read_double();
+      compatible = compatible && normal.size() == _normal_.size() && rhs.size() == _rhs_.size();
+      if (! compatible) {
+        DT_LOG_WARNING(get_logging_priority(), "Resumed complexity measures differ from the configured ones: "
+                       "complexity statistics are not resumed !");
+        return;
+      }
+
+      _timed_events_  += timed_events;
+      _represented_events_ += represented_events;
+      _missing_banks_ += missing_banks;
+      for (size_t k = 0; k < nmeasures; k++) {
+        statistics_type & stats = _statistics_[k];
+        const statistics_type & other = resumed[k];
+        for (size_t b = 0; b < stats.bins.size(); b++) {
+          bin_type & a_bin = stats.bins[b];
+          const bin_type & other_bin = other.bins[b];
+          if (other_bin.events == 0) continue;
+          if (a_bin.events == 0 || other_bin.min_cost < a_bin.min_cost) a_bin.min_cost = other_bin.min_cost;
+          if (a_bin.events == 0 || other_bin.max_cost > a_bin.max_cost) a_bin.max_cost = other_bin.max_cost;
+          a_bin.events    += other_bin.events;
+          a_bin.sum_cost  += other_bin.sum_cost;
+          a_bin.sum_cost2 += other_bin.sum_cost2;
+        }
+        for (size_t p = 0; p < 5; p++) stats.sum_x[p] += other.sum_x[p];
+        for (size_t p = 0; p < 3; p++) stats.sum_xt[p] += other.sum_xt[p];
+        for (size_t p = 0; p < 5; p++) stats.sum_log[p] += other.sum_log[p];
+      }
+      for (size_t i = 0; i < _normal_.size(); i++) _normal_[i] += normal[i];
+      for (size_t i = 0; i < _rhs_.size(); i++) _rhs_[i] += rhs[i];
+      _sum_cost2_ += sum_cost2;
+      return;
+    }
+
+    // static
+    void complexity_report_driver::init_ocd(datatools::object_configuration_description & ocd_)
+    {
+
+      // Prefix "XRD" stands for "compleXity Report Driver" :
+      datatools::logger::declare_ocd_logging_configuration(ocd_, "fatal", "XRD.");
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("XRD.measures")
+          .set_terse_description("The complexity measures related to the event cost")
+          .set_traits(datatools::TYPE_STRING, datatools::configuration_property_description::ARRAY)
+          .set_mandatory(false)
+          .set_long_description("Supported measures are 'calorimeter_hits' and 'tracker_hits'\n"
+                                "from the calibrated data bank, and 'clusters' from the      \n"
+                                "default solution of the tracker clustering data bank. All   \n"
+                                "of them are used by default. Events without a needed bank   \n"
+                                "are counted but not timed.                                  \n")
+          .add_example("Only use the calibrated hits:: \n"
+                       "                          \n"
+                       "  XRD.measures : string[2] = \"calorimeter_hits\" \"tracker_hits\" \n"
+                       "                          \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("XRD.sampling.mode")
+          .set_terse_description("Sampling mode of the events whose complexity is measured")
+          .set_traits(datatools::TYPE_STRING)
+          .set_mandatory(false)
+          .set_default_value_string("all")
+          .set_long_description("Every event is timed, but the banks are only read on the \n"
+                                "sampled ones. Allowed values are 'all', 'every' (with    \n"
+                                "'XRD.sampling.every') and 'bernoulli' (with              \n"
+                                "'XRD.sampling.probability' and 'XRD.sampling.seed'). A   \n"
+                                "measured event represents all the events since the       \n"
+                                "previous one: bin contents and fits are then weighted    \n"
+                                "estimates, labelled as such in the report. Events skipped\n"
+                                "by the overhead throttle are folded the same way into the\n"
+                                "next measured one.                                       \n")
+          .add_example("Measure one event out of 100:: \n"
+                       "                          \n"
+                       "  XRD.sampling.mode : string = \"every\" \n"
+                       "  XRD.sampling.every : integer = 100 \n"
+                       "                          \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("XRD.CD_label")
+          .set_terse_description("The label of the calibrated data bank")
+          .set_traits(datatools::TYPE_STRING)
+          .set_mandatory(false)
+          .set_default_value_string(snemo::datamodel::data_info::default_calibrated_data_label());
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("XRD.TCD_label")
+          .set_terse_description("The label of the tracker clustering data bank")
+          .set_traits(datatools::TYPE_STRING)
+          .set_mandatory(false)
+          .set_default_value_string(snemo::datamodel::data_info::default_tracker_clustering_data_label());
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("XRD.bins")
+          .set_terse_description("Number of complexity bins of the cost profiles")
+          .set_traits(datatools::TYPE_INTEGER)
+          .set_mandatory(false)
+          .set_default_value_integer(20)
+          .set_long_description("An extra bin collects the events beyond the last one. \n"
+                                "Fits do not depend on the binning.                    \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("XRD.bin_width")
+          .set_terse_description("Width of the complexity bins")
+          .set_traits(datatools::TYPE_REAL)
+          .set_mandatory(false)
+          .set_default_value_real(1.0)
+          .set_long_description("It can be set per measure with 'XRD.<measure>.bin_width'.\n")
+          .add_example("Group tracker hits by 5:: \n"
+                       "                          \n"
+                       "  XRD.tracker_hits.bin_width : real = 5 \n"
+                       "                          \n");
+      }
+
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+/* OCD support */
+#include <bayeux/datatools/object_configuration_description.h>
+DOCD_CLASS_IMPLEMENT_LOAD_BEGIN(snemo::processing::complexity_report_driver,ocd_)
+{
+  ocd_.set_class_name("snemo::processing::complexity_report_driver");
+  ocd_.set_class_description("A driver class to relate the event processing cost to the event complexity");
+  ocd_.set_class_library("Falaise_ProcessReport");
+  ocd_.set_class_documentation("This driver fits the processing cost of the events against \n"
+                               "their number of hits and clusters.                        \n");
+
+  // Invoke specific OCD support :
+  ::snemo::processing::complexity_report_driver::init_ocd(ocd_);
+
+  ocd_.set_validation_support(true);
+  ocd_.lock();
+  return;
+}
+DOCD_CLASS_IMPLEMENT_LOAD_END() // Closing macro for implementation
+DOCD_CLASS_SYSTEM_REGISTRATION(snemo::processing::complexity_report_driver,
+                               "snemo::processing::complexity_report_driver")
+
+// end of falaise/snemo/processing/complexity_report_driver.cc
@@ -0,0 +1,216 @@
+/// \file falaise/snemo/processing/complexity_report_driver.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   A driver class that relates the processing cost of the events to their
+ *   complexity. The cost of an event is the wall time of the pipeline since
+ *   the previous event; its complexity is given by configurable measures
+ *   read from the event banks (calorimeter hits, tracker hits, clusters).
+ *
+ *   For each measure, the cost is profiled in complexity bins and the exact
+ *   moments needed by the fits are accumulated: a quadratic fit and a power
+ *   law exponent tell whether the cost scales linearly or not. A linear
+ *   model of the cost with all the measures gives the time per hit used to
+ *   predict the wall time of a job from its input. Events are timed on
+ *   every call but reading the banks may be skipped on some of them, by a
+ *   sampling policy or the overhead throttle. A measured event then
+ *   carries the weight of the events it represents: bin contents, means
+ *   and fits are estimates over all the events.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_COMPLEXITY_REPORT_DRIVER_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_COMPLEXITY_REPORT_DRIVER_H 1
+
+// Standard library
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/datatools
+#include <bayeux/datatools/logger.h>
+
+namespace datatools {
+  class properties;
+  class things;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    class state_writer;
+    class state_reader;
+
+    /// \brief Event complexity versus processing cost report driver
+    class complexity_report_driver
+    {
+    public:
+
+      /// Complexity measure type
+      enum measure_type {
+        MEASURE_CALORIMETER_HITS = 0,
+        MEASURE_TRACKER_HITS     = 1,
+        MEASURE_CLUSTERS         = 2,
+        MEASURE_NBR              = 3
+      };
+
+      /// Cost statistics in a complexity bin
+      struct bin_type
+      {
+        bin_type();
+        uint64_t events;   //!< Number of represented events
+        double sum_cost;   //!< Sum of costs (ms)
+        double sum_cost2;  //!< Sum of squared costs (ms^2)
+        double min_cost;   //!< Minimal cost (ms)
+        double max_cost;   //!< Maximal cost (ms)
+      };
+
+      /// Statistics of a complexity measure
+      struct statistics_type
+      {
+        statistics_type();
+        void reset();
+        measure_type measure;       //!< Complexity measure
+        double bin_width;           //!< Width of the complexity bins
+        std::vector<bin_type> bins; //!< Cost profile, the last bin holds overflows
+        double sum_x[5];            //!< Sums of x^k, k = 0..4
+        double sum_xt[3];           //!< Sums of x^k.t, k = 0..2
+        double sum_log[5];          //!< Events with x > 0: n, sums of ln x, (ln x)^2, ln t and ln x.ln t
+      };
+
+      /// Return driver id
+      static const std::string & get_id();
+
+      /// Return the name of a complexity measure
+      static const std::string & get_measure_name(const measure_type measure_);
+
+      /// Setting initialization flag
+      void set_initialized(const bool initialized_);
+
+      /// Getting initialization flag
+      bool is_initialized() const;
+
+      /// Setting logging priority
+      void set_logging_priority(const datatools::logger::priority priority_);
+
+      /// Getting logging priority
+      datatools::logger::priority get_logging_priority() const;
+
+      /// Return the number of timed events
+      uint64_t get_number_of_timed_events() const;
+
+      /// Return the number of events represented by the timed ones
+      uint64_t get_number_of_represented_events() const;
+
+      /// Check if the statistics are estimated from a subset of the events
+      bool is_estimate() const;
+
+      /// Return the statistics of the followed measures
+      const std::vector<statistics_type> & get_statistics() const;
+
+      /// Fit the cost model t = c_0 + sum_k c_k.x_k (ms), measures that never
+      /// vary getting a null coefficient. Return false if the model cannot
+      /// be determined.
+      bool fit_linear_model(std::vector<double> & coefficients_, double & rms_, double & r2_) const;
+
+      /// Constructor:
+      complexity_report_driver();
+
+      /// Destructor:
+      ~complexity_report_driver();
+
+      /// Initialize the driver through configuration properties
+      void initialize(const datatools::properties & setup_);
+
+      /// Reset the driver
+      void reset();
+
+      /// Time the pipeline since the previous event and, if the weight is
+      /// not null, record the complexity of the current one as representing
+      /// 'weight_' events
+      void process(const datatools::things & data_, const uint64_t weight_ = 1);
+
+      /// Main report method
+      void report(std::ostream & out_);
+
+      /// Store the accumulated statistics
+      void store_state(state_writer & writer_) const;
+
+      /// Add statistics accumulated by a previous job
+      void load_state(state_reader & reader_);
+
+      /// OCD support:
+      static void init_ocd(datatools::object_configuration_description & ocd_);
+
+    protected:
+
+      /// Set default values to class members:
+      void _set_defaults();
+
+    private:
+
+      /// Read the complexity measures of an event, return false if a bank
+      /// is missing
+      bool _measure_(const datatools::things & data_);
+
+      /// Accumulate the cost of an event of measured complexity
+      void _fill_(const double cost_, const uint64_t weight_);
+
+    private:
+
+      bool _initialized_;                             //!< Initialize flag
+      datatools::logger::priority _logging_priority_; //!< Logging flag
+      std::string _CD_label_;                         //!< Calibrated data bank label
+      std::string _TCD_label_;                        //!< Tracker clustering data bank label
+      size_t _nbins_;                                 //!< Number of complexity bins
+      bool _has_last_;                                //!< Previous event time is set
+      int64_t _last_ns_;                              //!< Time of the previous event
+      uint64_t _timed_events_;                        //!< Number of timed events
+      uint64_t _represented_events_;                  //!< Number of events represented by the timed ones
+      uint64_t _missing_banks_;                       //!< Number of events without a needed bank
+      std::vector<statistics_type> _statistics_;      //!< Statistics per measure
+      std::vector<double> _normal_;                   //!< Normal matrix of the linear model
+      std::vector<double> _rhs_;                      //!< Right hand side of the normal equations
+      double _sum_cost2_;                             //!< Sum of squared costs (ms^2)
+      std::vector<double> _values_;                   //!< Measures of the current event
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#include <bayeux/datatools/ocd_macros.h>
+
+// Declare the OCD interface of the module
+DOCD_CLASS_DECLARATION(snemo::processing::complexity_report_driver)
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_COMPLEXITY_REPORT_DRIVER_H
+
+// end of falaise/snemo/processing/complexity_report_driver.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
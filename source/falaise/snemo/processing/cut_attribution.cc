@@ -0,0 +1,138 @@
+/// \file falaise/snemo/processing/cut_attribution.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/cut_attribution.h>
+
+// Standard library:
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    cut_attribution::cut_attribution()
+    {
+      return;
+    }
+
+    void cut_attribution::initialize(const std::vector<char> & group_start_)
+    {
+      _group_start_ = group_start_;
+      if (! _group_start_.empty()) _group_start_[0] = true;
+      _first_failures_.assign(_group_start_.size(), 0);
+      _group_counters_.assign(GROUP_COUNTERS * _group_start_.size(), 0);
+      return;
+    }
+
+    void cut_attribution::reset()
+    {
+      _group_start_.clear();
+      _first_failures_.clear();
+      _group_counters_.clear();
+      return;
+    }
+
+    size_t cut_attribution::get_number_of_cuts() const
+    {
+      return _group_start_.size();
+    }
+
+    bool cut_attribution::is_group_start(const size_t cut_) const
+    {
+      DT_THROW_IF(cut_ >= _group_start_.size(), std::range_error, "Invalid cut index " << cut_ << " !");
+      return _group_start_[cut_];
+    }
+
+    void cut_attribution::add_event(const uint64_t * deltas_)
+    {
+      const size_t ncuts = _group_start_.size();
+      size_t begin = 0;
+      while (begin < ncuts) {
+        size_t end = begin + 1;
+        while (end < ncuts && ! _group_start_[end]) end++;
+
+        size_t nunknown = 0;
+        size_t first_fail = end;
+        for (size_t i = begin; i < end; i++) {
+          const uint64_t * delta = deltas_ + COUNTERS_PER_CUT * i;
+          if (delta[0] == 0) {
+            nunknown++;
+          } else if (delta[2] > 0 && first_fail == end) {
+            first_fail = i;
+          }
+        }
+
+        // Events that do not reach the serie are ignored
+        if (nunknown < end - begin) {
+          uint64_t * group = &_group_counters_[GROUP_COUNTERS * begin];
+          group[0]++;
+          if (first_fail != end) {
+            _first_failures_[first_fail]++;
+          } else if (nunknown == 0) {
+            group[1]++;
+          } else {
+            group[2]++;
+          }
+        }
+        begin = end;
+      }
+      return;
+    }
+
+    uint64_t cut_attribution::get_first_failures(const size_t cut_) const
+    {
+      DT_THROW_IF(cut_ >= _first_failures_.size(), std::range_error, "Invalid cut index " << cut_ << " !");
+      return _first_failures_[cut_];
+    }
+
+    uint64_t cut_attribution::get_events(const size_t first_) const
+    {
+      DT_THROW_IF(! is_group_start(first_), std::logic_error, "Cut " << first_ << " does not start a serie !");
+      return _group_counters_[GROUP_COUNTERS * first_];
+    }
+
+    uint64_t cut_attribution::get_all_passed(const size_t first_) const
+    {
+      DT_THROW_IF(! is_group_start(first_), std::logic_error, "Cut " << first_ << " does not start a serie !");
+      return _group_counters_[GROUP_COUNTERS * first_ + 1];
+    }
+
+    uint64_t cut_attribution::get_undecided(const size_t first_) const
+    {
+      DT_THROW_IF(! is_group_start(first_), std::logic_error, "Cut " << first_ << " does not start a serie !");
+      return _group_counters_[GROUP_COUNTERS * first_ + 2];
+    }
+
+    void cut_attribution::add_first_failures(const size_t cut_, const uint64_t failures_)
+    {
+      DT_THROW_IF(cut_ >= _first_failures_.size(), std::range_error, "Invalid cut index " << cut_ << " !");
+      _first_failures_[cut_] += failures_;
+      return;
+    }
+
+    void cut_attribution::add_group_counters(const size_t first_, const uint64_t * counters_)
+    {
+      DT_THROW_IF(! is_group_start(first_), std::logic_error, "Cut " << first_ << " does not start a serie !");
+      for (size_t k = 0; k < GROUP_COUNTERS; k++) _group_counters_[GROUP_COUNTERS * first_ + k] += counters_[k];
+      return;
+    }
+
+    const std::vector<uint64_t> & cut_attribution::get_first_failure_counters() const
+    {
+      return _first_failures_;
+    }
+
+    const std::vector<uint64_t> & cut_attribution::get_group_counters() const
+    {
+      return _group_counters_;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/cut_attribution.cc
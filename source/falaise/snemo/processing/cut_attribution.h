@@ -0,0 +1,127 @@
+/// \file falaise/snemo/processing/cut_attribution.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Attribution of the events to the first failing cut of each serie of
+ *   cuts. The decisions of an event are read from the difference of the
+ *   cut counters before and after it: a cut that processed no entry was
+ *   not evaluated, a cut that rejected an entry failed, other evaluated
+ *   cuts passed. Series stop at their first failing cut, so the cuts after
+ *   it are not evaluated and no N-1 acceptance can be measured from the
+ *   counters alone.
+ *
+ *   For each serie, events where no cut was evaluated are ignored; the
+ *   other ones either have a first failing cut, passed all the cuts, or
+ *   had no failure but some cuts not evaluated.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_CUT_ATTRIBUTION_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_CUT_ATTRIBUTION_H 1
+
+// Standard library
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief First failing cut attribution
+    class cut_attribution
+    {
+    public:
+
+      /// Counters per cut in the differences (processed, accepted, rejected)
+      static const size_t COUNTERS_PER_CUT = 3;
+
+      /// Counters per serie (events reaching the serie, all passed,
+      /// no failure but undecided)
+      static const size_t GROUP_COUNTERS = 3;
+
+      /// Constructor
+      cut_attribution();
+
+      /// Initialize with the flags of the cuts starting a serie, the first
+      /// cut always starts one
+      void initialize(const std::vector<char> & group_start_);
+
+      /// Reset
+      void reset();
+
+      /// Return the number of cuts
+      size_t get_number_of_cuts() const;
+
+      /// Check if a cut starts a serie
+      bool is_group_start(const size_t cut_) const;
+
+      /// Attribute an event from the difference of the cut counters,
+      /// COUNTERS_PER_CUT per cut
+      void add_event(const uint64_t * deltas_);
+
+      /// Return the number of events whose first failing cut is a cut
+      uint64_t get_first_failures(const size_t cut_) const;
+
+      /// Return the number of events reaching the serie starting at a cut
+      uint64_t get_events(const size_t first_) const;
+
+      /// Return the number of events passing all the cuts of the serie
+      /// starting at a cut
+      uint64_t get_all_passed(const size_t first_) const;
+
+      /// Return the number of events without failure but with cuts not
+      /// evaluated in the serie starting at a cut
+      uint64_t get_undecided(const size_t first_) const;
+
+      /// Add first failures of a cut, e.g. from a previous job
+      void add_first_failures(const size_t cut_, const uint64_t failures_);
+
+      /// Add the GROUP_COUNTERS counters of the serie starting at a cut
+      void add_group_counters(const size_t first_, const uint64_t * counters_);
+
+      /// Return the first failures per cut
+      const std::vector<uint64_t> & get_first_failure_counters() const;
+
+      /// Return the serie counters, GROUP_COUNTERS per cut, null for cuts
+      /// not starting a serie
+      const std::vector<uint64_t> & get_group_counters() const;
+
+    private:
+
+      std::vector<char> _group_start_;         //!< Cuts starting a serie
+      std::vector<uint64_t> _first_failures_;  //!< Events per first failing cut
+      std::vector<uint64_t> _group_counters_;  //!< GROUP_COUNTERS per cut starting a serie
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_CUT_ATTRIBUTION_H
+
+// end of falaise/snemo/processing/cut_attribution.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
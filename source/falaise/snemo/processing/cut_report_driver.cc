@@ -3,17 +3,28 @@
 // Ourselves:
 #include <falaise/snemo/processing/cut_report_driver.h>
 
+// This project:
+#include <falaise/snemo/processing/state_io.h>
+#include <falaise/snemo/processing/cached_cut.h>
+
 // Standard library:
 #include <sstream>
+#include <iterator>
 #include <iomanip>
-#include <regex>
+#include <cmath>
 
 // Third party:
 // - Bayeux/datatools:
 #include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/things.h>
+#include <bayeux/datatools/object_configuration_description.h>
 // - Bayeux/cuts:
 #include <bayeux/cuts/cut_manager.h>
 
+// - Falaise:
+#include <falaise/snemo/datamodels/data_model.h>
+#include <falaise/snemo/datamodels/event_header.h>
+
 namespace snemo {
 
   namespace processing {
@@ -65,6 +76,40 @@ namespace snemo {
       return _cut_manager_ != 0;
     }
 
+    cut_report_driver::segment_mode_type cut_report_driver::get_segment_mode() const
+    {
+      return _segment_mode_;
+    }
+
+    const std::vector<cut_report_driver::segment_type> & cut_report_driver::get_segments() const
+    {
+      return _segments_;
+    }
+
+    const std::vector<const std::string *> & cut_report_driver::get_tracked_cut_names() const
+    {
+      return _tracked_names_;
+    }
+
+    const std::vector<char> & cut_report_driver::get_tracked_group_starts() const
+    {
+      return _tracked_group_start_;
+    }
+
+    void cut_report_driver::get_tracked_counters(std::vector<uint64_t> & counters_) const
+    {
+      counters_.resize(_tracked_cuts_.size() * COUNTERS_PER_CUT);
+      uint64_t * counters = counters_.empty() ? 0 : &counters_[0];
+      for (size_t i = 0; i < _tracked_cuts_.size(); i++) {
+        const cuts::i_cut & the_cut = *_tracked_cuts_[i];
+        counters[0] = the_cut.get_number_of_processed_entries();
+        counters[1] = the_cut.get_number_of_accepted_entries();
+        counters[2] = the_cut.get_number_of_rejected_entries();
+        counters += COUNTERS_PER_CUT;
+      }
+      return;
+    }
+
     /// Constructor
     cut_report_driver::cut_report_driver()
     {
@@ -121,6 +166,98 @@ namespace snemo {
         setup_.fetch("cuts", _cut_list_);
       }
 
+      if (setup_.has_key("segments")) {
+        const std::string value = setup_.fetch_string("segments");
+        if (value == "none") {
+          _segment_mode_ = SEGMENT_NONE;
+        } else if (value == "run") {
+          _segment_mode_ = SEGMENT_RUN;
+        } else if (value == "file") {
+          _segment_mode_ = SEGMENT_FILE;
+        } else if (value == "run_file") {
+          _segment_mode_ = SEGMENT_RUN_FILE;
+        } else {
+          DT_THROW_IF(true, std::logic_error, "Invalid segmentation mode '" << value << "' !");
+        }
+      }
+
+      if (setup_.has_key("attribution")) {
+        _attribution_ = setup_.fetch_boolean("attribution");
+      }
+
+      if (setup_.has_key("EH_label")) {
+        _EH_label_ = setup_.fetch_string("EH_label");
+      }
+
+      if (setup_.has_key("file_property")) {
+        _file_property_ = setup_.fetch_string("file_property");
+      }
+
+      if (setup_.has_key("efficiencies")) {
+        _report_efficiencies_ = setup_.fetch_boolean("efficiencies");
+      }
+
+      if (setup_.has_key("interval")) {
+        _interval_method_ = binomial_interval::get_method(setup_.fetch_string("interval"));
+      }
+
+      if (setup_.has_key("confidence_level")) {
+        _confidence_level_ = setup_.fetch_real("confidence_level");
+        DT_THROW_IF(_confidence_level_ <= 0.0 || _confidence_level_ >= 1.0, std::domain_error,
+                    "Invalid confidence level " << _confidence_level_ << " !");
+      }
+
+      if (setup_.has_key("precision_check_period")) {
+        const int period = setup_.fetch_integer("precision_check_period");
+        DT_THROW_IF(period < 1, std::domain_error, "Invalid precision check period " << period << " !");
+        _precision_check_period_ = period;
+      }
+
+      if (setup_.has_key("snapshot_period")) {
+        const int period = setup_.fetch_integer("snapshot_period");
+        DT_THROW_IF(period < 0, std::domain_error, "Invalid snapshot period " << period << " !");
+        _snapshot_period_ = period;
+        if (_snapshot_period_ > 0) _report_efficiencies_ = true;
+      }
+
+      // Cuts followed event by event
+      {
+        _build_cut_list();
+        const cuts::cut_manager & a_manager = get_cut_manager();
+        bool start = true;
+        for (cut_list_type::const_iterator icut = _cut_list_.begin();
+             icut != _cut_list_.end(); ++icut) {
+          if (! icut->empty() && (*icut)[0] == '-') {
+            start = true;
+            continue;
+          }
+          if (! a_manager.has(*icut)) continue;
+          const cuts::i_cut & the_cut = a_manager.get(*icut);
+          _tracked_cuts_.push_back(&the_cut);
+          _tracked_names_.push_back(&(*icut));
+          _tracked_group_start_.push_back(start);
+          // Precision target on the cumulative efficiency
+          double target = 0.0;
+          if (setup_.has_key("precision")) target = setup_.fetch_real("precision");
+          if (setup_.has_key("precision." + *icut)) target = setup_.fetch_real("precision." + *icut);
+          DT_THROW_IF(target < 0.0, std::domain_error, "Invalid negative precision target for cut '" << *icut << "' !");
+          _precision_targets_.push_back(target);
+          // Counters at the start of the job
+          _last_counters_.push_back(the_cut.get_number_of_processed_entries());
+          _last_counters_.push_back(the_cut.get_number_of_accepted_entries());
+          _last_counters_.push_back(the_cut.get_number_of_rejected_entries());
+          start = false;
+        }
+        _event_counters_.assign(_last_counters_.size(), 0);
+        if (_attribution_) _attributions_.initialize(_tracked_group_start_);
+      }
+
+      if (setup_.has_key("drift") && setup_.fetch_boolean("drift")) {
+        datatools::properties drift_config;
+        setup_.export_and_rename_starting_with(drift_config, "drift.", "");
+        _drift_.initialize(drift_config, _last_counters_);
+      }
+
       set_initialized(true);
       return;
     }
@@ -141,48 +278,559 @@ namespace snemo {
       _cut_manager_      = 0;
       _print_report_     = PRINT_NONE;
       _cut_list_.clear();
+      _resumed_.clear();
+      _segment_mode_ = SEGMENT_NONE;
+      _EH_label_ = snemo::datamodel::data_info::default_event_header_label();
+      _file_property_ = "input_file";
+      _tracked_cuts_.clear();
+      _tracked_names_.clear();
+      _tracked_group_start_.clear();
+      _last_counters_.clear();
+      _event_counters_.clear();
+      _attribution_ = false;
+      _attributions_.reset();
+      _drift_.reset();
+      _drift_counters_.clear();
+      _segments_.clear();
+      _segment_counters_.clear();
+      _files_.clear();
+      _current_segment_ = 0;
+      _merged_events_ = 0;
+      _has_last_id_       = false;
+      _last_run_number_   = -1;
+      _last_event_number_ = -1;
+      _events_ = 0;
+      _report_efficiencies_ = false;
+      _interval_method_ = binomial_interval::METHOD_WILSON;
+      _confidence_level_ = 0.95;
+      _snapshot_period_ = 0;
+      _efficiencies_.clear();
+      _previous_cumulatives_.clear();
+      _precision_targets_.clear();
+      _precision_check_period_ = 1000;
+      _precision_reached_ = false;
       _title_.clear();
       _indent_.clear();
       return;
     }
 
-    // void cut_report_driver::process()
-    // {
-    //   DT_THROW_IF(! is_initialized(), std::logic_error, "Driver is not initialized !");
-    //   return;
-    // }
+    void cut_report_driver::process(const datatools::things & data_)
+    {
+      DT_THROW_IF(! is_initialized(), std::logic_error, "Driver is not initialized !");
+      _events_++;
+      if (_drift_.is_initialized() && _drift_.add_event()) {
+        get_tracked_counters(_drift_counters_);
+        _drift_.close_window(_drift_counters_);
+      }
+      if (_segment_mode_ == SEGMENT_NONE && ! _attribution_) return;
+      if (_tracked_cuts_.empty()) return;
+
+      // Event id, the input file name is only needed by file segments
+      int32_t run_number = -1;
+      int32_t event_number = -1;
+      int32_t file_index = -1;
+      const bool has_id = data_.has(_EH_label_) && data_.is_a<snemo::datamodel::event_header>(_EH_label_);
+      if (has_id) {
+        const snemo::datamodel::event_header & eh = data_.get<snemo::datamodel::event_header>(_EH_label_);
+        run_number   = eh.get_id().get_run_number();
+        event_number = eh.get_id().get_event_number();
+        if ((_segment_mode_ & SEGMENT_FILE) && eh.get_properties().has_key(_file_property_)) {
+          file_index = _get_file_index(eh.get_properties().fetch_string(_file_property_));
+        }
+      }
+
+      // Records stopped before the module are seen with the next one: they
+      // show as a gap of event numbers in the run. A cut evaluated several
+      // times for a single record, e.g. shared by composite cuts, is not.
+      const bool merged = (has_id && _has_last_id_ && run_number == _last_run_number_
+                           && event_number > _last_event_number_ + 1);
+      _has_last_id_       = has_id;
+      _last_run_number_   = run_number;
+      _last_event_number_ = event_number;
+      if (merged && _merged_events_++ == 0) {
+        DT_LOG_WARNING(get_logging_priority(), "Event numbers skipped since the previous event: records are "
+                       "stopped between the cuts and the process report module !");
+      }
+
+      // Difference of the cut counters with the previous event
+      uint64_t * delta = &_event_counters_[0];
+      uint64_t * last = &_last_counters_[0];
+      for (size_t i = 0; i < _tracked_cuts_.size(); i++) {
+        const cuts::i_cut & the_cut = *_tracked_cuts_[i];
+        const uint64_t processed = the_cut.get_number_of_processed_entries();
+        const uint64_t accepted  = the_cut.get_number_of_accepted_entries();
+        const uint64_t rejected  = the_cut.get_number_of_rejected_entries();
+        delta[0] = processed - last[0];
+        delta[1] = accepted  - last[1];
+        delta[2] = rejected  - last[2];
+        last[0] = processed;
+        last[1] = accepted;
+        last[2] = rejected;
+        delta += COUNTERS_PER_CUT;
+        last  += COUNTERS_PER_CUT;
+      }
+
+      // The decisions of several records can not be told apart
+      if (_attribution_ && ! merged) _attributions_.add_event(&_event_counters_[0]);
+      if (_segment_mode_ == SEGMENT_NONE) return;
+      if (! (_segment_mode_ & SEGMENT_RUN)) run_number = -1;
+
+      // Segments change rarely: check the current one first
+      size_t iseg = _current_segment_;
+      if (_segments_.empty()
+          || _segments_[iseg].run_number != run_number
+          || _segments_[iseg].file_index != file_index) {
+        iseg = _get_segment(run_number, file_index);
+        _current_segment_ = iseg;
+      }
+      segment_type & a_segment = _segments_[iseg];
+      a_segment.events++;
+
+      // Add the difference of the cut counters to the segment
+      uint64_t * counters = &_segment_counters_[a_segment.offset];
+      delta = &_event_counters_[0];
+      for (size_t i = 0; i < COUNTERS_PER_CUT * _tracked_cuts_.size(); i++) {
+        counters[i] += delta[i];
+      }
+      return;
+    }
+
+    void cut_report_driver::_report_attribution(std::ostream & out_)
+    {
+      const std::ios::fmtflags flags = out_.flags();
+      const std::streamsize precision = out_.precision();
+      const size_t ntracked = _tracked_cuts_.size();
+      size_t begin = 0;
+      while (begin < ntracked) {
+        size_t end = begin + 1;
+        while (end < ntracked && ! _tracked_group_start_[end]) end++;
+        const uint64_t events = _attributions_.get_events(begin);
+        out_ << _indent_ << "First failing cut for the serie starting at '"
+             << *_tracked_names_[begin] << "' (" << events << " events)" << std::endl;
+        out_ << _indent_ << "   " << std::left << std::setw(25) << "Cut" << std::right
+             << std::setw(12) << "1st fail" << std::setw(9) << "%" << std::endl;
+        out_ << std::fixed << std::setprecision(2);
+        for (size_t i = begin; i < end; i++) {
+          const uint64_t failures = _attributions_.get_first_failures(i);
+          out_ << _indent_ << "   " << std::left << std::setw(25) << *_tracked_names_[i] << std::right
+               << std::setw(12) << failures
+               << std::setw(9) << (events > 0 ? 100.0 * failures / events : 0.0) << std::endl;
+        }
+        out_.flags(flags);
+        out_.precision(precision);
+        out_ << _indent_ << " ↳ All cuts passed : " << _attributions_.get_all_passed(begin)
+             << ", no failure but undecided : " << _attributions_.get_undecided(begin) << std::endl;
+        begin = end;
+      }
+      if (_merged_events_ > 0) {
+        out_ << _indent_ << "Warning: " << _merged_events_ << " events carried the counters of records "
+             << "stopped before this module and were left out of the attribution" << std::endl;
+      }
+      return;
+    }
+
+    bool cut_report_driver::is_snapshot_due() const
+    {
+      return _snapshot_period_ > 0 && _events_ > 0 && _events_ % _snapshot_period_ == 0;
+    }
+
+    void cut_report_driver::compute_efficiencies(std::vector<efficiency_type> & efficiencies_) const
+    {
+      efficiencies_.resize(_tracked_cuts_.size());
+      uint64_t reference = 0;
+      for (size_t i = 0; i < _tracked_cuts_.size(); i++) {
+        const counters_type counters = _get_counters(*_tracked_names_[i], *_tracked_cuts_[i]);
+        if (_tracked_group_start_[i]) reference = counters.processed;
+        efficiency_type & eff = efficiencies_[i];
+        eff.processed = counters.processed;
+        eff.accepted  = counters.accepted;
+        eff.reference = reference;
+        // Within a serie, a cut only processes the entries accepted by the
+        // previous one
+        eff.sequential = (counters.processed > 0 ? (double) counters.accepted / counters.processed : 0.0);
+        binomial_interval::compute(_interval_method_, counters.accepted, counters.processed, _confidence_level_,
+                                   eff.sequential_low, eff.sequential_high);
+        const uint64_t r = std::max(reference, counters.accepted);
+        eff.cumulative = (r > 0 ? (double) counters.accepted / r : 0.0);
+        binomial_interval::compute(_interval_method_, counters.accepted, r, _confidence_level_,
+                                   eff.cumulative_low, eff.cumulative_high);
+      }
+      return;
+    }
+
+    void cut_report_driver::report_efficiencies(std::ostream & out_)
+    {
+      compute_efficiencies(_efficiencies_);
+
+      size_t name_width = 0;
+      for (size_t i = 0; i < _tracked_names_.size(); i++) {
+        name_width = std::max(name_width, _tracked_names_[i]->size());
+      }
+
+      const bool has_previous = _previous_cumulatives_.size() == _efficiencies_.size();
+      double max_half_width = 0.0;
+      double max_shift = 0.0;
+      const std::ios::fmtflags flags = out_.flags();
+      const std::streamsize precision = out_.precision();
+      out_.setf(std::ios::fixed);
+      out_ << _indent_ << "Cut efficiencies after " << _events_ << " events ("
+           << 100.0 * _confidence_level_ << "% " << binomial_interval::get_label(_interval_method_)
+           << " intervals)" << std::endl;
+      for (size_t i = 0; i < _efficiencies_.size(); i++) {
+        const efficiency_type & eff = _efficiencies_[i];
+        out_ << _indent_ << "   " << std::left << std::setw(name_width) << *_tracked_names_[i] << std::right
+             << std::setprecision(3)
+             << " : sequential " << std::setw(7) << 100.0 * eff.sequential << " %"
+             << " [" << std::setw(7) << 100.0 * eff.sequential_low
+             << ", " << std::setw(7) << 100.0 * eff.sequential_high << "]"
+             << " | cumulative " << std::setw(7) << 100.0 * eff.cumulative << " %"
+             << " [" << std::setw(7) << 100.0 * eff.cumulative_low
+             << ", " << std::setw(7) << 100.0 * eff.cumulative_high << "]";
+        if (has_previous) {
+          const double shift = std::abs(eff.cumulative - _previous_cumulatives_[i]);
+          max_shift = std::max(max_shift, shift);
+          out_ << " | shift " << 100.0 * shift << " %";
+        }
+        out_ << std::endl;
+        max_half_width = std::max(max_half_width, 0.5 * (eff.cumulative_high - eff.cumulative_low));
+      }
+      out_ << _indent_ << " ↳ Largest cumulative half-width : " << 100.0 * max_half_width << " %";
+      if (has_previous) {
+        out_ << " ; largest shift since last snapshot : " << 100.0 * max_shift << " %";
+      }
+      out_ << std::endl;
+      out_.flags(flags);
+      out_.precision(precision);
+
+      _previous_cumulatives_.resize(_efficiencies_.size());
+      for (size_t i = 0; i < _efficiencies_.size(); i++) {
+        _previous_cumulatives_[i] = _efficiencies_[i].cumulative;
+      }
+      return;
+    }
+
+    bool cut_report_driver::has_precision_targets() const
+    {
+      for (size_t i = 0; i < _precision_targets_.size(); i++) {
+        if (_precision_targets_[i] > 0.0) return true;
+      }
+      return false;
+    }
+
+    bool cut_report_driver::check_precision_targets()
+    {
+      if (_precision_reached_) return true;
+      if (_events_ == 0 || _events_ % _precision_check_period_ != 0) return false;
+      if (! has_precision_targets()) return false;
+      compute_efficiencies(_efficiencies_);
+      for (size_t i = 0; i < _efficiencies_.size(); i++) {
+        if (_precision_targets_[i] <= 0.0) continue;
+        const efficiency_type & eff = _efficiencies_[i];
+        if (0.5 * (eff.cumulative_high - eff.cumulative_low) > _precision_targets_[i]) return false;
+      }
+      _precision_reached_ = true;
+      DT_LOG_NOTICE(get_logging_priority(), "All cut precision targets are reached after " << _events_ << " events");
+      return true;
+    }
+
+    size_t cut_report_driver::_get_segment(const int32_t run_number_, const int32_t file_index_)
+    {
+      for (size_t i = 0; i < _segments_.size(); i++) {
+        if (_segments_[i].run_number == run_number_ && _segments_[i].file_index == file_index_) {
+          return i;
+        }
+      }
+      segment_type a_segment;
+      a_segment.run_number = run_number_;
+      a_segment.file_index = file_index_;
+      a_segment.events     = 0;
+      a_segment.offset     = _segment_counters_.size();
+      _segments_.push_back(a_segment);
+      _segment_counters_.resize(_segment_counters_.size() + COUNTERS_PER_CUT * _tracked_cuts_.size(), 0);
+      return _segments_.size() - 1;
+    }
+
+    int32_t cut_report_driver::_get_file_index(const std::string & filename_)
+    {
+      // Check the file of the current segment first
+      if (! _segments_.empty()) {
+        const int32_t current = _segments_[_current_segment_].file_index;
+        if (current >= 0 && _files_[current] == filename_) return current;
+      }
+      for (size_t i = 0; i < _files_.size(); i++) {
+        if (_files_[i] == filename_) return i;
+      }
+      _files_.push_back(filename_);
+      return _files_.size() - 1;
+    }
 
     void cut_report_driver::report(std::ostream & out_)
     {
       DT_THROW_IF(! has_cut_manager(), std::logic_error, "Missing cut manager !");
       if (! _title_.empty()) out_ << _title_ << std::endl;
       this->_report(out_);
+      if (_report_efficiencies_) this->report_efficiencies(out_);
+      if (_segment_mode_ != SEGMENT_NONE) this->_report_segments(out_);
+      if (_attribution_) this->_report_attribution(out_);
+      if (_drift_.is_initialized()) _drift_.report(_tracked_names_, _indent_, out_);
+      this->_report_cache(out_);
       return;
     }
 
-    void cut_report_driver::_report(std::ostream & out_)
+    cut_report_driver::counters_type cut_report_driver::_get_counters(const std::string & name_,
+                                                                      const cuts::i_cut & cut_) const
     {
-      const cuts::cut_manager & a_manager = get_cut_manager();
-      if (_cut_list_.empty()) {
-        const cuts::cut_handle_dict_type & a_cut_dict = a_manager.get_cuts();
-        for (cuts::cut_handle_dict_type::const_iterator i = a_cut_dict.begin();
-             i != a_cut_dict.end(); i++) {
-          const std::string & a_cut_name = i->first;
-          const cuts::cut_entry_type & a_cut_entry = i->second;
-          if (! a_cut_entry.has_cut()) continue;
-          _cut_list_.push_back(a_cut_name);
+      counters_type counters;
+      counters.processed = cut_.get_number_of_processed_entries();
+      counters.accepted  = cut_.get_number_of_accepted_entries();
+      counters.rejected  = cut_.get_number_of_rejected_entries();
+      if (! _resumed_.empty()) {
+        counters_dict_type::const_iterator found = _resumed_.find(name_);
+        if (found != _resumed_.end()) {
+          counters.processed += found->second.processed;
+          counters.accepted  += found->second.accepted;
+          counters.rejected  += found->second.rejected;
+        }
+      }
+      return counters;
+    }
+
+    void cut_report_driver::store_state(state_writer & writer_) const
+    {
+      const cuts::cut_handle_dict_type & a_cut_dict = get_cut_manager().get_cuts();
+      uint32_t ncuts = 0;
+      for (cuts::cut_handle_dict_type::const_iterator i = a_cut_dict.begin();
+           i != a_cut_dict.end(); i++) {
+        if (i->second.has_cut()) ncuts++;
+      }
+      writer_.write_uint32(ncuts);
+      for (cuts::cut_handle_dict_type::const_iterator i = a_cut_dict.begin();
+           i != a_cut_dict.end(); i++) {
+        if (! i->second.has_cut()) continue;
+        const counters_type counters = _get_counters(i->first, i->second.get_cut());
+        writer_.write_string(i->first);
+        writer_.write_uint64(counters.processed);
+        writer_.write_uint64(counters.accepted);
+        writer_.write_uint64(counters.rejected);
+      }
+
+      // Segmented cut flow
+      writer_.write_uint32(_tracked_cuts_.size());
+      for (size_t i = 0; i < _tracked_names_.size(); i++) {
+        writer_.write_string(*_tracked_names_[i]);
+      }
+      writer_.write_uint32(_segments_.size());
+      for (size_t iseg = 0; iseg < _segments_.size(); iseg++) {
+        const segment_type & a_segment = _segments_[iseg];
+        writer_.write_int64(a_segment.run_number);
+        writer_.write_string(a_segment.file_index >= 0 ? _files_[a_segment.file_index] : "");
+        writer_.write_int64(a_segment.file_index >= 0 ? 1 : 0);
+        writer_.write_uint64(a_segment.events);
+        for (size_t i = 0; i < COUNTERS_PER_CUT * _tracked_cuts_.size(); i++) {
+          writer_.write_uint64(_segment_counters_[a_segment.offset + i]);
+        }
+      }
+
+      // Attribution tables, indexed as the followed cuts
+      writer_.write_uint32(_attribution_ ? 1 : 0);
+      if (_attribution_) {
+        const std::vector<uint64_t> & failures = _attributions_.get_first_failure_counters();
+        for (size_t i = 0; i < failures.size(); i++) writer_.write_uint64(failures[i]);
+        const std::vector<uint64_t> & groups = _attributions_.get_group_counters();
+        for (size_t i = 0; i < groups.size(); i++) writer_.write_uint64(groups[i]);
+      }
+      return;
+    }
+
+    void cut_report_driver::load_state(state_reader & reader_)
+    {
+      _resumed_.clear();
+      const uint32_t ncuts = reader_.read_uint32();
+      for (uint32_t i = 0; i < ncuts; i++) {
+        const std::string a_name = reader_.read_string();
+        counters_type & counters = _resumed_[a_name];
+        counters.processed = reader_.read_uint64();
+        counters.accepted  = reader_.read_uint64();
+        counters.rejected  = reader_.read_uint64();
+        if (! get_cut_manager().has(a_name)) {
+          DT_LOG_WARNING(get_logging_priority(), "Resumed cut '" << a_name << "' does not exist anymore !");
+        }
+      }
+
+      // Segmented cut flow, matched by cut name
+      const uint32_t ntracked = reader_.read_uint32();
+      std::vector<int> cut_indexes(ntracked, -1);
+      for (uint32_t i = 0; i < ntracked; i++) {
+        const std::string a_name = reader_.read_string();
+        for (size_t j = 0; j < _tracked_names_.size(); j++) {
+          if (*_tracked_names_[j] == a_name) cut_indexes[i] = j;
+        }
+      }
+      const uint32_t nsegments = reader_.read_uint32();
+      for (uint32_t iseg = 0; iseg < nsegments; iseg++) {
+        const int32_t run_number = reader_.read_int64();
+        const std::string a_file = reader_.read_string();
+        const bool has_file = reader_.read_int64() != 0;
+        const uint64_t events = reader_.read_uint64();
+        std::vector<uint64_t> counters(COUNTERS_PER_CUT * ntracked);
+        for (size_t i = 0; i < counters.size(); i++) counters[i] = reader_.read_uint64();
+        if (_segment_mode_ == SEGMENT_NONE) continue;
+        const int32_t file_index = (has_file ? _get_file_index(a_file) : -1);
+        const size_t jseg = _get_segment(run_number, file_index);
+        _segments_[jseg].events += events;
+        uint64_t * a_segment_counters = &_segment_counters_[_segments_[jseg].offset];
+        for (uint32_t i = 0; i < ntracked; i++) {
+          if (cut_indexes[i] < 0) continue;
+          for (size_t k = 0; k < COUNTERS_PER_CUT; k++) {
+            a_segment_counters[COUNTERS_PER_CUT * cut_indexes[i] + k] += counters[COUNTERS_PER_CUT * i + k];
+          }
+        }
+      }
+
+      // Attribution tables, absent from older checkpoints. Serie counters
+      // are kept by their first cut: they are only resumed if it still
+      // starts a serie.
+      if (reader_.at_end() || reader_.read_uint32() == 0) return;
+      std::vector<uint64_t> failures(ntracked);
+      for (size_t i = 0; i < failures.size(); i++) failures[i] = reader_.read_uint64();
+      std::vector<uint64_t> groups(cut_attribution::GROUP_COUNTERS * ntracked);
+      for (size_t i = 0; i < groups.size(); i++) groups[i] = reader_.read_uint64();
+      if (! _attribution_) return;
+      for (uint32_t i = 0; i < ntracked; i++) {
+        const int j = cut_indexes[i];
+        if (j < 0) continue;
+        _attributions_.add_first_failures(j, failures[i]);
+        if (! _attributions_.is_group_start(j)) continue;
+        _attributions_.add_group_counters(j, &groups[cut_attribution::GROUP_COUNTERS * i]);
+      }
+      return;
+    }
+
+    void cut_report_driver::_build_cut_list()
+    {
+      if (! _cut_list_.empty()) return;
+      const cuts::cut_handle_dict_type & a_cut_dict = get_cut_manager().get_cuts();
+      for (cuts::cut_handle_dict_type::const_iterator i = a_cut_dict.begin();
+           i != a_cut_dict.end(); i++) {
+        const std::string & a_cut_name = i->first;
+        const cuts::cut_entry_type & a_cut_entry = i->second;
+        if (! a_cut_entry.has_cut()) continue;
+        _cut_list_.push_back(a_cut_name);
+      }
+      return;
+    }
+
+    void cut_report_driver::_render(const cut_table_renderer::row_list_type & rows_, std::ostream & out_)
+    {
+      if (_print_report_ == PRINT_AS_METER) {
+        _renderer_.set_indent(_indent_);
+        _renderer_.render_meter(rows_, out_);
+      } else if (_print_report_ == PRINT_AS_TABLE) {
+        _renderer_.render_table(rows_, out_);
+      }
+      return;
+    }
+
+    void cut_report_driver::_report_segments(std::ostream & out_)
+    {
+      // Tree mode dumps cuts: segments are shown as tables
+      const report_format_type format = _print_report_;
+      if (_print_report_ == PRINT_AS_TREE) _print_report_ = PRINT_AS_TABLE;
+
+      cut_table_renderer::row_list_type rows(_tracked_cuts_.size());
+      for (size_t iseg = 0; iseg < _segments_.size(); iseg++) {
+        const segment_type & a_segment = _segments_[iseg];
+        out_ << _indent_ << "Cut flow for ";
+        if (_segment_mode_ & SEGMENT_RUN) {
+          out_ << "run " << a_segment.run_number;
+          if (_segment_mode_ & SEGMENT_FILE) out_ << ", ";
+        }
+        if (_segment_mode_ & SEGMENT_FILE) {
+          if (a_segment.file_index >= 0) {
+            out_ << "file '" << _files_[a_segment.file_index] << "'";
+          } else {
+            out_ << "unknown file";
+          }
+        }
+        out_ << " (" << a_segment.events << " events)" << std::endl;
+        const uint64_t * counters = &_segment_counters_[a_segment.offset];
+        for (size_t i = 0; i < _tracked_cuts_.size(); i++) {
+          cut_table_renderer::row_type & a_row = rows[i];
+          a_row.name        = _tracked_names_[i];
+          a_row.processed   = counters[0];
+          a_row.accepted    = counters[1];
+          a_row.rejected    = counters[2];
+          a_row.group_start = _tracked_group_start_[i];
+          counters += COUNTERS_PER_CUT;
+        }
+        _render(rows, out_);
+      }
+      if (_merged_events_ > 0) {
+        out_ << _indent_ << "Warning: " << _merged_events_ << " events carried the counters of records "
+             << "stopped before this module, added to the segment of the next event" << std::endl;
+      }
+
+      _print_report_ = format;
+      return;
+    }
+
+    void cut_report_driver::_report_cache(std::ostream & out_)
+    {
+      const std::ios::fmtflags flags = out_.flags();
+      const std::streamsize precision = out_.precision();
+      bool first = true;
+      uint64_t total_hits = 0, total_calls = 0;
+      double total_saved = 0.0;
+      const cuts::cut_handle_dict_type & a_cut_dict = get_cut_manager().get_cuts();
+      for (cuts::cut_handle_dict_type::const_iterator i = a_cut_dict.begin();
+           i != a_cut_dict.end(); ++i) {
+        if (! i->second.is_initialized()) continue;
+        const cached_cut * a_cached = dynamic_cast<const cached_cut *>(&i->second.get_cut());
+        if (a_cached == 0) continue;
+        if (first) {
+          out_ << _indent_ << "Cut cache" << std::endl;
+          first = false;
         }
+        const uint64_t hits  = a_cached->get_number_of_hits();
+        const uint64_t calls = hits + a_cached->get_number_of_misses();
+        const double saved   = a_cached->get_saved_time();
+        total_hits  += hits;
+        total_calls += calls;
+        total_saved += saved;
+        out_ << _indent_ << " ↳ " << i->first << " (" << a_cached->get_cached_cut_name() << ") : "
+             << hits << "/" << calls << " hits";
+        if (calls > 0) {
+          out_ << " (" << std::fixed << std::setprecision(1) << 100.0 * hits / calls << "%)";
+        }
+        out_ << ", CPU time spent " << std::setprecision(3) << 1e-9 * a_cached->get_evaluation_time()
+             << " s, saved ~" << 1e-9 * saved << " s" << std::endl;
+      }
+      if (! first && total_calls > 0) {
+        out_ << _indent_ << " ↳ Total : " << std::setprecision(1) << 100.0 * total_hits / total_calls
+             << "% hit rate, ~" << std::setprecision(3) << 1e-9 * total_saved << " s of CPU time saved"
+             << std::endl;
       }
+      out_.flags(flags);
+      out_.precision(precision);
+      return;
+    }
+
+    void cut_report_driver::_report(std::ostream & out_)
+    {
+      const cuts::cut_manager & a_manager = get_cut_manager();
+      _build_cut_list();
 
+      auto is_separator = [] (const std::string & name_)
+        {
+          return ! name_.empty() && name_[0] == '-';
+        };
+
+      cut_table_renderer::row_list_type rows;
+      rows.reserve(_cut_list_.size());
       for (cut_list_type::const_iterator icut = _cut_list_.begin();
            icut != _cut_list_.end(); ++icut) {
         const std::string & a_cut_name = *icut;
 
-        auto is_separator = [] (const std::string & name_)
-          {
-            return std::regex_match(name_, std::regex("^-.*"));
-          };
-
         // Check new serie of cut
         const bool start = icut == _cut_list_.begin() || is_separator(*std::prev(icut));
 
@@ -196,88 +844,23 @@ namespace snemo {
         }
         const cuts::i_cut & the_cut = a_manager.get(a_cut_name);
 
-        // Cut statistics
-        const size_t nae = the_cut.get_number_of_accepted_entries();
-        const size_t nre = the_cut.get_number_of_rejected_entries();
-        const size_t npe = the_cut.get_number_of_processed_entries();
-
         if (_print_report_ == PRINT_AS_TREE) {
           the_cut.tree_dump(out_, "Cut '" + a_cut_name + "'", _indent_);
+          continue;
         }
-        if (_print_report_ == PRINT_AS_METER) {
-          auto meter = [] (const size_t percent_)
-            {
-              const size_t sz = 10;
-              const size_t idx = (percent_ == 0 ? 0 : percent_/sz+1);
-              std::string a_meter;
-              for (size_t i = 0; i < sz; i++) {
-                if (i < idx) a_meter += "█";
-                else         a_meter += " ";
-              }
-              return a_meter;
-            };
-          static size_t digit = 0;
-          static size_t norm = 0;
-          if (start) {
-            digit = std::ceil(log10(npe+1));
-            norm = npe;
-            out_ << std::endl;
-          }
-          const double pae = (npe > 0 ? 100.0 * nae/norm : 0);
-          const double pre = (npe > 0 ? 100.0 * nre/norm : 0);
-          out_.setf(std::ios::fixed);
-          out_.precision(1);
-          out_ << _indent_ << "Cut '" << a_cut_name << "' statistics" << std::endl;
-          out_ << _indent_ << " ↳ " << std::setw(digit)  << npe << " processed entries : "
-               << meter(pae) << " " << std::setw(6) << pae << "% (" << std::right << std::setw(digit) << nae << ") "
-               << meter(pre) << " " << std::setw(6) << pre << "% (" << std::right << std::setw(digit) << nre << ") "
-               << std::endl;
-        }
-        if (_print_report_ == PRINT_AS_TABLE) {
-          // Specific variable for table mode
-          const size_t name_width = 25;
-          const size_t nbr_width  = 8;
-          static size_t column_width = 0;
-          static std::ostringstream hline;
-          if (hline.str().empty()) {
-            std::ostringstream oss;
-            oss << npe;
-            column_width = oss.str().size();
-            // Header line
-            hline << "+" << std::setfill('-') << std::setw(name_width + 6)
-                  << "+" << std::setfill('-') << std::setw(column_width + 3)
-                  << "+" << std::setfill('-') << std::setw(column_width + 3)
-                  << "+" << std::setfill('-') << std::setw(nbr_width + 4)
-                  << "+" << std::setfill('-') << std::setw(column_width + 3)
-                  << "+" << std::setfill('-') << std::setw(nbr_width + 4)
-                  << "+" << std::endl;
-            out_ << hline.str();
-            out_ << "| " << "Cut name" << std::setw(name_width - 2)
-                 << "| " << std::setw(column_width + 3)
-                 << "| " << "Accepted" << std::setw(column_width + nbr_width - 1)
-                 << "| " << "Rejected" << std::setw(column_width + nbr_width - 2)
-                 << "|" << std::endl;
-          }
-          if (start) out_ << hline.str();
-          out_.setf(std::ios::internal);
-          if (a_cut_name.size() > name_width) {
-            out_ << "| " << a_cut_name.substr(0, name_width) << "... | ";
-          } else {
-            out_ << "| " << a_cut_name << std::setfill(' ')
-                 << std::setw(name_width - a_cut_name.size() + 6) << " | ";
-          }
-          out_.setf(std::ios::fixed);
-          out_ << std::setw(column_width) << npe << " | "
-               << std::setw(column_width) << nae << " | "
-               << std::setw(nbr_width) << std::setprecision(2) << (npe > 0 ? 100.0 * nae/npe : 0) << "% | "
-               << std::setw(column_width) << nre << " | "
-               << std::setw(nbr_width) << std::setprecision(2) << (npe > 0 ? 100.0 * nre/npe : 0) << "% | "
-               << std::endl;
-          if (std::next(icut) == _cut_list_.end()) {
-            out_ << hline.str() << std::endl;
-          }
-        }
+
+        // Cut statistics
+        const counters_type counters = _get_counters(a_cut_name, the_cut);
+        cut_table_renderer::row_type a_row;
+        a_row.name        = &a_cut_name;
+        a_row.processed   = counters.processed;
+        a_row.accepted    = counters.accepted;
+        a_row.rejected    = counters.rejected;
+        a_row.group_start = start;
+        rows.push_back(a_row);
       } // end of cut list
+
+      _render(rows, out_);
       return;
     }
 
@@ -288,6 +871,164 @@ namespace snemo {
       // Prefix "CRD" stands for "Cut Report Driver" :
       datatools::logger::declare_ocd_logging_configuration(ocd_, "fatal", "CRD.");
 
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.segments")
+          .set_terse_description("Segmentation of the cut flow")
+          .set_traits(datatools::TYPE_STRING)
+          .set_mandatory(false)
+          .set_default_value_string("none")
+          .set_long_description("Allowed values are 'none', 'run', 'file' and 'run_file'.\n"
+                                "A cut flow is printed for each segment after the       \n"
+                                "overall one. The changes of the cut counters are added \n"
+                                "to the segment of the event seen by the module: it must\n"
+                                "be placed where it sees every record processed by the  \n"
+                                "cuts, i.e. no module between the cuts and this one may \n"
+                                "stop records. Events that follow a gap of event numbers\n"
+                                "in the run, which carry the counters of the stopped    \n"
+                                "records, are counted and reported.                     \n")
+          .add_example("Cut flow per run:: \n"
+                       "                   \n"
+                       "  CRD.segments : string = \"run\" \n"
+                       "                   \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.attribution")
+          .set_terse_description("Flag to report first failing cut tables")
+          .set_traits(datatools::TYPE_BOOLEAN)
+          .set_mandatory(false)
+          .set_default_value_boolean(false)
+          .set_long_description("The decision of each cut is observed event by event from \n"
+                                "its counters; a cut that was not evaluated is unknown.  \n"
+                                "For each serie, the first failing cut is counted. Cuts  \n"
+                                "after it are not evaluated, so N-1 acceptances can not  \n"
+                                "be measured this way.                                   \n"
+                                "As for 'CRD.segments', the module must see every record \n"
+                                "processed by the cuts: events that carry the counters of\n"
+                                "stopped records are left out of the tables and counted. \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.drift")
+          .set_terse_description("Flag to detect efficiency drifts during the job")
+          .set_traits(datatools::TYPE_BOOLEAN)
+          .set_mandatory(false)
+          .set_default_value_boolean(false)
+          .set_long_description("The job is split in windows of 'CRD.drift.window_events'  \n"
+                                "events (default 1000) or 'CRD.drift.window_seconds'      \n"
+                                "seconds. The last 'CRD.drift.windows' windows (default   \n"
+                                "100) are kept. A two-sided CUSUM test per cut, with      \n"
+                                "'CRD.drift.slack' (default 0.5) and 'CRD.drift.threshold' \n"
+                                "(default 5) in standard deviations, compares each window \n"
+                                "with a reference efficiency learned on the first         \n"
+                                "'CRD.drift.reference_windows' windows (default 20), then \n"
+                                "frozen and learned again from the start of each change.  \n"
+                                "At most 'CRD.drift.max_changes' changes (default 50) are \n"
+                                "listed in the report.                                    \n")
+          .add_example("Look for drifts on windows of one minute:: \n"
+                       "                   \n"
+                       "  CRD.drift : boolean = true \n"
+                       "  CRD.drift.window_seconds : real = 60.0 \n"
+                       "                   \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.efficiencies")
+          .set_terse_description("Flag to report efficiencies with confidence intervals")
+          .set_traits(datatools::TYPE_BOOLEAN)
+          .set_mandatory(false)
+          .set_default_value_boolean(false)
+          .set_long_description("Sequential efficiencies are computed with respect to the \n"
+                                "previous cut, cumulative ones with respect to the first  \n"
+                                "cut of the serie.                                        \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.interval")
+          .set_terse_description("Binomial confidence interval method")
+          .set_traits(datatools::TYPE_STRING)
+          .set_mandatory(false)
+          .set_default_value_string("wilson")
+          .set_long_description("Allowed values are 'wilson' and 'clopper_pearson'.");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.confidence_level")
+          .set_terse_description("Confidence level of efficiency intervals")
+          .set_traits(datatools::TYPE_REAL)
+          .set_mandatory(false)
+          .set_default_value_real(0.95);
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.snapshot_period")
+          .set_terse_description("Number of events between efficiency snapshots")
+          .set_traits(datatools::TYPE_INTEGER)
+          .set_mandatory(false)
+          .set_default_value_integer(0)
+          .set_long_description("Each snapshot prints the efficiencies, the largest interval \n"
+                                "half-width and the largest shift since the previous        \n"
+                                "snapshot. A null value disables snapshots.                 \n")
+          .add_example("Follow the convergence every 10000 events:: \n"
+                       "                   \n"
+                       "  CRD.snapshot_period : integer = 10000 \n"
+                       "                   \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.precision")
+          .set_terse_description("Precision target on the cumulative efficiency of every cut")
+          .set_traits(datatools::TYPE_REAL)
+          .set_mandatory(false)
+          .set_long_description("Target half-width of the confidence interval of the      \n"
+                                "cumulative efficiencies. It can be set for a given cut   \n"
+                                "with 'CRD.precision.<cut name>'. Once all targets are    \n"
+                                "reached, the process report module stops the processing. \n")
+          .add_example("Stop when efficiencies are known to 0.1%:: \n"
+                       "                   \n"
+                       "  CRD.precision : real = 0.001 \n"
+                       "                   \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.precision_check_period")
+          .set_terse_description("Number of events between checks of the precision targets")
+          .set_traits(datatools::TYPE_INTEGER)
+          .set_mandatory(false)
+          .set_default_value_integer(1000);
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.EH_label")
+          .set_terse_description("The label of the event header bank")
+          .set_traits(datatools::TYPE_STRING)
+          .set_mandatory(false)
+          .set_default_value_string(snemo::datamodel::data_info::default_event_header_label());
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("CRD.file_property")
+          .set_terse_description("Event header property holding the input file name")
+          .set_traits(datatools::TYPE_STRING)
+          .set_mandatory(false)
+          .set_default_value_string("input_file")
+          .set_long_description("Input files are not recorded in the event header by     \n"
+                                "default: an upstream module has to store the file name \n"
+                                "in this property. Events without it are gathered in an \n"
+                                "'unknown file' segment.                                \n");
+      }
+
     }
 
   }  // end of namespace processing
@@ -24,6 +24,34 @@
  *
  *   A driver class that produce a report related to cuts.
  *
+ *   The cut flow can also be segmented by run number and/or input file:
+ *   at each event, the difference of the cut counters with the previous
+ *   event is added to the counters of the current segment. The counters
+ *   of all segments are stored contiguously in a single array. This needs
+ *   the module to see every record that the tracked cuts see: records
+ *   stopped between the cuts and the module would be added to the segment
+ *   of the next event. Such events, found by a gap of event numbers in the
+ *   run, are counted and reported.
+ *
+ *   Sequential (with respect to the previous cut) and cumulative (with
+ *   respect to the first cut of the serie) efficiencies are reported with
+ *   binomial confidence intervals, optionally as periodic snapshots so that
+ *   the convergence of the cut flow can be followed during the job.
+ *   Precision targets on the cumulative efficiencies can be set so that
+ *   validation jobs stop as soon as the cut flow is known well enough.
+ *
+ *   Decisions observed event by event also give, for each serie, the
+ *   first failing cut (see cut_attribution.h) in a single pass over the
+ *   data. This also needs the module to see every record: events that
+ *   carry the counters of several records are left out of the attribution
+ *   and counted.
+ *
+ *   Efficiency drifts during the job can be detected online on a ring of
+ *   windows (see drift_monitor.h).
+ *
+ *   The hit rate and the CPU time saved by cached cuts (see cached_cut.h)
+ *   are reported.
+ *
  * History:
  *
  */
@@ -33,23 +61,36 @@
 
 // Standard library
 #include <vector>
+#include <map>
+#include <stdint.h>
 
 // Third party:
 // - Bayeux/datatools
 #include <bayeux/datatools/logger.h>
 
+// This project:
+#include <falaise/snemo/processing/cut_table_renderer.h>
+#include <falaise/snemo/processing/binomial_interval.h>
+#include <falaise/snemo/processing/drift_monitor.h>
+#include <falaise/snemo/processing/cut_attribution.h>
+
 namespace datatools {
   class properties;
+  class things;
 }
 
 namespace cuts {
   class cut_manager;
+  class i_cut;
 }
 
 namespace snemo {
 
   namespace processing {
 
+    class state_writer;
+    class state_reader;
+
     /// \brief Cut report driver
     class cut_report_driver
     {
@@ -63,9 +104,55 @@ namespace snemo {
         PRINT_AS_METER
       };
 
+      /// Segmentation of the cut flow
+      enum segment_mode_type {
+        SEGMENT_NONE     = 0,
+        SEGMENT_RUN      = 1,
+        SEGMENT_FILE     = 2,
+        SEGMENT_RUN_FILE = 3
+      };
+
+      /// Counters per cut in a segment (processed, accepted, rejected)
+      static const size_t COUNTERS_PER_CUT = 3;
+
+      /// Segment of the cut flow
+      struct segment_type
+      {
+        int32_t run_number;   //!< Run number (-1 if not segmented by run)
+        int32_t file_index;   //!< Index of the input file (-1 if not segmented by file)
+        uint64_t events;      //!< Number of events
+        size_t offset;        //!< Offset of the segment counters in the arena
+      };
+
+      /// Efficiencies of a cut with their confidence intervals
+      struct efficiency_type
+      {
+        uint64_t processed;      //!< Number of processed entries
+        uint64_t accepted;       //!< Number of accepted entries
+        uint64_t reference;      //!< Number of entries processed by the first cut of the serie
+        double sequential;       //!< Efficiency with respect to the previous cut
+        double sequential_low;   //!< Lower bound of the sequential efficiency
+        double sequential_high;  //!< Upper bound of the sequential efficiency
+        double cumulative;       //!< Efficiency with respect to the first cut of the serie
+        double cumulative_low;   //!< Lower bound of the cumulative efficiency
+        double cumulative_high;  //!< Upper bound of the cumulative efficiency
+      };
+
 			/// Typedef for a list of cut name
       typedef std::vector<std::string> cut_list_type;
 
+      /// Cut statistics
+      struct counters_type
+      {
+        counters_type() : processed(0), accepted(0), rejected(0) {}
+        uint64_t processed;
+        uint64_t accepted;
+        uint64_t rejected;
+      };
+
+      /// Typedef for cut statistics indexed by cut name
+      typedef std::map<std::string, counters_type> counters_dict_type;
+
       /// Return driver id
       static const std::string & get_id();
 
@@ -102,9 +189,50 @@ namespace snemo {
       /// Reset the driver
       void reset();
 
+      /// Return the segmentation mode
+      segment_mode_type get_segment_mode() const;
+
+      /// Return the segments
+      const std::vector<segment_type> & get_segments() const;
+
+      /// Return the names of the cuts followed event by event
+      const std::vector<const std::string *> & get_tracked_cut_names() const;
+
+      /// Return the flags of the followed cuts starting a serie
+      const std::vector<char> & get_tracked_group_starts() const;
+
+      /// Return the counters of the followed cuts for this job only,
+      /// COUNTERS_PER_CUT values per cut
+      void get_tracked_counters(std::vector<uint64_t> & counters_) const;
+
+      /// Accumulate the cut counters of the current event in its segment
+      void process(const datatools::things & data_);
+
+      /// Check if an efficiency snapshot is due after the current event
+      bool is_snapshot_due() const;
+
+      /// Compute the efficiencies of the followed cuts
+      void compute_efficiencies(std::vector<efficiency_type> & efficiencies_) const;
+
+      /// Report the efficiencies with their confidence intervals
+      void report_efficiencies(std::ostream & out_);
+
+      /// Check if precision targets are set
+      bool has_precision_targets() const;
+
+      /// Check, every 'precision_check_period' events, if all precision
+      /// targets are reached
+      bool check_precision_targets();
+
       /// Main report method
       void report(std::ostream & out_);
 
+      /// Store the cut statistics, including resumed ones
+      void store_state(state_writer & writer_) const;
+
+      /// Resume cut statistics from a previous job
+      void load_state(state_reader & reader_);
+
       /// OCD support:
       static void init_ocd(datatools::object_configuration_description & ocd_);
 
@@ -113,9 +241,33 @@ namespace snemo {
       /// Set default values to class members:
       void _set_defaults();
 
+      /// Build the list of reported cuts if not set by configuration
+      void _build_cut_list();
+
       /// Internal report method
       void _report(std::ostream & out_);
 
+      /// Render rows with the configured format
+      void _render(const cut_table_renderer::row_list_type & rows_, std::ostream & out_);
+
+      /// Report the segmented cut flow
+      void _report_segments(std::ostream & out_);
+
+      /// Report the first failing cut tables
+      void _report_attribution(std::ostream & out_);
+
+      /// Report the statistics of the cached cuts
+      void _report_cache(std::ostream & out_);
+
+      /// Return the index of the segment of an event, creating it if needed
+      size_t _get_segment(const int32_t run_number_, const int32_t file_index_);
+
+      /// Return the index of an input file name
+      int32_t _get_file_index(const std::string & filename_);
+
+      /// Return the statistics of a cut, including resumed ones
+      counters_type _get_counters(const std::string & name_, const cuts::i_cut & cut_) const;
+
     private:
 
       bool _initialized_;                             //!< Initialize flag
@@ -125,6 +277,38 @@ namespace snemo {
       report_format_type _print_report_;              //!< Print report format
       const cuts::cut_manager * _cut_manager_;        //!< The cut manager
       cut_list_type _cut_list_;                       //!< List of cuts
+      cut_table_renderer _renderer_;                  //!< Table and meter renderer
+      counters_dict_type _resumed_;                   //!< Statistics resumed from a previous job
+      segment_mode_type _segment_mode_;               //!< Segmentation mode
+      std::string _EH_label_;                         //!< Event header bank label
+      std::string _file_property_;                    //!< Event header property with the input file name
+      std::vector<const cuts::i_cut *> _tracked_cuts_;   //!< Segmented cuts
+      std::vector<const std::string *> _tracked_names_;  //!< Names of segmented cuts
+      std::vector<char> _tracked_group_start_;        //!< Segmented cuts starting a serie
+      std::vector<uint64_t> _last_counters_;          //!< Cut counters at the previous event
+      std::vector<uint64_t> _event_counters_;         //!< Cut counters of the current event
+      bool _attribution_;                             //!< Report attribution tables
+      cut_attribution _attributions_;                 //!< First failing cut attribution
+      drift_monitor _drift_;                          //!< Efficiency drift monitor
+      std::vector<uint64_t> _drift_counters_;         //!< Reused cut counters for the drift monitor
+      std::vector<segment_type> _segments_;           //!< Segments by order of appearance
+      std::vector<uint64_t> _segment_counters_;       //!< Arena of segment counters
+      std::vector<std::string> _files_;               //!< Input file names
+      size_t _current_segment_;                       //!< Index of the current segment
+      uint64_t _merged_events_;                       //!< Events whose counter differences cover several records
+      bool _has_last_id_;                             //!< The previous event has an id
+      int32_t _last_run_number_;                      //!< Run number of the previous event
+      int32_t _last_event_number_;                    //!< Event number of the previous event
+      uint64_t _events_;                              //!< Number of processed events
+      bool _report_efficiencies_;                     //!< Report efficiencies with intervals
+      binomial_interval::method_type _interval_method_; //!< Confidence interval method
+      double _confidence_level_;                      //!< Confidence level of intervals
+      uint64_t _snapshot_period_;                     //!< Number of events between snapshots
+      std::vector<efficiency_type> _efficiencies_;    //!< Efficiencies of the last snapshot
+      std::vector<double> _previous_cumulatives_;     //!< Cumulative efficiencies of the previous snapshot
+      std::vector<double> _precision_targets_;        //!< Target half-width per followed cut (0: none)
+      uint64_t _precision_check_period_;              //!< Number of events between precision checks
+      bool _precision_reached_;                       //!< All precision targets are reached
     };
 
   }  // end of namespace processing
@@ -0,0 +1,268 @@
+/// \file falaise/snemo/processing/cut_table_renderer.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/cut_table_renderer.h>
+
+// Standard library:
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      // Layout of the table view
+      const size_t name_width = 25;
+      const size_t nbr_width  = 8;
+
+      // Layout of the meter view
+      const size_t meter_size = 10;
+      const char meter_full[] = "█";
+
+      /// Number of decimal digits of an unsigned integer
+      size_t digits10(uint64_t value_)
+      {
+        size_t n = 1;
+        while (value_ >= 10) {
+          value_ /= 10;
+          n++;
+        }
+        return n;
+      }
+
+    }
+
+    cut_table_renderer::cut_table_renderer()
+    {
+      return;
+    }
+
+    void cut_table_renderer::set_indent(const std::string & indent_)
+    {
+      _indent_ = indent_;
+      return;
+    }
+
+    const std::string & cut_table_renderer::get_buffer() const
+    {
+      return _buffer_;
+    }
+
+    void cut_table_renderer::_append_(const char * text_, size_t size_)
+    {
+      _buffer_.append(text_, size_);
+      return;
+    }
+
+    void cut_table_renderer::_append_(const std::string & text_)
+    {
+      _buffer_.append(text_);
+      return;
+    }
+
+    void cut_table_renderer::_append_fill_(char fill_, size_t count_)
+    {
+      _buffer_.append(count_, fill_);
+      return;
+    }
+
+    void cut_table_renderer::_append_uint_(uint64_t value_, size_t width_)
+    {
+      char digits[24];
+      char * end = digits + sizeof(digits);
+      char * p = end;
+      do {
+        *--p = '0' + value_ % 10;
+        value_ /= 10;
+      } while (value_ != 0);
+      const size_t n = end - p;
+      if (width_ > n) _append_fill_(' ', width_ - n);
+      _append_(p, n);
+      return;
+    }
+
+    void cut_table_renderer::_append_fixed_(double value_, unsigned int precision_, size_t width_)
+    {
+      char text[64];
+      size_t n = 0;
+      // Exact rounding needs the scaled mantissa to fit into a long double,
+      // otherwise (or for non finite values) rely on the C library
+      const bool exact = precision_ <= 2
+        && std::numeric_limits<long double>::digits >= std::numeric_limits<double>::digits + 7;
+      if (! exact || ! std::isfinite(value_) || std::fabs(value_) >= 1e15) {
+        const int sz = std::snprintf(text, sizeof(text), "%.*f", precision_, value_);
+        n = (sz > 0 ? (size_t) sz : 0);
+      } else {
+        static const uint64_t pow10[] = { 1, 10, 100 };
+        const uint64_t scale = pow10[precision_];
+        const long double scaled = (long double) std::fabs(value_) * scale;
+        const long double floor_scaled = std::floor(scaled);
+        uint64_t q = (uint64_t) floor_scaled;
+        const long double remainder = scaled - floor_scaled;
+        // Round half to even, as printf does for exactly representable ties
+        if (remainder > 0.5L || (remainder == 0.5L && (q & 1))) q++;
+        char digits[32];
+        char * end = digits + sizeof(digits);
+        char * p = end;
+        uint64_t fraction = q % scale;
+        for (unsigned int i = 0; i < precision_; i++) {
+          *--p = '0' + fraction % 10;
+          fraction /= 10;
+        }
+        if (precision_ > 0) *--p = '.';
+        uint64_t integer = q / scale;
+        do {
+          *--p = '0' + integer % 10;
+          integer /= 10;
+        } while (integer != 0);
+        if (std::signbit(value_)) *--p = '-';
+        n = end - p;
+        std::memcpy(text, p, n);
+      }
+      if (width_ > n) _append_fill_(' ', width_ - n);
+      _append_(text, n);
+      return;
+    }
+
+    void cut_table_renderer::_append_meter_(double percent_)
+    {
+      const size_t percent = (percent_ >= 1000.0 ? 1000 : (size_t) percent_);
+      const size_t idx = (percent == 0 ? 0 : percent / meter_size + 1);
+      for (size_t i = 0; i < meter_size; i++) {
+        if (i < idx) _append_(meter_full, sizeof(meter_full) - 1);
+        else         _append_(" ", 1);
+      }
+      return;
+    }
+
+    void cut_table_renderer::_flush_(std::ostream & out_)
+    {
+      out_.write(_buffer_.data(), _buffer_.size());
+      return;
+    }
+
+    void cut_table_renderer::render_table(const row_list_type & rows_, std::ostream & out_)
+    {
+      _buffer_.clear();
+      if (rows_.empty()) return;
+
+      // Layout is driven by the number of processed entries of the first cut
+      const size_t column_width = digits10(rows_.front().processed);
+
+      // Every row has the same size bar the cut name
+      const size_t row_size = 2 + name_width + 6 + 4 * (column_width + 3) + 2 * (nbr_width + 4) + 1;
+      const size_t hline_size = 7 + (name_width + 5) + 4 * (column_width + 2) + 2 * (nbr_width + 3) + 1;
+      _buffer_.reserve(rows_.size() * (row_size + hline_size) + 4 * hline_size);
+
+      // Horizontal line is rendered once and then copied
+      const size_t hline_begin = _buffer_.size();
+      _append_("+", 1);
+      _append_fill_('-', name_width + 5);         _append_("+", 1);
+      _append_fill_('-', column_width + 2);       _append_("+", 1);
+      _append_fill_('-', column_width + 2);       _append_("+", 1);
+      _append_fill_('-', nbr_width + 3);          _append_("+", 1);
+      _append_fill_('-', column_width + 2);       _append_("+", 1);
+      _append_fill_('-', nbr_width + 3);          _append_("+", 1);
+      _append_("\n", 1);
+      const size_t hline_end = _buffer_.size();
+      const std::string::size_type hline_length = hline_end - hline_begin;
+
+      // Header
+      _append_("| Cut name", 10);
+      _append_fill_(' ', name_width - 4);         _append_("| ", 2);
+      _append_fill_(' ', column_width + 1);       _append_("| ", 2);
+      _append_("Accepted", 8);
+      _append_fill_(' ', column_width + nbr_width - 3); _append_("| ", 2);
+      _append_("Rejected", 8);
+      _append_fill_(' ', column_width + nbr_width - 3); _append_("|\n", 2);
+
+      for (row_list_type::const_iterator irow = rows_.begin(); irow != rows_.end(); ++irow) {
+        const row_type & a_row = *irow;
+        if (a_row.group_start) _buffer_.append(_buffer_, hline_begin, hline_length);
+        const std::string & a_name = *a_row.name;
+        if (a_name.size() > name_width) {
+          _append_("| ", 2);
+          _append_(a_name.data(), name_width);
+          _append_("... | ", 6);
+        } else {
+          _append_("| ", 2);
+          _append_(a_name);
+          _append_fill_(' ', name_width - a_name.size() + 3);
+          _append_(" | ", 3);
+        }
+        const uint64_t npe = a_row.processed;
+        _append_uint_(npe, column_width);             _append_(" | ", 3);
+        _append_uint_(a_row.accepted, column_width);  _append_(" | ", 3);
+        _append_fixed_(npe > 0 ? 100.0 * a_row.accepted/npe : 0, 2, nbr_width);
+        _append_("% | ", 4);
+        _append_uint_(a_row.rejected, column_width);  _append_(" | ", 3);
+        _append_fixed_(npe > 0 ? 100.0 * a_row.rejected/npe : 0, 2, nbr_width);
+        _append_("% | \n", 5);
+      }
+      _buffer_.append(_buffer_, hline_begin, hline_length);
+      _append_("\n", 1);
+
+      _flush_(out_);
+      return;
+    }
+
+    void cut_table_renderer::render_meter(const row_list_type & rows_, std::ostream & out_)
+    {
+      _buffer_.clear();
+      if (rows_.empty()) return;
+
+      const size_t meter_bytes = meter_size * (sizeof(meter_full) - 1);
+      size_t max_name = 0;
+      for (row_list_type::const_iterator irow = rows_.begin(); irow != rows_.end(); ++irow) {
+        if (irow->name->size() > max_name) max_name = irow->name->size();
+      }
+      const size_t row_size = 2 * _indent_.size() + max_name + 3 * 24 + 2 * meter_bytes + 64;
+      _buffer_.reserve(rows_.size() * row_size);
+
+      size_t digit = 0;
+      uint64_t norm = 0;
+      for (row_list_type::const_iterator irow = rows_.begin(); irow != rows_.end(); ++irow) {
+        const row_type & a_row = *irow;
+        const uint64_t npe = a_row.processed;
+        if (a_row.group_start) {
+          digit = (npe == 0 ? 0 : digits10(npe));
+          norm = npe;
+          _append_("\n", 1);
+        }
+        const double pae = (npe > 0 ? 100.0 * a_row.accepted/norm : 0);
+        const double pre = (npe > 0 ? 100.0 * a_row.rejected/norm : 0);
+        _append_(_indent_);
+        _append_("Cut '", 5);
+        _append_(*a_row.name);
+        _append_("' statistics\n", 13);
+        _append_(_indent_);
+        _append_(" ↳ ", sizeof(" ↳ ") - 1);
+        _append_uint_(npe, digit);
+        _append_(" processed entries : ", 21);
+        _append_meter_(pae);
+        _append_(" ", 1);
+        _append_fixed_(pae, 1, 6);
+        _append_("% (", 3);
+        _append_uint_(a_row.accepted, digit);
+        _append_(") ", 2);
+        _append_meter_(pre);
+        _append_(" ", 1);
+        _append_fixed_(pre, 1, 6);
+        _append_("% (", 3);
+        _append_uint_(a_row.rejected, digit);
+        _append_(") \n", 3);
+      }
+
+      _flush_(out_);
+      return;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/cut_table_renderer.cc
@@ -0,0 +1,105 @@
+/// \file falaise/snemo/processing/cut_table_renderer.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   A text renderer for the table and meter views of the cut report. The
+ *   layout is computed once per rendering, integers and fixed-point
+ *   percentages are converted by hand into a single buffer, and the result
+ *   is written to the output stream in one call. The buffer is kept between
+ *   renderings so that periodic reports do not allocate.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_CUT_TABLE_RENDERER_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_CUT_TABLE_RENDERER_H 1
+
+// Standard library
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Text renderer for cut statistics
+    class cut_table_renderer
+    {
+    public:
+
+      /// Statistics of one cut to be rendered
+      struct row_type
+      {
+        const std::string * name; //!< Cut name (not owned)
+        uint64_t processed;       //!< Number of processed entries
+        uint64_t accepted;        //!< Number of accepted entries
+        uint64_t rejected;        //!< Number of rejected entries
+        bool group_start;         //!< First cut of a separator-delimited serie
+      };
+
+      /// Typedef for a list of rows
+      typedef std::vector<row_type> row_list_type;
+
+      /// Constructor:
+      cut_table_renderer();
+
+      /// Set the indent string of the meter view
+      void set_indent(const std::string & indent_);
+
+      /// Render rows as a table
+      void render_table(const row_list_type & rows_, std::ostream & out_);
+
+      /// Render rows as meters
+      void render_meter(const row_list_type & rows_, std::ostream & out_);
+
+      /// Return the last rendered text
+      const std::string & get_buffer() const;
+
+    private:
+
+      void _append_(const char * text_, size_t size_);
+      void _append_(const std::string & text_);
+      void _append_fill_(char fill_, size_t count_);
+      void _append_uint_(uint64_t value_, size_t width_);
+      void _append_fixed_(double value_, unsigned int precision_, size_t width_);
+      void _append_meter_(double percent_);
+      void _flush_(std::ostream & out_);
+
+    private:
+
+      std::string _indent_; //!< Indent string
+      std::string _buffer_; //!< Rendering buffer
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_CUT_TABLE_RENDERER_H
+
+// end of falaise/snemo/processing/cut_table_renderer.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
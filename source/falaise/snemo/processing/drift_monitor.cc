@@ -0,0 +1,272 @@
+/// \file falaise/snemo/processing/drift_monitor.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/drift_monitor.h>
+
+// Standard library:
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      int64_t steady_ns()
+      {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>
+          (std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+
+    }
+
+    drift_monitor::drift_monitor()
+    {
+      reset();
+      return;
+    }
+
+    bool drift_monitor::is_initialized() const
+    {
+      return _initialized_;
+    }
+
+    void drift_monitor::reset()
+    {
+      _initialized_         = false;
+      _ncuts_               = 0;
+      _window_events_       = 1000;
+      _window_seconds_      = 0.0;
+      _nwindows_            = 100;
+      _reference_windows_   = 20;
+      _slack_               = 0.5;
+      _threshold_           = 5.0;
+      _max_changes_         = 50;
+      _start_ns_            = 0;
+      _events_              = 0;
+      _window_first_event_  = 0;
+      _window_start_        = 0.0;
+      _windows_             = 0;
+      _window_begin_counters_.clear();
+      _ring_.clear();
+      _ring_first_events_.clear();
+      _ring_start_times_.clear();
+      _cusums_.clear();
+      _changes_.clear();
+      _lost_changes_        = 0;
+      return;
+    }
+
+    void drift_monitor::initialize(const datatools::properties & setup_,
+                                   const std::vector<uint64_t> & counters_)
+    {
+      DT_THROW_IF(is_initialized(), std::logic_error, "Drift monitor is already initialized !");
+
+      if (setup_.has_key("window_events")) {
+        const int n = setup_.fetch_integer("window_events");
+        DT_THROW_IF(n < 1, std::domain_error, "Invalid number of events per window " << n << " !");
+        _window_events_ = n;
+      }
+
+      if (setup_.has_key("window_seconds")) {
+        _window_seconds_ = setup_.fetch_real("window_seconds");
+        DT_THROW_IF(_window_seconds_ < 0.0, std::domain_error,
+                    "Invalid window duration " << _window_seconds_ << " !");
+      }
+
+      if (setup_.has_key("windows")) {
+        const int n = setup_.fetch_integer("windows");
+        DT_THROW_IF(n < 2, std::domain_error, "At least 2 windows must be kept !");
+        _nwindows_ = n;
+      }
+
+      if (setup_.has_key("reference_windows")) {
+        const int n = setup_.fetch_integer("reference_windows");
+        DT_THROW_IF(n < 1, std::domain_error, "Invalid number of reference windows " << n << " !");
+        _reference_windows_ = n;
+      }
+
+      if (setup_.has_key("slack")) {
+        _slack_ = setup_.fetch_real("slack");
+        DT_THROW_IF(_slack_ < 0.0, std::domain_error, "Invalid negative CUSUM slack !");
+      }
+
+      if (setup_.has_key("threshold")) {
+        _threshold_ = setup_.fetch_real("threshold");
+        DT_THROW_IF(_threshold_ <= 0.0, std::domain_error, "Invalid CUSUM threshold !");
+      }
+
+      if (setup_.has_key("max_changes")) {
+        const int n = setup_.fetch_integer("max_changes");
+        DT_THROW_IF(n < 0, std::domain_error, "Invalid maximum number of changes " << n << " !");
+        _max_changes_ = n;
+      }
+
+      _ncuts_ = counters_.size() / COUNTERS_PER_CUT;
+      _window_begin_counters_ = counters_;
+      _ring_.assign(2 * _ncuts_ * _nwindows_, 0);
+      _ring_first_events_.assign(_nwindows_, 0);
+      _ring_start_times_.assign(_nwindows_, 0.0);
+      cusum_type a_cusum;
+      a_cusum.processed       = 0;
+      a_cusum.accepted        = 0;
+      a_cusum.windows         = 0;
+      a_cusum.upper           = 0.0;
+      a_cusum.lower           = 0.0;
+      a_cusum.upper_start     = 0;
+      a_cusum.lower_start     = 0;
+      _cusums_.assign(_ncuts_, a_cusum);
+      _start_ns_ = steady_ns();
+      _initialized_ = true;
+      return;
+    }
+
+    double drift_monitor::_now_() const
+    {
+      return 1e-9 * (steady_ns() - _start_ns_);
+    }
+
+    bool drift_monitor::add_event()
+    {
+      _events_++;
+      if (_window_seconds_ > 0.0) return _now_() - _window_start_ >= _window_seconds_;
+      return _events_ - _window_first_event_ >= _window_events_;
+    }
+
+    void drift_monitor::close_window(const std::vector<uint64_t> & counters_)
+    {
+      DT_THROW_IF(counters_.size() != COUNTERS_PER_CUT * _ncuts_, std::logic_error,
+                  "Unexpected number of cut counters !");
+      const size_t slot = _windows_ % _nwindows_;
+      _ring_first_events_[slot] = _window_first_event_;
+      _ring_start_times_[slot]  = _window_start_;
+      uint64_t * window = &_ring_[2 * _ncuts_ * slot];
+
+      for (size_t icut = 0; icut < _ncuts_; icut++) {
+        const uint64_t * counters = &counters_[COUNTERS_PER_CUT * icut];
+        uint64_t * begin = &_window_begin_counters_[COUNTERS_PER_CUT * icut];
+        const uint64_t n = counters[0] - begin[0];
+        const uint64_t k = counters[1] - begin[1];
+        window[2 * icut]     = n;
+        window[2 * icut + 1] = k;
+        begin[0] = counters[0];
+        begin[1] = counters[1];
+        if (n == 0) continue;
+
+        cusum_type & a_cusum = _cusums_[icut];
+        // The reference is frozen once learned, so that a slow drift does
+        // not drag it along
+        if (a_cusum.windows < _reference_windows_) {
+          a_cusum.processed += n;
+          a_cusum.accepted  += k;
+          a_cusum.windows++;
+          continue;
+        }
+        // Keep the variance finite for references of 0 or 1
+        const double reference = (double) a_cusum.accepted / a_cusum.processed;
+        const double p0 = std::min(std::max(reference, 0.5 / n), 1.0 - 0.5 / n);
+        const double z = (k - n * p0) / std::sqrt(n * p0 * (1.0 - p0));
+        if (a_cusum.upper == 0.0) a_cusum.upper_start = _windows_;
+        if (a_cusum.lower == 0.0) a_cusum.lower_start = _windows_;
+        a_cusum.upper = std::max(0.0, a_cusum.upper + z - _slack_);
+        a_cusum.lower = std::max(0.0, a_cusum.lower - z - _slack_);
+        if (a_cusum.upper > _threshold_) {
+          _change_(icut, a_cusum.upper_start);
+        } else if (a_cusum.lower > _threshold_) {
+          _change_(icut, a_cusum.lower_start);
+        }
+      }
+
+      _windows_++;
+      _window_first_event_ = _events_;
+      _window_start_ = _now_();
+      return;
+    }
+
+    void drift_monitor::_change_(const size_t cut_, const uint64_t start_window_)
+    {
+      // The start of the change may have left the ring
+      const uint64_t oldest = (_windows_ + 1 > _nwindows_ ? _windows_ + 1 - _nwindows_ : 0);
+      const uint64_t start = std::max(start_window_, oldest);
+      uint64_t n = 0, k = 0;
+      for (uint64_t w = start; w <= _windows_; w++) {
+        const uint64_t * window = &_ring_[2 * _ncuts_ * (w % _nwindows_)];
+        n += window[2 * cut_];
+        k += window[2 * cut_ + 1];
+      }
+      cusum_type & a_cusum = _cusums_[cut_];
+      const double before = (double) a_cusum.accepted / a_cusum.processed;
+      const double after  = (n > 0 ? (double) k / n : before);
+      if (_changes_.size() < _max_changes_) {
+        change_type a_change;
+        a_change.cut             = cut_;
+        a_change.first_event     = _ring_first_events_[start % _nwindows_];
+        a_change.start_time      = _ring_start_times_[start % _nwindows_];
+        a_change.detection_event = _events_;
+        a_change.before          = before;
+        a_change.after           = after;
+        _changes_.push_back(a_change);
+      } else {
+        _lost_changes_++;
+      }
+      // The reference is learned again from the change
+      a_cusum.processed = n;
+      a_cusum.accepted  = k;
+      a_cusum.windows   = _windows_ + 1 - start;
+      a_cusum.upper = a_cusum.lower = 0.0;
+      return;
+    }
+
+    const std::vector<drift_monitor::change_type> & drift_monitor::get_changes() const
+    {
+      return _changes_;
+    }
+
+    void drift_monitor::report(const std::vector<const std::string *> & names_,
+                               const std::string & indent_, std::ostream & out_) const
+    {
+      out_ << indent_ << "Efficiency drifts (CUSUM slack " << _slack_ << ", threshold " << _threshold_
+           << ", " << _windows_ << " windows of ";
+      if (_window_seconds_ > 0.0) {
+        out_ << _window_seconds_ << " s";
+      } else {
+        out_ << _window_events_ << " events";
+      }
+      out_ << ")" << std::endl;
+      if (_changes_.empty()) {
+        out_ << indent_ << " ↳ No efficiency change detected" << std::endl;
+        return;
+      }
+      const std::ios::fmtflags flags = out_.flags();
+      const std::streamsize precision = out_.precision();
+      out_ << std::fixed;
+      for (size_t i = 0; i < _changes_.size(); i++) {
+        const change_type & a_change = _changes_[i];
+        out_ << indent_ << " ↳ Cut '" << *names_[a_change.cut] << "' from event " << a_change.first_event
+             << " (" << std::setprecision(1) << a_change.start_time << " s)"
+             << ", detected at event " << a_change.detection_event << " : "
+             << std::setprecision(2) << 100.0 * a_change.before << "% → "
+             << 100.0 * a_change.after << "%" << std::endl;
+      }
+      out_.flags(flags);
+      out_.precision(precision);
+      if (_lost_changes_ > 0) {
+        out_ << indent_ << " ↳ " << _lost_changes_ << " more changes not listed" << std::endl;
+      }
+      return;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/drift_monitor.cc
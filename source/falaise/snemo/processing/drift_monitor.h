@@ -0,0 +1,159 @@
+/// \file falaise/snemo/processing/drift_monitor.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Online detection of cut efficiency drifts. The job is split into
+ *   windows of a fixed number of events or a fixed duration; the number of
+ *   processed and accepted entries of each cut in the last windows are kept
+ *   in a ring, so that memory does not depend on the length of the run.
+ *
+ *   Window counts are differences of the cumulative cut counters taken
+ *   when a window is closed, which is the only work done outside of event
+ *   counting. Each closed window feeds a two-sided CUSUM test per cut on
+ *   the standardized deviation of its accepted entries from the reference
+ *   efficiency. The reference is learned on the first 'reference_windows'
+ *   windows and then frozen, so that a slow drift can not drag it along;
+ *   testing begins with the next window. When a sum exceeds the threshold,
+ *   a change is recorded from the window where the sum started to grow, and
+ *   the reference is learned again from this window.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_DRIFT_MONITOR_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_DRIFT_MONITOR_H 1
+
+// Standard library
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+
+namespace datatools {
+  class properties;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Cut efficiency drift monitor
+    class drift_monitor
+    {
+    public:
+
+      /// Counters per cut given when closing a window (processed, accepted, rejected)
+      static const size_t COUNTERS_PER_CUT = 3;
+
+      /// Efficiency change
+      struct change_type
+      {
+        size_t cut;               //!< Index of the cut
+        uint64_t first_event;     //!< First event of the window where the change started
+        double start_time;        //!< Time of this window since the start of the job (s)
+        uint64_t detection_event; //!< Event at which the change was detected
+        double before;            //!< Reference efficiency before the change
+        double after;             //!< Efficiency measured since the change
+      };
+
+      /// Constructor
+      drift_monitor();
+
+      /// Initialize through configuration properties, given the cumulative
+      /// counters of the cuts at the start
+      void initialize(const datatools::properties & setup_, const std::vector<uint64_t> & counters_);
+
+      /// Check initialization
+      bool is_initialized() const;
+
+      /// Reset
+      void reset();
+
+      /// Count an event, return true when the current window is complete
+      bool add_event();
+
+      /// Close the current window given the cumulative counters of the cuts
+      void close_window(const std::vector<uint64_t> & counters_);
+
+      /// Return the detected changes
+      const std::vector<change_type> & get_changes() const;
+
+      /// Report the detected changes
+      void report(const std::vector<const std::string *> & names_,
+                  const std::string & indent_, std::ostream & out_) const;
+
+    private:
+
+      /// CUSUM state of a cut
+      struct cusum_type
+      {
+        uint64_t processed;       //!< Processed entries of the reference
+        uint64_t accepted;        //!< Accepted entries of the reference
+        size_t windows;           //!< Number of windows of the reference
+        double upper;             //!< Upper CUSUM
+        double lower;             //!< Lower CUSUM
+        uint64_t upper_start;     //!< Window where the upper CUSUM started to grow
+        uint64_t lower_start;     //!< Window where the lower CUSUM started to grow
+      };
+
+      /// Record a change of a cut starting at a given window
+      void _change_(const size_t cut_, const uint64_t start_window_);
+
+      /// Time since the start of the job (s)
+      double _now_() const;
+
+    private:
+
+      bool _initialized_;                  //!< Initialization flag
+      size_t _ncuts_;                      //!< Number of cuts
+      uint64_t _window_events_;            //!< Number of events per window (event windows)
+      double _window_seconds_;             //!< Duration of a window (time windows)
+      size_t _nwindows_;                   //!< Number of windows in the ring
+      size_t _reference_windows_;          //!< Number of windows to learn a reference
+      double _slack_;                      //!< CUSUM slack (in standard deviations)
+      double _threshold_;                  //!< CUSUM threshold (in standard deviations)
+      size_t _max_changes_;                //!< Maximum number of recorded changes
+      int64_t _start_ns_;                  //!< Start of the job
+      uint64_t _events_;                   //!< Number of events
+      uint64_t _window_first_event_;       //!< First event of the current window
+      double _window_start_;               //!< Start time of the current window
+      uint64_t _windows_;                  //!< Number of closed windows
+      std::vector<uint64_t> _window_begin_counters_; //!< Cut counters at the start of the current window
+      std::vector<uint64_t> _ring_;        //!< Processed and accepted entries per window and cut
+      std::vector<uint64_t> _ring_first_events_; //!< First event of the windows in the ring
+      std::vector<double> _ring_start_times_;    //!< Start time of the windows in the ring
+      std::vector<cusum_type> _cusums_;    //!< CUSUM state per cut
+      std::vector<change_type> _changes_;  //!< Detected changes
+      uint64_t _lost_changes_;             //!< Changes beyond the maximum number
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_DRIFT_MONITOR_H
+
+// end of falaise/snemo/processing/drift_monitor.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,113 @@
+/// \file falaise/snemo/processing/event_id_set.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/event_id_set.h>
+
+// This project:
+#include <falaise/snemo/processing/hyperloglog.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+      const size_t INITIAL_CAPACITY = 1024;
+    }
+
+    event_id_set::event_id_set()
+    {
+      clear();
+      return;
+    }
+
+    void event_id_set::clear()
+    {
+      std::vector<uint64_t>().swap(_slots_);
+      _size_ = 0;
+      _has_null_key_ = false;
+      return;
+    }
+
+    bool event_id_set::insert(const uint64_t key_)
+    {
+      if (key_ == 0) {
+        if (_has_null_key_) return false;
+        _has_null_key_ = true;
+        return true;
+      }
+      if (_slots_.empty()) _slots_.assign(INITIAL_CAPACITY, 0);
+      const size_t mask = _slots_.size() - 1;
+      size_t i = hyperloglog::hash(key_) & mask;
+      while (_slots_[i] != 0) {
+        if (_slots_[i] == key_) return false;
+        i = (i + 1) & mask;
+      }
+      _slots_[i] = key_;
+      _size_++;
+      // Keep the load factor below 0.7
+      if (10 * _size_ > 7 * _slots_.size()) _grow_();
+      return true;
+    }
+
+    bool event_id_set::contains(const uint64_t key_) const
+    {
+      if (key_ == 0) return _has_null_key_;
+      if (_slots_.empty()) return false;
+      const size_t mask = _slots_.size() - 1;
+      size_t i = hyperloglog::hash(key_) & mask;
+      while (_slots_[i] != 0) {
+        if (_slots_[i] == key_) return true;
+        i = (i + 1) & mask;
+      }
+      return false;
+    }
+
+    size_t event_id_set::size() const
+    {
+      return _size_ + (_has_null_key_ ? 1 : 0);
+    }
+
+    size_t event_id_set::get_capacity() const
+    {
+      return _slots_.size();
+    }
+
+    size_t event_id_set::get_memory_size() const
+    {
+      return _slots_.capacity() * sizeof(uint64_t);
+    }
+
+    void event_id_set::get_keys(std::vector<uint64_t> & keys_) const
+    {
+      keys_.reserve(keys_.size() + size());
+      if (_has_null_key_) keys_.push_back(0);
+      for (size_t i = 0; i < _slots_.size(); i++) {
+        if (_slots_[i] != 0) keys_.push_back(_slots_[i]);
+      }
+      return;
+    }
+
+    void event_id_set::_grow_()
+    {
+      std::vector<uint64_t> old_slots(2 * _slots_.size(), 0);
+      old_slots.swap(_slots_);
+      for (size_t i = 0; i < old_slots.size(); i++) {
+        if (old_slots[i] != 0) _insert_new_(old_slots[i]);
+      }
+      return;
+    }
+
+    void event_id_set::_insert_new_(const uint64_t key_)
+    {
+      const size_t mask = _slots_.size() - 1;
+      size_t i = hyperloglog::hash(key_) & mask;
+      while (_slots_[i] != 0) i = (i + 1) & mask;
+      _slots_[i] = key_;
+      return;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/event_id_set.cc
@@ -0,0 +1,99 @@
+/// \file falaise/snemo/processing/event_id_set.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Exact set of 64 bits keys stored in a single flat open-addressing
+ *   table with linear probing. The capacity is a power of two grown by
+ *   doubling when the load factor exceeds 70%, so the table uses between
+ *   11.4 and 22.9 bytes per key, i.e. at most 23 MB (32 MB transiently
+ *   while growing) per million keys.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_EVENT_ID_SET_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_EVENT_ID_SET_H 1
+
+// Standard library
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Open-addressing set of 64 bits keys
+    class event_id_set
+    {
+    public:
+
+      /// Constructor
+      event_id_set();
+
+      /// Remove all keys and release the memory
+      void clear();
+
+      /// Insert a key, return false if it was already present
+      bool insert(const uint64_t key_);
+
+      /// Check if a key is present
+      bool contains(const uint64_t key_) const;
+
+      /// Return the number of keys
+      size_t size() const;
+
+      /// Return the number of slots
+      size_t get_capacity() const;
+
+      /// Return the memory used by the table in bytes
+      size_t get_memory_size() const;
+
+      /// Append all keys to a vector, in no particular order
+      void get_keys(std::vector<uint64_t> & keys_) const;
+
+    private:
+
+      /// Double the capacity and reinsert the keys
+      void _grow_();
+
+      /// Insert a non null key known to be absent
+      void _insert_new_(const uint64_t key_);
+
+    private:
+
+      std::vector<uint64_t> _slots_; //!< Table slots, 0 marking empty ones
+      size_t _size_;                 //!< Number of non null keys
+      bool _has_null_key_;           //!< The null key is stored aside
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_EVENT_ID_SET_H
+
+// end of falaise/snemo/processing/event_id_set.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
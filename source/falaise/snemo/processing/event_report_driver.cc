@@ -0,0 +1,407 @@
+/// \file falaise/snemo/processing/event_report_driver.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/event_report_driver.h>
+
+// This project:
+#include <falaise/snemo/processing/state_io.h>
+
+// Standard library:
+#include <cmath>
+#include <utility>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/things.h>
+#include <bayeux/datatools/object_configuration_description.h>
+
+// - Falaise:
+#include <falaise/snemo/datamodels/data_model.h>
+#include <falaise/snemo/datamodels/event_header.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      /// Size of the blocks of logged event ids (8192 ids)
+      const size_t KEY_BLOCK_SIZE = 65536;
+
+    }
+
+    // static
+    const std::string & event_report_driver::get_id()
+    {
+      static const std::string _id("ERD");
+      return _id;
+    }
+
+    // static
+    uint64_t event_report_driver::make_key(const int32_t run_number_, const int32_t event_number_)
+    {
+      return ((uint64_t) (uint32_t) run_number_ << 32) | (uint64_t) (uint32_t) event_number_;
+    }
+
+    // static
+    int32_t event_report_driver::get_run_number(const uint64_t key_)
+    {
+      return (int32_t) (uint32_t) (key_ >> 32);
+    }
+
+    // static
+    int32_t event_report_driver::get_event_number(const uint64_t key_)
+    {
+      return (int32_t) (uint32_t) (key_ & 0xffffffffULL);
+    }
+
+    void event_report_driver::set_initialized(const bool initialized_)
+    {
+      _initialized_ = initialized_;
+      return;
+    }
+
+    bool event_report_driver::is_initialized() const
+    {
+      return _initialized_;
+    }
+
+    void event_report_driver::set_logging_priority(const datatools::logger::priority priority_)
+    {
+      _logging_priority_ = priority_;
+      return;
+    }
+
+    datatools::logger::priority event_report_driver::get_logging_priority() const
+    {
+      return _logging_priority_;
+    }
+
+    bool event_report_driver::is_exact() const
+    {
+      return _exact_;
+    }
+
+    uint64_t event_report_driver::get_number_of_processed_events() const
+    {
+      return _processed_;
+    }
+
+    double event_report_driver::get_estimated_distinct_events() const
+    {
+      return _sketch_.estimate();
+    }
+
+    uint64_t event_report_driver::get_number_of_duplicates() const
+    {
+      return _duplicates_;
+    }
+
+    /// Constructor
+    event_report_driver::event_report_driver()
+    {
+      _set_defaults();
+      return;
+    }
+
+    /// Destructor
+    event_report_driver::~event_report_driver()
+    {
+      if (is_initialized()) {
+        reset();
+      }
+      return;
+    }
+
+    /// Initialize the driver through configuration properties
+    void event_report_driver::initialize(const datatools::properties & setup_)
+    {
+      DT_THROW_IF(is_initialized(), std::logic_error, "Driver is already initialized !");
+
+      // Logging priority
+      datatools::logger::priority lp = datatools::logger::extract_logging_configuration(setup_);
+      DT_THROW_IF(lp == datatools::logger::PRIO_UNDEFINED,
+                  std::logic_error,
+                  "Invalid logging priority level for event report driver !");
+      set_logging_priority(lp);
+
+      if (setup_.has_key("EH_label")) {
+        _EH_label_ = setup_.fetch_string("EH_label");
+      }
+
+      if (setup_.has_key("exact")) {
+        _exact_ = setup_.fetch_boolean("exact");
+      }
+
+      if (setup_.has_key("precision")) {
+        const int precision = setup_.fetch_integer("precision");
+        DT_THROW_IF(precision < (int) hyperloglog::MIN_PRECISION || precision > (int) hyperloglog::MAX_PRECISION,
+                    std::domain_error,
+                    "Invalid precision " << precision << " ! Must be between "
+                    << hyperloglog::MIN_PRECISION << " and " << hyperloglog::MAX_PRECISION << " !");
+        _sketch_.set_precision(precision);
+      }
+
+      if (setup_.has_key("max_listed_duplicates")) {
+        const int max_listed = setup_.fetch_integer("max_listed_duplicates");
+        DT_THROW_IF(max_listed < 0, std::domain_error,
+                    "Invalid maximal number of listed duplicates " << max_listed << " !");
+        _max_listed_duplicates_ = max_listed;
+      }
+
+      set_initialized(true);
+      return;
+    }
+
+    /// Reset the driver
+    void event_report_driver::reset()
+    {
+      DT_THROW_IF(! is_initialized(), std::logic_error, "Driver is not initialized !");
+      _set_defaults();
+      return;
+    }
+
+    void event_report_driver::_set_defaults()
+    {
+      _initialized_      = false;
+      _logging_priority_ = datatools::logger::PRIO_WARNING;
+      _EH_label_ = snemo::datamodel::data_info::default_event_header_label();
+      _exact_ = false;
+      _max_listed_duplicates_ = 20;
+      _processed_      = 0;
+      _missing_header_ = 0;
+      _duplicates_     = 0;
+      _sketch_.set_precision(14);
+      _ids_.clear();
+      _key_log_ = false;
+      _key_blocks_.clear();
+      _key_chunk_.clear();
+      _listed_duplicates_.clear();
+      return;
+    }
+
+    void event_report_driver::process(const datatools::things & data_)
+    {
+      DT_THROW_IF(! is_initialized(), std::logic_error, "Driver is not initialized !");
+      if (! data_.has(_EH_label_) || ! data_.is_a<snemo::datamodel::event_header>(_EH_label_)) {
+        _missing_header_++;
+        return;
+      }
+      const snemo::datamodel::event_header & eh = data_.get<snemo::datamodel::event_header>(_EH_label_);
+      const datatools::event_id & id = eh.get_id();
+      _processed_++;
+      _add_(make_key(id.get_run_number(), id.get_event_number()));
+      return;
+    }
+
+    void event_report_driver::_add_(const uint64_t key_)
+    {
+      _sketch_.add(key_);
+      if (! _exact_) return;
+      if (_ids_.insert(key_)) {
+        _log_key_(key_);
+      } else {
+        _duplicates_++;
+        if (_listed_duplicates_.size() < _max_listed_duplicates_) {
+          _listed_duplicates_.push_back(key_);
+        }
+      }
+      return;
+    }
+
+    void event_report_driver::_log_key_(const uint64_t key_)
+    {
+      if (! _key_log_) return;
+      char bytes[8];
+      for (size_t i = 0; i < 8; i++) bytes[i] = (char) ((key_ >> (8 * i)) & 0xFF);
+      _key_chunk_.append(bytes, 8);
+      if (_key_chunk_.size() >= KEY_BLOCK_SIZE) {
+        _key_blocks_.push_back(std::make_shared<const std::string>(std::move(_key_chunk_)));
+        _key_chunk_.clear();
+        _key_chunk_.reserve(KEY_BLOCK_SIZE);
+      }
+      return;
+    }
+
+    void event_report_driver::report(std::ostream & out_)
+    {
+      const double distinct = _sketch_.estimate();
+      out_ << "Event report" << (_exact_ ? " (exact mode)" : "") << std::endl;
+      out_ << " ↳ Processed events          : " << _processed_ << std::endl;
+      if (_missing_header_ > 0) {
+        out_ << " ↳ Events without '" << _EH_label_ << "' bank : " << _missing_header_ << std::endl;
+      }
+      const std::ios::fmtflags flags = out_.flags();
+      const std::streamsize precision = out_.precision();
+      out_.setf(std::ios::fixed);
+      out_.precision(0);
+      out_ << " ↳ Distinct events (HLL)     : " << distinct
+           << " ± " << distinct * _sketch_.get_relative_error()
+           << " (" << _sketch_.get_memory_size() / 1024 << " KiB)" << std::endl;
+      if (_exact_) {
+        out_ << " ↳ Distinct events (exact)   : " << _ids_.size()
+             << " (" << _ids_.get_memory_size() / 1024 << " KiB)" << std::endl;
+        out_ << " ↳ Duplicated events         : " << _duplicates_ << std::endl;
+        for (size_t i = 0; i < _listed_duplicates_.size(); i++) {
+          out_ << "   - run " << get_run_number(_listed_duplicates_[i])
+               << " event " << get_event_number(_listed_duplicates_[i]) << std::endl;
+        }
+        if (_duplicates_ > _listed_duplicates_.size()) {
+          out_ << "   - ... (" << _duplicates_ - _listed_duplicates_.size() << " more)" << std::endl;
+        }
+      } else {
+        const double excess = (double) _processed_ - distinct;
+        out_ << " ↳ Estimated duplicates      : "
+             << (excess > 3.0 * distinct * _sketch_.get_relative_error() ? excess : 0.0)
+             << " (use 'ERD.exact' to list them)" << std::endl;
+      }
+      out_.flags(flags);
+      out_.precision(precision);
+      return;
+    }
+
+    void event_report_driver::store_state(state_writer & writer_) const
+    {
+      writer_.write_uint64(_processed_);
+      writer_.write_uint64(_missing_header_);
+      writer_.write_uint64(_duplicates_);
+      const std::vector<uint8_t> & registers = _sketch_.get_registers();
+      writer_.write_string(std::string(registers.begin(), registers.end()));
+      // Exact event ids are stored from the key log, see 'get_key_blocks'
+      writer_.write_uint64(_listed_duplicates_.size());
+      for (size_t i = 0; i < _listed_duplicates_.size(); i++) writer_.write_uint64(_listed_duplicates_[i]);
+      return;
+    }
+
+    void event_report_driver::load_state(state_reader & reader_)
+    {
+      _processed_      += reader_.read_uint64();
+      _missing_header_ += reader_.read_uint64();
+      _duplicates_     += reader_.read_uint64();
+      const std::string registers = reader_.read_string();
+      hyperloglog resumed;
+      resumed.set_registers(std::vector<uint8_t>(registers.begin(), registers.end()));
+      if (resumed.get_precision() == _sketch_.get_precision()) {
+        _sketch_.merge(resumed);
+      } else {
+        DT_LOG_WARNING(get_logging_priority(), "Resumed HyperLogLog precision " << resumed.get_precision()
+                       << " differs from the configured one: distinct events are not resumed !");
+      }
+      const uint64_t nlisted = reader_.read_uint64();
+      for (uint64_t i = 0; i < nlisted; i++) {
+        const uint64_t key = reader_.read_uint64();
+        if (_listed_duplicates_.size() < _max_listed_duplicates_) _listed_duplicates_.push_back(key);
+      }
+      return;
+    }
+
+    void event_report_driver::set_key_log(const bool key_log_)
+    {
+      _key_log_ = key_log_;
+      return;
+    }
+
+    void event_report_driver::get_key_blocks(state_block_list & blocks_, uint64_t & size_) const
+    {
+      blocks_.insert(blocks_.end(), _key_blocks_.begin(), _key_blocks_.end());
+      size_ = _key_blocks_.size() * KEY_BLOCK_SIZE;
+      if (! _key_chunk_.empty()) {
+        blocks_.push_back(std::make_shared<const std::string>(_key_chunk_));
+        size_ += _key_chunk_.size();
+      }
+      return;
+    }
+
+    void event_report_driver::load_keys(state_reader & reader_)
+    {
+      if (! _exact_) {
+        DT_LOG_WARNING(get_logging_priority(), "Exact event ids are resumed whereas exact mode is not set !");
+        return;
+      }
+      while (! reader_.at_end()) {
+        const uint64_t key = reader_.read_uint64();
+        if (_ids_.insert(key)) _log_key_(key);
+      }
+      return;
+    }
+
+    // static
+    void event_report_driver::init_ocd(datatools::object_configuration_description & ocd_)
+    {
+
+      // Prefix "ERD" stands for "Event Report Driver" :
+      datatools::logger::declare_ocd_logging_configuration(ocd_, "fatal", "ERD.");
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("ERD.EH_label")
+          .set_terse_description("The label of the event header bank")
+          .set_traits(datatools::TYPE_STRING)
+          .set_mandatory(false)
+          .set_default_value_string(snemo::datamodel::data_info::default_event_header_label());
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("ERD.exact")
+          .set_terse_description("Flag to count and list duplicated events exactly")
+          .set_traits(datatools::TYPE_BOOLEAN)
+          .set_mandatory(false)
+          .set_default_value_boolean(false)
+          .set_long_description("Every event id is kept in memory, which costs between \n"
+                                "11 and 23 MB per million distinct events.             \n")
+          .add_example("List duplicated events:: \n"
+                       "                          \n"
+                       "  ERD.exact : boolean = true \n"
+                       "                          \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("ERD.precision")
+          .set_terse_description("Precision of the HyperLogLog distinct events estimator")
+          .set_traits(datatools::TYPE_INTEGER)
+          .set_mandatory(false)
+          .set_default_value_integer(14)
+          .set_long_description("The estimator uses 2^precision bytes whatever the number \n"
+                                "of events, for a relative error of 1.04/sqrt(2^precision).\n"
+                                "Allowed values range from 4 to 18.                       \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("ERD.max_listed_duplicates")
+          .set_terse_description("Maximal number of duplicated events listed in the report")
+          .set_traits(datatools::TYPE_INTEGER)
+          .set_mandatory(false)
+          .set_default_value_integer(20);
+      }
+
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+/* OCD support */
+#include <bayeux/datatools/object_configuration_description.h>
+DOCD_CLASS_IMPLEMENT_LOAD_BEGIN(snemo::processing::event_report_driver,ocd_)
+{
+  ocd_.set_class_name("snemo::processing::event_report_driver");
+  ocd_.set_class_description("A driver class to produce report related to distinct and duplicated events");
+  ocd_.set_class_library("Falaise_ProcessReport");
+  ocd_.set_class_documentation("This driver counts distinct events and lists duplicated ones.\n");
+
+  // Invoke specific OCD support :
+  ::snemo::processing::event_report_driver::init_ocd(ocd_);
+
+  ocd_.set_validation_support(true);
+  ocd_.lock();
+  return;
+}
+DOCD_CLASS_IMPLEMENT_LOAD_END() // Closing macro for implementation
+DOCD_CLASS_SYSTEM_REGISTRATION(snemo::processing::event_report_driver,
+                               "snemo::processing::event_report_driver")
+
+// end of falaise/snemo/processing/event_report_driver.cc
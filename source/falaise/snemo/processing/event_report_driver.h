@@ -0,0 +1,188 @@
+/// \file falaise/snemo/processing/event_report_driver.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   A driver class that counts distinct events from the run and event
+ *   numbers of the event header bank. A HyperLogLog sketch gives an
+ *   estimate of the number of distinct events in a fixed amount of memory
+ *   (2^precision bytes). In exact mode, every event id is also inserted in
+ *   a flat open-addressing set (between 11 and 23 MB per million events)
+ *   so that duplicated events are counted exactly and listed. When the
+ *   report state is checkpointed, new event ids are also appended to a log
+ *   of immutable blocks (8 MB per million events) that checkpoints share
+ *   instead of encoding the whole set again.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_EVENT_REPORT_DRIVER_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_EVENT_REPORT_DRIVER_H 1
+
+// Standard library
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/datatools
+#include <bayeux/datatools/logger.h>
+
+// This project:
+#include <falaise/snemo/processing/hyperloglog.h>
+#include <falaise/snemo/processing/event_id_set.h>
+#include <falaise/snemo/processing/state_io.h>
+
+namespace datatools {
+  class properties;
+  class things;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Event report driver
+    class event_report_driver
+    {
+    public:
+
+      /// Return driver id
+      static const std::string & get_id();
+
+      /// Build the 64 bits key of an event from its run and event numbers
+      static uint64_t make_key(const int32_t run_number_, const int32_t event_number_);
+
+      /// Return the run number of an event key
+      static int32_t get_run_number(const uint64_t key_);
+
+      /// Return the event number of an event key
+      static int32_t get_event_number(const uint64_t key_);
+
+      /// Setting initialization flag
+      void set_initialized(const bool initialized_);
+
+      /// Getting initialization flag
+      bool is_initialized() const;
+
+      /// Setting logging priority
+      void set_logging_priority(const datatools::logger::priority priority_);
+
+      /// Getting logging priority
+      datatools::logger::priority get_logging_priority() const;
+
+      /// Check if duplicates are counted exactly
+      bool is_exact() const;
+
+      /// Return the number of processed events
+      uint64_t get_number_of_processed_events() const;
+
+      /// Return the estimated number of distinct events
+      double get_estimated_distinct_events() const;
+
+      /// Return the number of duplicated events (exact mode)
+      uint64_t get_number_of_duplicates() const;
+
+      /// Constructor:
+      event_report_driver();
+
+      /// Destructor:
+      ~event_report_driver();
+
+      /// Initialize the driver through configuration properties
+      void initialize(const datatools::properties & setup_);
+
+      /// Reset the driver
+      void reset();
+
+      /// Record the event id of the current event
+      void process(const datatools::things & data_);
+
+      /// Main report method
+      void report(std::ostream & out_);
+
+      /// Store the event ids
+      void store_state(state_writer & writer_) const;
+
+      /// Add event ids recorded by a previous job
+      void load_state(state_reader & reader_);
+
+      /// Set the flag to keep a log of the exact event ids for checkpoints
+      void set_key_log(const bool key_log_);
+
+      /// Return the blocks of the logged exact event ids and their total size.
+      /// Full blocks are shared, only the last partial one is copied.
+      void get_key_blocks(state_block_list & blocks_, uint64_t & size_) const;
+
+      /// Add exact event ids encoded in logged blocks by a previous job
+      void load_keys(state_reader & reader_);
+
+      /// OCD support:
+      static void init_ocd(datatools::object_configuration_description & ocd_);
+
+    protected:
+
+      /// Set default values to class members:
+      void _set_defaults();
+
+    private:
+
+      /// Record an event key
+      void _add_(const uint64_t key_);
+
+      /// Append a new exact event id to the key log
+      void _log_key_(const uint64_t key_);
+
+    private:
+
+      bool _initialized_;                             //!< Initialize flag
+      datatools::logger::priority _logging_priority_; //!< Logging flag
+      std::string _EH_label_;                         //!< Event header bank label
+      bool _exact_;                                   //!< Exact mode flag
+      size_t _max_listed_duplicates_;                 //!< Maximal number of listed duplicates
+      uint64_t _processed_;                           //!< Number of events with an event header
+      uint64_t _missing_header_;                      //!< Number of events without event header
+      uint64_t _duplicates_;                          //!< Number of duplicated events (exact mode)
+      hyperloglog _sketch_;                           //!< Distinct events estimator
+      event_id_set _ids_;                             //!< Exact set of event ids
+      bool _key_log_;                                 //!< Log the exact event ids
+      state_block_list _key_blocks_;                  //!< Full blocks of logged event ids
+      std::string _key_chunk_;                        //!< Partial block of logged event ids
+      std::vector<uint64_t> _listed_duplicates_;      //!< First duplicated event keys
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#include <bayeux/datatools/ocd_macros.h>
+
+// Declare the OCD interface of the module
+DOCD_CLASS_DECLARATION(snemo::processing::event_report_driver)
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_EVENT_REPORT_DRIVER_H
+
+// end of falaise/snemo/processing/event_report_driver.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
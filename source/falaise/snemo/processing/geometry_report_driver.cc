@@ -6,17 +6,113 @@
 // Standard library:
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <unistd.h>
 
 // Third party:
 // - Bayeux/datatools:
 #include <bayeux/datatools/properties.h>
-// - Bayeux/cuts:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/utils.h>
+#include <bayeux/datatools/object_configuration_description.h>
+// - Bayeux/geomtools:
 #include <bayeux/geomtools/manager.h>
+#include <bayeux/geomtools/mapping.h>
+#include <bayeux/geomtools/id_mgr.h>
 
 namespace snemo {
 
   namespace processing {
 
+    namespace {
+
+      void fnv1a(const char * data_, const size_t size_, uint64_t & hash_)
+      {
+        for (size_t i = 0; i < size_; i++) {
+          hash_ ^= (unsigned char) data_[i];
+          hash_ *= 1099511628211ULL;
+        }
+        return;
+      }
+
+      void fnv1a(const std::string & data_, uint64_t & hash_)
+      {
+        fnv1a(data_.data(), data_.size() + 1, hash_);
+        return;
+      }
+
+      /// Mapped volume: key in the mapping and its geometry information
+      typedef std::pair<const geomtools::geom_id *, const geomtools::geom_info *> volume_type;
+
+      /// Validation of one category
+      struct category_check_type
+      {
+        const std::string * name;
+        int type;
+        size_t depth;
+        std::vector<volume_type> volumes;
+        std::vector<std::string> issues;
+        uint64_t number_of_issues;
+      };
+
+      bool volume_id_less(const volume_type & a_, const volume_type & b_)
+      {
+        return a_.second->get_geom_id() < b_.second->get_geom_id();
+      }
+
+      void check_category(category_check_type & check_, const size_t max_listed_)
+      {
+        check_.number_of_issues = 0;
+        if (check_.volumes.empty()) {
+          check_.issues.push_back("Category '" + *check_.name + "' has no mapped volume");
+          check_.number_of_issues++;
+          return;
+        }
+        for (size_t i = 0; i < check_.volumes.size(); i++) {
+          const geomtools::geom_id & key = *check_.volumes[i].first;
+          const geomtools::geom_id & id  = check_.volumes[i].second->get_geom_id();
+          if (id.get_depth() != check_.depth) {
+            if (check_.issues.size() < max_listed_) {
+              std::ostringstream issue;
+              issue << "Category '" << *check_.name << "': " << id << " has depth " << id.get_depth()
+                    << " instead of " << check_.depth;
+              check_.issues.push_back(issue.str());
+            }
+            check_.number_of_issues++;
+          }
+          if (id != key) {
+            if (check_.issues.size() < max_listed_) {
+              std::ostringstream issue;
+              issue << "Category '" << *check_.name << "': " << id << " is mapped as " << key;
+              check_.issues.push_back(issue.str());
+            }
+            check_.number_of_issues++;
+          }
+        }
+        std::sort(check_.volumes.begin(), check_.volumes.end(), volume_id_less);
+        for (size_t i = 1; i < check_.volumes.size(); i++) {
+          const geomtools::geom_id & id = check_.volumes[i].second->get_geom_id();
+          if (id == check_.volumes[i - 1].second->get_geom_id()) {
+            if (check_.issues.size() < max_listed_) {
+              std::ostringstream issue;
+              issue << "Category '" << *check_.name << "': duplicated " << id;
+              check_.issues.push_back(issue.str());
+            }
+            check_.number_of_issues++;
+          }
+        }
+        return;
+      }
+
+    }
+
     const std::string & geometry_report_driver::get_id()
     {
       static const std::string s("GRD");
@@ -112,6 +208,35 @@ namespace snemo {
         }
       }
 
+      if (setup_.has_key("validate")) {
+        _validate_ = setup_.fetch_boolean("validate");
+      }
+
+      if (setup_.has_key("validation.threads")) {
+        const int n = setup_.fetch_integer("validation.threads");
+        DT_THROW_IF(n < 0, std::domain_error, "Invalid number of validation threads " << n << " !");
+        _validation_threads_ = n;
+      }
+
+      if (setup_.has_key("validation.cache")) {
+        _validation_cache_ = setup_.fetch_path("validation.cache");
+      }
+
+      if (setup_.has_key("validation.hash_files")) {
+        setup_.fetch("validation.hash_files", _hash_files_);
+      }
+      DT_THROW_IF(! _validation_cache_.empty() && _hash_files_.empty(), std::logic_error,
+                  "Missing 'validation.hash_files' for the validation cache '"
+                  << _validation_cache_ << "' !");
+
+      if (setup_.has_key("validation.max_listed")) {
+        const int n = setup_.fetch_integer("validation.max_listed");
+        DT_THROW_IF(n < 0, std::domain_error, "Invalid maximum number of listed issues " << n << " !");
+        _max_listed_ = n;
+      }
+
+      if (_validate_) validate();
+
       set_initialized(true);
       return;
     }
@@ -133,6 +258,17 @@ namespace snemo {
       _logging_priority_ = datatools::logger::PRIO_WARNING;
       _print_report_     = PRINT_NONE;
       _geometry_manager_ = 0;
+      _validate_           = false;
+      _validation_threads_ = 0;
+      _validation_cache_.clear();
+      _hash_files_.clear();
+      _max_listed_         = 20;
+      _validated_          = false;
+      _from_cache_         = false;
+      _categories_.clear();
+      _volumes_.clear();
+      _issues_.clear();
+      _number_of_issues_   = 0;
       return;
     }
 
@@ -143,6 +279,204 @@ namespace snemo {
     }
 
 
+    uint64_t geometry_report_driver::compute_geometry_hash() const
+    {
+      const geomtools::manager & a_manager = get_geometry_manager();
+      uint64_t hash = 14695981039346656037ULL;
+      fnv1a(a_manager.get_setup_label(), hash);
+      fnv1a(a_manager.get_setup_version(), hash);
+      const geomtools::id_mgr::categories_by_name_col_type & categories
+        = a_manager.get_id_mgr().categories_by_name();
+      for (geomtools::id_mgr::categories_by_name_col_type::const_iterator i = categories.begin();
+           i != categories.end(); ++i) {
+        std::ostringstream category;
+        category << i->first << ':' << i->second.get_type() << ':' << i->second.get_depth();
+        fnv1a(category.str(), hash);
+      }
+      // Geometry configuration files: the mapping is built from them, and
+      // hashing them costs far less than walking every mapped volume
+      for (size_t i = 0; i < _hash_files_.size(); i++) {
+        std::string filename = _hash_files_[i];
+        DT_THROW_IF(! datatools::fetch_path_with_env(filename), std::logic_error,
+                    "Cannot resolve geometry file '" << _hash_files_[i] << "' !");
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        DT_THROW_IF(! file, std::runtime_error, "Cannot read geometry file '" << filename << "' !");
+        char buffer[65536];
+        while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+          fnv1a(buffer, file.gcount(), hash);
+        }
+      }
+      return hash;
+    }
+
+    void geometry_report_driver::validate()
+    {
+      const uint64_t hash = compute_geometry_hash();
+      if (! _validation_cache_.empty() && _load_cache_(hash)) {
+        DT_LOG_NOTICE(get_logging_priority(), "Geometry validation results read from '"
+                      << _validation_cache_ << "'");
+        _from_cache_ = true;
+      } else {
+        _validate_mapping_();
+        _from_cache_ = false;
+        if (! _validation_cache_.empty()) _store_cache_(hash);
+      }
+      _validated_ = true;
+      return;
+    }
+
+    uint64_t geometry_report_driver::get_number_of_issues() const
+    {
+      return _number_of_issues_;
+    }
+
+    void geometry_report_driver::_validate_mapping_()
+    {
+      const geomtools::manager & a_manager = get_geometry_manager();
+      const geomtools::id_mgr::categories_by_name_col_type & categories
+        = a_manager.get_id_mgr().categories_by_name();
+
+      std::vector<category_check_type> checks(categories.size());
+      std::map<int, size_t> check_by_type;
+      size_t icheck = 0;
+      for (geomtools::id_mgr::categories_by_name_col_type::const_iterator i = categories.begin();
+           i != categories.end(); ++i, ++icheck) {
+        checks[icheck].name  = &i->first;
+        checks[icheck].type  = i->second.get_type();
+        checks[icheck].depth = i->second.get_depth();
+        check_by_type[i->second.get_type()] = icheck;
+      }
+
+      // Dispatch mapped volumes by category
+      _issues_.clear();
+      _number_of_issues_ = 0;
+      const geomtools::geom_info_dict_type & infos = a_manager.get_mapping().get_geom_infos();
+      for (geomtools::geom_info_dict_type::const_iterator i = infos.begin(); i != infos.end(); ++i) {
+        std::map<int, size_t>::const_iterator found = check_by_type.find(i->first.get_type());
+        if (found == check_by_type.end()) {
+          if (_issues_.size() < _max_listed_) {
+            std::ostringstream issue;
+            issue << i->first << " has no geometry category";
+            _issues_.push_back(issue.str());
+          }
+          _number_of_issues_++;
+          continue;
+        }
+        checks[found->second].volumes.push_back(volume_type(&i->first, &i->second));
+      }
+
+      // Check categories in parallel, the biggest ones first
+      std::vector<size_t> order(checks.size());
+      for (size_t i = 0; i < order.size(); i++) order[i] = i;
+      std::sort(order.begin(), order.end(), [&checks] (const size_t a_, const size_t b_)
+                { return checks[a_].volumes.size() > checks[b_].volumes.size(); });
+      unsigned int nthreads = _validation_threads_;
+      if (nthreads == 0) nthreads = std::max(1u, std::thread::hardware_concurrency());
+      nthreads = std::min<size_t>(nthreads, std::max<size_t>(1, checks.size()));
+      std::atomic<size_t> next(0);
+      const size_t max_listed = _max_listed_;
+      auto worker = [&checks, &order, &next, max_listed] ()
+        {
+          for (size_t i = next++; i < order.size(); i = next++) {
+            check_category(checks[order[i]], max_listed);
+          }
+        };
+      std::vector<std::thread> threads;
+      for (unsigned int i = 1; i < nthreads; i++) threads.push_back(std::thread(worker));
+      worker();
+      for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+      _categories_.clear();
+      _volumes_.clear();
+      for (size_t i = 0; i < checks.size(); i++) {
+        const category_check_type & a_check = checks[i];
+        _categories_.push_back(*a_check.name);
+        _volumes_.push_back(a_check.volumes.size());
+        _number_of_issues_ += a_check.number_of_issues;
+        for (size_t j = 0; j < a_check.issues.size() && _issues_.size() < _max_listed_; j++) {
+          _issues_.push_back(a_check.issues[j]);
+        }
+      }
+      return;
+    }
+
+    bool geometry_report_driver::_load_cache_(const uint64_t hash_)
+    {
+      std::ifstream file(_validation_cache_.c_str());
+      if (! file) return false;
+      file.close();
+      std::ostringstream hash;
+      hash << std::hex << hash_;
+      try {
+        datatools::properties cache;
+        datatools::properties::read_config(_validation_cache_, cache);
+        if (! cache.has_key("hash") || cache.fetch_string("hash") != hash.str()) return false;
+        _categories_.clear();
+        _volumes_.clear();
+        _issues_.clear();
+        if (cache.has_key("categories")) cache.fetch("categories", _categories_);
+        if (cache.has_key("volumes")) cache.fetch("volumes", _volumes_);
+        if (cache.has_key("issues")) cache.fetch("issues", _issues_);
+        _number_of_issues_ = (uint64_t) cache.fetch_real("number_of_issues");
+      } catch (std::exception & error) {
+        DT_LOG_WARNING(get_logging_priority(), "Ignoring unreadable validation cache '"
+                       << _validation_cache_ << "' : " << error.what());
+        return false;
+      }
+      return _categories_.size() == _volumes_.size();
+    }
+
+    void geometry_report_driver::_store_cache_(const uint64_t hash_) const
+    {
+      datatools::properties cache;
+      std::ostringstream hash;
+      hash << std::hex << hash_;
+      cache.store_string("hash", hash.str(), "Hash of the geometry configuration");
+      cache.store("categories", _categories_, "Geometry categories");
+      cache.store("volumes", _volumes_, "Number of mapped volumes per category");
+      cache.store("issues", _issues_, "Listed issues");
+      cache.store_real("number_of_issues", (double) _number_of_issues_, "Number of issues");
+      // Jobs sharing the cache only ever see a complete file
+      std::ostringstream tmp_filename;
+      tmp_filename << _validation_cache_ << ".tmp." << ::getpid();
+      try {
+        datatools::properties::write_config(tmp_filename.str(), cache);
+        DT_THROW_IF(std::rename(tmp_filename.str().c_str(), _validation_cache_.c_str()) != 0,
+                    std::runtime_error, std::strerror(errno));
+      } catch (std::exception & error) {
+        std::remove(tmp_filename.str().c_str());
+        DT_LOG_WARNING(get_logging_priority(), "Cannot store the validation cache '"
+                       << _validation_cache_ << "' : " << error.what());
+      }
+      return;
+    }
+
+    void geometry_report_driver::report(std::ostream & out_)
+    {
+      const geomtools::manager & a_manager = get_geometry_manager();
+      out_ << "Geometry '" << a_manager.get_setup_label() << "' version '"
+           << a_manager.get_setup_version() << "'" << std::endl;
+      if (! _validated_) return;
+      out_ << " ↳ Mapped volumes per category"
+           << (_from_cache_ ? " (validation results from cache)" : "") << std::endl;
+      for (size_t i = 0; i < _categories_.size(); i++) {
+        out_ << "   " << std::left << std::setw(40) << _categories_[i] << std::right
+             << std::setw(10) << _volumes_[i] << std::endl;
+      }
+      if (_number_of_issues_ == 0) {
+        out_ << " ↳ Geometry mapping is valid" << std::endl;
+        return;
+      }
+      out_ << " ↳ " << _number_of_issues_ << " issues in the geometry mapping" << std::endl;
+      for (size_t i = 0; i < _issues_.size(); i++) {
+        out_ << "   " << _issues_[i] << std::endl;
+      }
+      if (_number_of_issues_ > _issues_.size()) {
+        out_ << "   ..." << std::endl;
+      }
+      return;
+    }
+
     void geometry_report_driver::_print_geometry_report_() const
     {
       DT_THROW_IF(! has_geometry_manager(), std::logic_error, "Missing cut manager !");
@@ -157,6 +491,57 @@ namespace snemo {
       // Prefix "GRD" stands for "Geometry Report Driver" :
       datatools::logger::declare_ocd_logging_configuration(ocd_, "fatal", "GRD.");
 
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("GRD.validate")
+          .set_terse_description("Flag to validate the geometry mapping")
+          .set_traits(datatools::TYPE_BOOLEAN)
+          .set_mandatory(false)
+          .set_default_value_boolean(false)
+          .set_long_description("Look for categories without mapped volumes, geometry ids \n"
+                                "with a depth different from their category, duplicated  \n"
+                                "ids and ids mapped under another key. Categories are     \n"
+                                "checked by 'GRD.validation.threads' threads (default: the\n"
+                                "number of hardware threads) and at most                  \n"
+                                "'GRD.validation.max_listed' issues (default 20) are      \n"
+                                "listed.                                                  \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("GRD.validation.cache")
+          .set_terse_description("File where validation results are cached")
+          .set_traits(datatools::TYPE_STRING)
+          .set_path(true)
+          .set_mandatory(false)
+          .set_long_description("Results are stored with a hash of the geometry setup     \n"
+                                "label and version, the categories and the content of the \n"
+                                "files listed in 'GRD.validation.hash_files', which is    \n"
+                                "then mandatory. The validation only runs again when this \n"
+                                "hash changes. An unreadable cache is ignored, and the    \n"
+                                "file is replaced atomically.                             \n")
+          .add_example("Cache the validation of the SuperNEMO geometry:: \n"
+                       "                   \n"
+                       "  GRD.validate : boolean = true \n"
+                       "  GRD.validation.cache : string as path = \"geometry_validation.conf\" \n"
+                       "  GRD.validation.hash_files : string[1] as path = \\ \n"
+                       "    \"@falaise:config/snemo/demonstrator/geometry/4.0/manager.conf\" \n"
+                       "                   \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("GRD.validation.hash_files")
+          .set_terse_description("Geometry configuration files the validation cache depends on")
+          .set_traits(datatools::TYPE_STRING, datatools::configuration_property_description::ARRAY)
+          .set_path(true)
+          .set_mandatory(false)
+          .set_long_description("Mandatory with 'GRD.validation.cache'. These files must \n"
+                                "include every file the geometry mapping is built from:  \n"
+                                "mapped volumes are not hashed, so a change in an omitted\n"
+                                "file leaves stale results in the cache.                 \n");
+      }
+
     }
 
   }  // end of namespace processing
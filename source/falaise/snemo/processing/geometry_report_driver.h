@@ -24,6 +24,15 @@
  *
  *   A driver class that produce a report related to detector geometry.
  *
+ *   The geometry mapping can be validated: each geometry category must have
+ *   mapped volumes, their geometry identifiers must have the depth of the
+ *   category, be unique and match the key they are mapped with. Mapped
+ *   volumes are dispatched by category in a single pass, then categories are
+ *   checked in parallel by a pool of threads. Results are cached in a file
+ *   together with a hash of the geometry setup and of its configuration
+ *   files, so that the validation only runs again when the geometry
+ *   changes.
+ *
  * History:
  *
  */
@@ -31,6 +40,12 @@
 #ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_GEOMETRY_REPORT_DRIVER_H
 #define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_GEOMETRY_REPORT_DRIVER_H 1
 
+// Standard library
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+
 // Third party:
 // - Bayeux/datatools
 #include <bayeux/datatools/logger.h>
@@ -100,6 +115,18 @@ namespace snemo {
       /// Main driver method
       void process();
 
+      /// Return the hash of the geometry setup and configuration files
+      uint64_t compute_geometry_hash() const;
+
+      /// Validate the geometry mapping, using the cache if it is up to date
+      void validate();
+
+      /// Return the number of problems found in the mapping
+      uint64_t get_number_of_issues() const;
+
+      /// Main report method
+      void report(std::ostream & out_);
+
       /// OCD support:
       static void init_ocd(datatools::object_configuration_description & ocd_);
 
@@ -113,12 +140,32 @@ namespace snemo {
       /// Measure particle charge:
       void _print_geometry_report_() const;
 
+      /// Check the mapping in parallel
+      void _validate_mapping_();
+
+      /// Load results from the cache file, return false if it is not up to date
+      bool _load_cache_(const uint64_t hash_);
+
+      /// Store results in the cache file
+      void _store_cache_(const uint64_t hash_) const;
+
     private:
 
       bool _initialized_;                             //<! Initialize flag
       datatools::logger::priority _logging_priority_; //<! Logging flag
       const geomtools::manager * _geometry_manager_;        //!< The geometry manager
       uint32_t _print_report_;                        //!< Print report format
+      bool _validate_;                                //!< Validate the mapping
+      unsigned int _validation_threads_;              //!< Number of validation threads (0: hardware)
+      std::string _validation_cache_;                 //!< Validation cache file
+      std::vector<std::string> _hash_files_;          //!< Geometry configuration files to hash
+      size_t _max_listed_;                            //!< Maximum number of listed issues
+      bool _validated_;                               //!< Validation results are available
+      bool _from_cache_;                              //!< Results were read from the cache
+      std::vector<std::string> _categories_;          //!< Inventory: category names
+      std::vector<int> _volumes_;                     //!< Inventory: number of mapped volumes per category
+      std::vector<std::string> _issues_;              //!< Listed issues
+      uint64_t _number_of_issues_;                    //!< Number of issues
     };
 
   }  // end of namespace processing
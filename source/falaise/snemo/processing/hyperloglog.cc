@@ -0,0 +1,128 @@
+/// \file falaise/snemo/processing/hyperloglog.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/hyperloglog.h>
+
+// Standard library:
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    hyperloglog::hyperloglog(const unsigned int precision_)
+    {
+      set_precision(precision_);
+      return;
+    }
+
+    void hyperloglog::set_precision(const unsigned int precision_)
+    {
+      DT_THROW_IF(precision_ < MIN_PRECISION || precision_ > MAX_PRECISION, std::domain_error,
+                  "Invalid HyperLogLog precision " << precision_ << " !");
+      _precision_ = precision_;
+      _registers_.assign((size_t) 1 << _precision_, 0);
+      return;
+    }
+
+    unsigned int hyperloglog::get_precision() const
+    {
+      return _precision_;
+    }
+
+    void hyperloglog::clear()
+    {
+      std::fill(_registers_.begin(), _registers_.end(), 0);
+      return;
+    }
+
+    uint64_t hyperloglog::hash(uint64_t key_)
+    {
+      key_ += 0x9e3779b97f4a7c15ULL;
+      key_ = (key_ ^ (key_ >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      key_ = (key_ ^ (key_ >> 27)) * 0x94d049bb133111ebULL;
+      return key_ ^ (key_ >> 31);
+    }
+
+    void hyperloglog::add(const uint64_t key_)
+    {
+      const uint64_t h = hash(key_);
+      const size_t index = h >> (64 - _precision_);
+      // Rank of the first set bit in the remaining bits, a sentinel bit
+      // bounding it to 64 - p + 1
+      const uint64_t w = (h << _precision_) | ((uint64_t) 1 << (_precision_ - 1));
+      const uint8_t rank = (uint8_t) (__builtin_clzll(w) + 1);
+      if (rank > _registers_[index]) _registers_[index] = rank;
+      return;
+    }
+
+    void hyperloglog::merge(const hyperloglog & other_)
+    {
+      DT_THROW_IF(other_._precision_ != _precision_, std::logic_error,
+                  "Cannot merge HyperLogLog estimators of different precisions !");
+      for (size_t i = 0; i < _registers_.size(); i++) {
+        if (other_._registers_[i] > _registers_[i]) _registers_[i] = other_._registers_[i];
+      }
+      return;
+    }
+
+    double hyperloglog::estimate() const
+    {
+      const double m = (double) _registers_.size();
+      double alpha = 0.7213 / (1.0 + 1.079 / m);
+      if (_registers_.size() == 16) alpha = 0.673;
+      else if (_registers_.size() == 32) alpha = 0.697;
+      else if (_registers_.size() == 64) alpha = 0.709;
+
+      double sum = 0.0;
+      size_t zeros = 0;
+      for (size_t i = 0; i < _registers_.size(); i++) {
+        sum += std::ldexp(1.0, -(int) _registers_[i]);
+        if (_registers_[i] == 0) zeros++;
+      }
+      const double raw = alpha * m * m / sum;
+      // Small range correction: linear counting of empty registers
+      if (raw <= 2.5 * m && zeros > 0) {
+        return m * std::log(m / zeros);
+      }
+      // No large range correction needed with 64 bits hashes
+      return raw;
+    }
+
+    double hyperloglog::get_relative_error() const
+    {
+      return 1.04 / std::sqrt((double) _registers_.size());
+    }
+
+    size_t hyperloglog::get_memory_size() const
+    {
+      return _registers_.size() * sizeof(uint8_t);
+    }
+
+    const std::vector<uint8_t> & hyperloglog::get_registers() const
+    {
+      return _registers_;
+    }
+
+    void hyperloglog::set_registers(const std::vector<uint8_t> & registers_)
+    {
+      unsigned int precision = 0;
+      while (((size_t) 1 << precision) < registers_.size()) precision++;
+      DT_THROW_IF(((size_t) 1 << precision) != registers_.size(), std::logic_error,
+                  "Invalid number of HyperLogLog registers " << registers_.size() << " !");
+      set_precision(precision);
+      _registers_ = registers_;
+      return;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/hyperloglog.cc
@@ -0,0 +1,107 @@
+/// \file falaise/snemo/processing/hyperloglog.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   HyperLogLog estimator of the number of distinct 64 bits keys. With a
+ *   precision p, 2^p one byte registers are used whatever the number of
+ *   keys, for a relative standard error of 1.04/sqrt(2^p) (16 KiB and
+ *   0.8% for the default p = 14).
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_HYPERLOGLOG_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_HYPERLOGLOG_H 1
+
+// Standard library
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief HyperLogLog distinct counter
+    class hyperloglog
+    {
+    public:
+
+      /// Minimal precision
+      static const unsigned int MIN_PRECISION = 4;
+
+      /// Maximal precision
+      static const unsigned int MAX_PRECISION = 18;
+
+      /// Constructor
+      hyperloglog(const unsigned int precision_ = 14);
+
+      /// Change the precision, clearing the registers
+      void set_precision(const unsigned int precision_);
+
+      /// Return the precision
+      unsigned int get_precision() const;
+
+      /// Clear the registers
+      void clear();
+
+      /// Add a key
+      void add(const uint64_t key_);
+
+      /// Merge another estimator of the same precision
+      void merge(const hyperloglog & other_);
+
+      /// Return the estimated number of distinct keys
+      double estimate() const;
+
+      /// Return the relative standard error of the estimate
+      double get_relative_error() const;
+
+      /// Return the memory used by the registers in bytes
+      size_t get_memory_size() const;
+
+      /// Return the registers
+      const std::vector<uint8_t> & get_registers() const;
+
+      /// Set the registers, their number fixing the precision
+      void set_registers(const std::vector<uint8_t> & registers_);
+
+      /// 64 bits mixing function (splitmix64 finalizer)
+      static uint64_t hash(uint64_t key_);
+
+    private:
+
+      unsigned int _precision_;        //!< Number of index bits
+      std::vector<uint8_t> _registers_; //!< Maximal rank per register
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_HYPERLOGLOG_H
+
+// end of falaise/snemo/processing/hyperloglog.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
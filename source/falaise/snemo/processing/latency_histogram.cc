@@ -0,0 +1,160 @@
+/// \file falaise/snemo/processing/latency_histogram.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/latency_histogram.h>
+
+// Standard library:
+#include <cmath>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+      // Lower edge of the first regular bin in nanoseconds (log10)
+      const double log10_min_ns = 2.0;
+    }
+
+    latency_histogram::latency_histogram()
+    {
+      clear();
+      return;
+    }
+
+    void latency_histogram::clear()
+    {
+      _counts_.assign(NUMBER_OF_BINS, 0.0);
+      _sums_.assign(NUMBER_OF_BINS, 0.0);
+      _count_ = 0.0;
+      _sum_   = 0.0;
+      return;
+    }
+
+    // static
+    size_t latency_histogram::get_bin(const double latency_ns_)
+    {
+      if (! (latency_ns_ >= 1e2)) return 0;
+      const double x = (std::log10(latency_ns_) - log10_min_ns) * BINS_PER_DECADE;
+      const size_t bin = (size_t) x + 1;
+      return bin < NUMBER_OF_BINS - 1 ? bin : NUMBER_OF_BINS - 1;
+    }
+
+    // static
+    double latency_histogram::get_bin_low_edge(const size_t bin_)
+    {
+      if (bin_ == 0) return 0.0;
+      return std::pow(10.0, log10_min_ns + (double) (bin_ - 1) / BINS_PER_DECADE);
+    }
+
+    void latency_histogram::fill(const double latency_ns_)
+    {
+      const size_t bin = get_bin(latency_ns_);
+      _counts_[bin] += 1.0;
+      _sums_[bin]   += latency_ns_;
+      _count_ += 1.0;
+      _sum_   += latency_ns_;
+      return;
+    }
+
+    void latency_histogram::merge(const latency_histogram & other_)
+    {
+      for (size_t i = 0; i < NUMBER_OF_BINS; i++) {
+        _counts_[i] += other_._counts_[i];
+        _sums_[i]   += other_._sums_[i];
+      }
+      _count_ += other_._count_;
+      _sum_   += other_._sum_;
+      return;
+    }
+
+    uint64_t latency_histogram::get_count() const
+    {
+      return (uint64_t) _count_;
+    }
+
+    double latency_histogram::get_sum() const
+    {
+      return _sum_;
+    }
+
+    double latency_histogram::get_mean() const
+    {
+      return _count_ > 0.0 ? _sum_ / _count_ : 0.0;
+    }
+
+    double latency_histogram::get_quantile(const double q_) const
+    {
+      if (_count_ <= 0.0) return 0.0;
+      const double target = q_ * _count_;
+      double cumulative = 0.0;
+      for (size_t i = 0; i < NUMBER_OF_BINS; i++) {
+        const double n = _counts_[i];
+        if (n <= 0.0) continue;
+        if (cumulative + n >= target) {
+          // Overflow has no upper edge: use the bin mean
+          if (i == NUMBER_OF_BINS - 1) return _sums_[i] / n;
+          const double f = (target - cumulative) / n;
+          const double low  = get_bin_low_edge(i);
+          const double high = get_bin_low_edge(i + 1);
+          if (i == 0) return low + f * (high - low);
+          return low * std::pow(high / low, f);
+        }
+        cumulative += n;
+      }
+      return get_bin_low_edge(NUMBER_OF_BINS - 1);
+    }
+
+    const std::vector<double> & latency_histogram::get_counts() const
+    {
+      return _counts_;
+    }
+
+    const std::vector<double> & latency_histogram::get_sums() const
+    {
+      return _sums_;
+    }
+
+    void latency_histogram::set_contents(const std::vector<double> & counts_, const std::vector<double> & sums_)
+    {
+      DT_THROW_IF(counts_.size() != NUMBER_OF_BINS || sums_.size() != NUMBER_OF_BINS,
+                  std::logic_error, "Invalid number of latency histogram bins !");
+      _counts_ = counts_;
+      _sums_   = sums_;
+      _count_ = 0.0;
+      _sum_   = 0.0;
+      for (size_t i = 0; i < NUMBER_OF_BINS; i++) {
+        _count_ += _counts_[i];
+        _sum_   += _sums_[i];
+      }
+      return;
+    }
+
+    void latency_histogram::export_to(datatools::properties & config_, const std::string & prefix_) const
+    {
+      config_.store(prefix_ + "counts", _counts_);
+      config_.store(prefix_ + "sums", _sums_);
+      return;
+    }
+
+    void latency_histogram::import_from(const datatools::properties & config_, const std::string & prefix_)
+    {
+      DT_THROW_IF(! config_.has_key(prefix_ + "counts") || ! config_.has_key(prefix_ + "sums"),
+                  std::logic_error, "Missing '" << prefix_ << "' latency histogram !");
+      std::vector<double> counts, sums;
+      config_.fetch(prefix_ + "counts", counts);
+      config_.fetch(prefix_ + "sums", sums);
+      set_contents(counts, sums);
+      return;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/latency_histogram.cc
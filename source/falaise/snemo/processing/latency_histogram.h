@@ -0,0 +1,125 @@
+/// \file falaise/snemo/processing/latency_histogram.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   A fixed size histogram of latencies with logarithmic bins from 100 ns to
+ *   100 s (20 bins per decade) plus underflow and overflow bins. Each bin
+ *   keeps the number and the sum of its entries so that the mean is exact
+ *   and quantiles are interpolated within a bin.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_LATENCY_HISTOGRAM_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_LATENCY_HISTOGRAM_H 1
+
+// Standard library
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace datatools {
+  class properties;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Logarithmic histogram of latencies
+    class latency_histogram
+    {
+    public:
+
+      /// Number of bins per decade
+      static const size_t BINS_PER_DECADE = 20;
+
+      /// Number of decades (from 1e2 ns to 1e11 ns)
+      static const size_t NUMBER_OF_DECADES = 9;
+
+      /// Total number of bins including underflow and overflow
+      static const size_t NUMBER_OF_BINS = BINS_PER_DECADE * NUMBER_OF_DECADES + 2;
+
+      /// Constructor
+      latency_histogram();
+
+      /// Reset all bins
+      void clear();
+
+      /// Add a latency in nanoseconds
+      void fill(const double latency_ns_);
+
+      /// Add the content of another histogram
+      void merge(const latency_histogram & other_);
+
+      /// Return the number of entries
+      uint64_t get_count() const;
+
+      /// Return the sum of latencies in nanoseconds
+      double get_sum() const;
+
+      /// Return the mean latency in nanoseconds
+      double get_mean() const;
+
+      /// Return the latency quantile in nanoseconds for q in [0,1]
+      double get_quantile(const double q_) const;
+
+      /// Return the bin counts
+      const std::vector<double> & get_counts() const;
+
+      /// Return the bin sums
+      const std::vector<double> & get_sums() const;
+
+      /// Set bin contents
+      void set_contents(const std::vector<double> & counts_, const std::vector<double> & sums_);
+
+      /// Lower edge in nanoseconds of a bin
+      static double get_bin_low_edge(const size_t bin_);
+
+      /// Bin index of a latency
+      static size_t get_bin(const double latency_ns_);
+
+      /// Store the histogram in properties with a key prefix
+      void export_to(datatools::properties & config_, const std::string & prefix_) const;
+
+      /// Load the histogram from properties with a key prefix
+      void import_from(const datatools::properties & config_, const std::string & prefix_);
+
+    private:
+
+      std::vector<double> _counts_; //!< Number of entries per bin
+      std::vector<double> _sums_;   //!< Sum of latencies per bin
+      double _count_;               //!< Total number of entries
+      double _sum_;                 //!< Total sum of latencies
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_LATENCY_HISTOGRAM_H
+
+// end of falaise/snemo/processing/latency_histogram.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,328 @@
+/// \file falaise/snemo/processing/live_publisher.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/live_publisher.h>
+
+// Standard library:
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+
+// This project:
+#include <falaise/snemo/processing/state_io.h>
+
+// System:
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      const uint32_t names_tag = make_state_tag('L', 'I', 'V', 'N');
+      const uint32_t delta_tag = make_state_tag('L', 'I', 'V', 'C');
+
+      /// Section header, job name length, version and three 32-bit words
+      /// (names) or a 64-bit and a 32-bit word (delta)
+      const size_t MESSAGE_HEADER_SIZE = 32;
+
+      /// Index and counters of a cut in a delta
+      const size_t DELTA_ENTRY_SIZE = 4 + 8 * live_publisher::COUNTERS_PER_CUT;
+
+      /// Length, group flag and characters of a cut name
+      size_t names_entry_size(const std::string & name_)
+      {
+        return 8 + name_.size();
+      }
+
+    }
+
+    // static
+    void live_publisher::encode_names(const names_type & names_, std::string & message_)
+    {
+      state_writer writer;
+      writer.grab_data().swap(message_);
+      writer.grab_data().clear();
+      const size_t section = writer.begin_section(names_tag);
+      writer.write_string(names_.job);
+      writer.write_uint32(names_.version);
+      writer.write_uint32(names_.ncuts);
+      writer.write_uint32(names_.first);
+      writer.write_uint32(names_.names.size());
+      for (size_t i = 0; i < names_.names.size(); i++) {
+        writer.write_string(names_.names[i]);
+        writer.write_uint32(names_.group_start[i] ? 1 : 0);
+      }
+      writer.end_section(section);
+      writer.grab_data().swap(message_);
+      return;
+    }
+
+    // static
+    void live_publisher::encode_delta(const delta_type & delta_, std::string & message_)
+    {
+      state_writer writer;
+      writer.grab_data().swap(message_);
+      writer.grab_data().clear();
+      const size_t section = writer.begin_section(delta_tag);
+      writer.write_string(delta_.job);
+      writer.write_uint32(delta_.version);
+      writer.write_uint64(delta_.events);
+      writer.write_uint32(delta_.indexes.size());
+      for (size_t i = 0; i < delta_.indexes.size(); i++) {
+        writer.write_uint32(delta_.indexes[i]);
+        for (size_t j = 0; j < COUNTERS_PER_CUT; j++) {
+          writer.write_uint64(delta_.counters[i * COUNTERS_PER_CUT + j]);
+        }
+      }
+      writer.end_section(section);
+      writer.grab_data().swap(message_);
+      return;
+    }
+
+    // static
+    live_publisher::message_type live_publisher::decode(const char * message_, const size_t size_,
+                                                        names_type & names_, delta_type & delta_)
+    {
+      try {
+        state_reader reader(message_, size_);
+        uint32_t tag = 0;
+        state_reader section = reader.read_section(tag);
+        if (tag == names_tag) {
+          names_.job     = section.read_string();
+          names_.version = section.read_uint32();
+          names_.ncuts   = section.read_uint32();
+          names_.first   = section.read_uint32();
+          const uint32_t count = section.read_uint32();
+          if (count > size_ || (uint64_t) names_.first + count > names_.ncuts) return MESSAGE_INVALID;
+          names_.names.resize(count);
+          names_.group_start.resize(count);
+          for (size_t i = 0; i < count; i++) {
+            names_.names[i]       = section.read_string();
+            names_.group_start[i] = (section.read_uint32() != 0);
+          }
+          return MESSAGE_NAMES;
+        }
+        if (tag == delta_tag) {
+          delta_.job     = section.read_string();
+          delta_.version = section.read_uint32();
+          delta_.events  = section.read_uint64();
+          const uint32_t count = section.read_uint32();
+          if (count > size_) return MESSAGE_INVALID;
+          delta_.indexes.resize(count);
+          delta_.counters.resize(count * COUNTERS_PER_CUT);
+          for (size_t i = 0; i < count; i++) {
+            delta_.indexes[i] = section.read_uint32();
+            for (size_t j = 0; j < COUNTERS_PER_CUT; j++) {
+              delta_.counters[i * COUNTERS_PER_CUT + j] = section.read_uint64();
+            }
+          }
+          return MESSAGE_COUNTERS;
+        }
+      } catch (std::exception &) {
+        return MESSAGE_INVALID;
+      }
+      return MESSAGE_INVALID;
+    }
+
+    live_publisher::live_publisher()
+      : _fd_(-1), _version_(0), _names_pending_(true), _names_next_(0),
+        _sent_events_(0), _sent_(0), _dropped_(0), _errors_(0)
+    {
+      return;
+    }
+
+    live_publisher::~live_publisher()
+    {
+      close();
+      return;
+    }
+
+    void live_publisher::open(const std::string & socket_path_)
+    {
+      DT_THROW_IF(is_open(), std::logic_error, "Live publisher is already open !");
+      sockaddr_un address;
+      DT_THROW_IF(socket_path_.size() >= sizeof(address.sun_path), std::domain_error,
+                  "Socket path '" << socket_path_ << "' is too long !");
+      _fd_ = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+      DT_THROW_IF(_fd_ < 0, std::runtime_error,
+                  "Cannot create socket : " << std::strerror(errno) << " !");
+      ::fcntl(_fd_, F_SETFL, ::fcntl(_fd_, F_GETFL) | O_NONBLOCK);
+      _socket_path_ = socket_path_;
+
+      char hostname[256];
+      if (::gethostname(hostname, sizeof(hostname)) != 0) std::strcpy(hostname, "localhost");
+      hostname[sizeof(hostname) - 1] = '\0';
+      std::ostringstream job;
+      job << hostname << ":" << ::getpid();
+      _job_ = job.str();
+      _names_part_.job = _job_;
+      _delta_.job      = _job_;
+      return;
+    }
+
+    bool live_publisher::is_open() const
+    {
+      return _fd_ >= 0;
+    }
+
+    void live_publisher::close()
+    {
+      if (_fd_ >= 0) ::close(_fd_);
+      _fd_ = -1;
+      return;
+    }
+
+    const std::string & live_publisher::get_job() const
+    {
+      return _job_;
+    }
+
+    void live_publisher::set_cuts(const std::vector<std::string> & names_,
+                                  const std::vector<char> & group_start_)
+    {
+      DT_THROW_IF(names_.size() != group_start_.size(), std::logic_error,
+                  "Inconsistent cut names and group flags !");
+      for (size_t i = 0; i < names_.size(); i++) {
+        DT_THROW_IF(MESSAGE_HEADER_SIZE + _job_.size() + names_entry_size(names_[i]) > MAX_MESSAGE_SIZE,
+                    std::domain_error, "Cut name '" << names_[i] << "' is too long for a live message !");
+      }
+      _names_       = names_;
+      _group_start_ = group_start_;
+      _version_++;
+      _names_pending_ = true;
+      _names_next_    = 0;
+      _sent_counters_.assign(names_.size() * COUNTERS_PER_CUT, 0);
+      return;
+    }
+
+    bool live_publisher::_send_()
+    {
+      sockaddr_un address;
+      std::memset(&address, 0, sizeof(address));
+      address.sun_family = AF_UNIX;
+      std::strncpy(address.sun_path, _socket_path_.c_str(), sizeof(address.sun_path) - 1);
+      const ssize_t sent = ::sendto(_fd_, _message_.data(), _message_.size(), MSG_DONTWAIT,
+                                    reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+      if (sent == (ssize_t) _message_.size()) return true;
+      const int error = (sent < 0 ? errno : EMSGSIZE);
+      if (error == ECONNREFUSED || error == ENOENT) {
+        // No collector: the next one to listen does not know the cuts
+        _dropped_++;
+        _names_pending_ = true;
+        _names_next_    = 0;
+      } else if (error == EAGAIN || error == EWOULDBLOCK) {
+        // Full socket buffer: the same collector gets the rest later
+        _dropped_++;
+      } else {
+        _errors_++;
+        _last_error_ = std::strerror(error);
+      }
+      return false;
+    }
+
+    bool live_publisher::_send_names_()
+    {
+      _names_part_.version = _version_;
+      _names_part_.ncuts   = _names_.size();
+      size_t cut = _names_next_;
+      do {
+        _names_part_.first = cut;
+        _names_part_.names.clear();
+        _names_part_.group_start.clear();
+        size_t size = MESSAGE_HEADER_SIZE + _job_.size();
+        for (; cut < _names_.size() && size + names_entry_size(_names_[cut]) <= MAX_MESSAGE_SIZE; cut++) {
+          _names_part_.names.push_back(_names_[cut]);
+          _names_part_.group_start.push_back(_group_start_[cut]);
+          size += names_entry_size(_names_[cut]);
+        }
+        encode_names(_names_part_, _message_);
+        if (! _send_()) return false;
+        _names_next_ = cut;
+      } while (cut < _names_.size());
+      _names_pending_ = false;
+      _names_next_    = 0;
+      return true;
+    }
+
+    bool live_publisher::publish(const uint64_t events_, const std::vector<uint64_t> & counters_)
+    {
+      DT_THROW_IF(! is_open(), std::logic_error, "Live publisher is not open !");
+      DT_THROW_IF(counters_.size() != _sent_counters_.size(), std::logic_error,
+                  "Unexpected number of cut counters !");
+      if (_names_pending_ && ! _send_names_()) return false;
+
+      // Only the changed cuts are sent, the events go with the first message
+      const size_t ncuts = counters_.size() / COUNTERS_PER_CUT;
+      _delta_.version = _version_;
+      size_t cut = 0;
+      bool first = true;
+      while (first || cut < ncuts) {
+        _delta_.events = (first ? events_ - _sent_events_ : 0);
+        _delta_.indexes.clear();
+        _delta_.counters.clear();
+        const size_t begin = cut;
+        size_t size = MESSAGE_HEADER_SIZE + _job_.size();
+        for (; cut < ncuts && size + DELTA_ENTRY_SIZE <= MAX_MESSAGE_SIZE; cut++) {
+          const size_t offset = cut * COUNTERS_PER_CUT;
+          bool changed = false;
+          for (size_t j = 0; j < COUNTERS_PER_CUT; j++) {
+            if (counters_[offset + j] != _sent_counters_[offset + j]) changed = true;
+          }
+          if (! changed) continue;
+          _delta_.indexes.push_back(cut);
+          for (size_t j = 0; j < COUNTERS_PER_CUT; j++) {
+            _delta_.counters.push_back(counters_[offset + j] - _sent_counters_[offset + j]);
+          }
+          size += DELTA_ENTRY_SIZE;
+        }
+        if (! first && _delta_.indexes.empty()) break;
+        encode_delta(_delta_, _message_);
+        if (! _send_()) return false;
+        // Delivered parts are not sent again
+        if (first) _sent_events_ = events_;
+        std::copy(counters_.begin() + begin * COUNTERS_PER_CUT, counters_.begin() + cut * COUNTERS_PER_CUT,
+                  _sent_counters_.begin() + begin * COUNTERS_PER_CUT);
+        first = false;
+      }
+      _sent_++;
+      // Late collectors learn the cuts from periodic refreshes
+      if (_sent_ % NAMES_REFRESH == 0) _names_pending_ = true;
+      return true;
+    }
+
+    uint64_t live_publisher::get_number_of_sent() const
+    {
+      return _sent_;
+    }
+
+    uint64_t live_publisher::get_number_of_dropped() const
+    {
+      return _dropped_;
+    }
+
+    uint64_t live_publisher::get_number_of_errors() const
+    {
+      return _errors_;
+    }
+
+    const std::string & live_publisher::get_last_error() const
+    {
+      return _last_error_;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/live_publisher.cc
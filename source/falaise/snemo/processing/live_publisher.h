@@ -0,0 +1,186 @@
+/// \file falaise/snemo/processing/live_publisher.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Push of the report counters to a live collector process (see the
+ *   flprocessreport-collector program) over a local Unix datagram socket.
+ *
+ *   The cut names table of a job is sent once, again when it changes
+ *   (new version) or after the collector was found absent, since it may
+ *   have been restarted, and periodically for a collector started while the
+ *   job runs. Other messages only hold the indexes of the cuts whose
+ *   counters changed and the difference of their counters with the last
+ *   delivered values, so that the collector only has to add them. Tables
+ *   and differences larger than MAX_MESSAGE_SIZE are split over several
+ *   messages.
+ *
+ *   Sending never blocks: when the collector is absent or its socket
+ *   buffer is full, the message is dropped and the undelivered difference
+ *   stays in the local totals, to be delivered with the next message.
+ *   Other send failures are counted as errors.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_LIVE_PUBLISHER_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_LIVE_PUBLISHER_H 1
+
+// Standard library
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Live counters publisher
+    class live_publisher
+    {
+    public:
+
+      /// Counters per cut in a delta (processed, accepted, rejected)
+      static const size_t COUNTERS_PER_CUT = 3;
+
+      /// Maximal size of a message, larger tables and deltas are split
+      static const size_t MAX_MESSAGE_SIZE = 65536;
+
+      /// Number of delivered pushes between two sends of the cut names table
+      static const uint64_t NAMES_REFRESH = 100;
+
+      /// Message type
+      enum message_type {
+        MESSAGE_INVALID  = 0,
+        MESSAGE_NAMES    = 1,
+        MESSAGE_COUNTERS = 2
+      };
+
+      /// Part of the cut names table of a job
+      struct names_type
+      {
+        std::string job;                 //!< Job identifier
+        uint32_t version;                //!< Version of the table
+        uint32_t ncuts;                  //!< Number of cuts in the whole table
+        uint32_t first;                  //!< Index of the first cut of this part
+        std::vector<std::string> names;  //!< Cut names
+        std::vector<char> group_start;   //!< Cuts starting a serie
+      };
+
+      /// Counters difference of the changed cuts of a job
+      struct delta_type
+      {
+        std::string job;                 //!< Job identifier
+        uint32_t version;                //!< Version of the cut names table
+        uint64_t events;                 //!< Number of events
+        std::vector<uint32_t> indexes;   //!< Indexes of the cuts in the table
+        std::vector<uint64_t> counters;  //!< Cut counters, COUNTERS_PER_CUT per index
+      };
+
+      /// Encode a part of the cut names table as a message
+      static void encode_names(const names_type & names_, std::string & message_);
+
+      /// Encode a delta as a message
+      static void encode_delta(const delta_type & delta_, std::string & message_);
+
+      /// Decode a message in the structure of its type, return MESSAGE_INVALID
+      /// if it is not valid
+      static message_type decode(const char * message_, const size_t size_,
+                                 names_type & names_, delta_type & delta_);
+
+      /// Constructor
+      live_publisher();
+
+      /// Destructor
+      ~live_publisher();
+
+      /// Connect to the collector socket
+      void open(const std::string & socket_path_);
+
+      /// Check if the publisher is open
+      bool is_open() const;
+
+      /// Close the socket
+      void close();
+
+      /// Return the job identifier
+      const std::string & get_job() const;
+
+      /// Set the cuts followed by the publisher, a new version of the table
+      void set_cuts(const std::vector<std::string> & names_, const std::vector<char> & group_start_);
+
+      /// Try to deliver the difference between the current totals and the
+      /// last delivered ones, return true if all its messages were sent
+      bool publish(const uint64_t events_, const std::vector<uint64_t> & counters_);
+
+      /// Return the number of delivered pushes
+      uint64_t get_number_of_sent() const;
+
+      /// Return the number of pushes not delivered because the collector
+      /// is absent or busy
+      uint64_t get_number_of_dropped() const;
+
+      /// Return the number of pushes not delivered because of other errors
+      uint64_t get_number_of_errors() const;
+
+      /// Return the description of the last error
+      const std::string & get_last_error() const;
+
+    private:
+
+      /// Send the cut names table, return false if a part is not delivered
+      bool _send_names_();
+
+      /// Send the current message, return false if it is not delivered
+      bool _send_();
+
+    private:
+
+      int _fd_;                            //!< Socket descriptor
+      std::string _socket_path_;           //!< Collector socket path
+      std::string _job_;                   //!< Job identifier
+      uint32_t _version_;                  //!< Version of the cut names table
+      std::vector<std::string> _names_;    //!< Cut names
+      std::vector<char> _group_start_;     //!< Cuts starting a serie
+      bool _names_pending_;                //!< The cut names table must be sent
+      size_t _names_next_;                 //!< First cut of the next part of the table to send
+      names_type _names_part_;             //!< Reused part of the names table
+      delta_type _delta_;                  //!< Reused delta
+      std::string _message_;               //!< Reused message buffer
+      uint64_t _sent_events_;              //!< Delivered number of events
+      std::vector<uint64_t> _sent_counters_; //!< Delivered cut counters
+      uint64_t _sent_;                     //!< Number of delivered pushes
+      uint64_t _dropped_;                  //!< Number of pushes dropped for an absent or busy collector
+      uint64_t _errors_;                   //!< Number of pushes failed on other errors
+      std::string _last_error_;            //!< Description of the last error
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_LIVE_PUBLISHER_H
+
+// end of falaise/snemo/processing/live_publisher.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,204 @@
+/// \file falaise/snemo/processing/mapped_report_file.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/mapped_report_file.h>
+
+// Standard library:
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+
+// System:
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+      const char MAGIC[8] = {'F', 'L', 'P', 'R', 'M', 'A', 'P', '1'};
+      const uint32_t VERSION = 1;
+    }
+
+    mapped_report_file::mapped_report_file()
+      : _fd_(-1), _segment_size_(0), _mapping_(0), _capacity_(0), _committed_(0)
+    {
+      return;
+    }
+
+    mapped_report_file::~mapped_report_file()
+    {
+      if (is_open()) close();
+      return;
+    }
+
+    bool mapped_report_file::is_open() const
+    {
+      return _fd_ >= 0;
+    }
+
+    void mapped_report_file::open(const std::string & filename_, const size_t segment_size_)
+    {
+      DT_THROW_IF(is_open(), std::logic_error, "Mapped report file is already open !");
+      DT_THROW_IF(segment_size_ == 0, std::domain_error, "Invalid null segment size !");
+      const long page = sysconf(_SC_PAGESIZE);
+      // Segments are whole pages so that the data end stays page aligned
+      _segment_size_ = (segment_size_ + page - 1) / page * page;
+      _fd_ = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      DT_THROW_IF(_fd_ < 0, std::runtime_error,
+                  "Cannot create file '" << filename_ << "' : " << std::strerror(errno) << " !");
+      _filename_  = filename_;
+      _committed_ = 0;
+      _map_(_segment_size_);
+      header_type * header = reinterpret_cast<header_type *>(_mapping_);
+      std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+      header->header_size = HEADER_SIZE;
+      header->version     = VERSION;
+      header->capacity    = _capacity_;
+      _publish_();
+      _reset_put_area_();
+      return;
+    }
+
+    void mapped_report_file::_map_(const uint64_t capacity_)
+    {
+      if (_mapping_ != 0) {
+        ::munmap(_mapping_, HEADER_SIZE + _capacity_);
+        _mapping_ = 0;
+      }
+      const off_t size = HEADER_SIZE + capacity_;
+      // Allocate the blocks now so that a full disk is reported here rather
+      // than as a bus error when writing in the mapping
+      int error = ::posix_fallocate(_fd_, 0, size);
+      if (error != 0) {
+        DT_THROW_IF(error != EOPNOTSUPP && error != EINVAL, std::runtime_error,
+                    "Cannot allocate " << size << " bytes for '" << _filename_ << "' : "
+                    << std::strerror(error) << " !");
+        DT_THROW_IF(::ftruncate(_fd_, size) != 0, std::runtime_error,
+                    "Cannot resize '" << _filename_ << "' : " << std::strerror(errno) << " !");
+      }
+      void * mapping = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd_, 0);
+      DT_THROW_IF(mapping == MAP_FAILED, std::runtime_error,
+                  "Cannot map '" << _filename_ << "' : " << std::strerror(errno) << " !");
+      _mapping_  = static_cast<char *>(mapping);
+      _capacity_ = capacity_;
+      reinterpret_cast<header_type *>(_mapping_)->capacity = _capacity_;
+      return;
+    }
+
+    void mapped_report_file::_publish_()
+    {
+      header_type * header = reinterpret_cast<header_type *>(_mapping_);
+      __atomic_store_n(&header->committed, _committed_, __ATOMIC_RELEASE);
+      return;
+    }
+
+    void mapped_report_file::_reset_put_area_()
+    {
+      char * begin = _mapping_ + HEADER_SIZE + _committed_;
+      setp(begin, _mapping_ + HEADER_SIZE + _capacity_);
+      return;
+    }
+
+    void mapped_report_file::_ensure_(const size_t n_)
+    {
+      if (_committed_ + n_ <= _capacity_) return;
+      const uint64_t needed = _committed_ + n_ - _capacity_;
+      const uint64_t nsegments = (needed + _segment_size_ - 1) / _segment_size_;
+      _map_(_capacity_ + nsegments * _segment_size_);
+      return;
+    }
+
+    char * mapped_report_file::reserve(const size_t n_)
+    {
+      DT_THROW_IF(! is_open(), std::logic_error, "Mapped report file is not open !");
+      sync();
+      _ensure_(n_);
+      _reset_put_area_();
+      return _mapping_ + HEADER_SIZE + _committed_;
+    }
+
+    void mapped_report_file::commit(const size_t n_)
+    {
+      DT_THROW_IF(_committed_ + n_ > _capacity_, std::logic_error,
+                  "Cannot commit more than the reserved room !");
+      _committed_ += n_;
+      _publish_();
+      _reset_put_area_();
+      return;
+    }
+
+    uint64_t mapped_report_file::get_committed_size() const
+    {
+      return _committed_;
+    }
+
+    int mapped_report_file::sync()
+    {
+      if (_mapping_ == 0) return 0;
+      const size_t pending = pptr() - pbase();
+      if (pending > 0) {
+        _committed_ += pending;
+        _publish_();
+        _reset_put_area_();
+      }
+      return 0;
+    }
+
+    mapped_report_file::int_type mapped_report_file::overflow(int_type c_)
+    {
+      if (! is_open()) return traits_type::eof();
+      sync();
+      if (traits_type::eq_int_type(c_, traits_type::eof())) return traits_type::not_eof(c_);
+      _ensure_(1);
+      _reset_put_area_();
+      *pptr() = traits_type::to_char_type(c_);
+      pbump(1);
+      return c_;
+    }
+
+    void mapped_report_file::close()
+    {
+      if (! is_open()) return;
+      sync();
+      setp(0, 0);
+      ::msync(_mapping_, HEADER_SIZE + _capacity_, MS_SYNC);
+      ::munmap(_mapping_, HEADER_SIZE + _capacity_);
+      _mapping_ = 0;
+      // Drop the unused preallocated space
+      if (::ftruncate(_fd_, HEADER_SIZE + _committed_) != 0) {
+        DT_LOG_WARNING(datatools::logger::PRIO_WARNING, "Cannot trim '" << _filename_ << "' !");
+      }
+      ::close(_fd_);
+      _fd_ = -1;
+      _capacity_ = 0;
+      return;
+    }
+
+    // static
+    bool mapped_report_file::read(const std::string & filename_, std::string & data_)
+    {
+      std::ifstream file(filename_.c_str(), std::ios::binary);
+      if (! file) return false;
+      header_type header;
+      if (! file.read(reinterpret_cast<char *>(&header), sizeof(header))) return false;
+      if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+      file.seekg(header.header_size);
+      data_.resize(header.committed);
+      if (header.committed > 0 && ! file.read(&data_[0], header.committed)) return false;
+      return true;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/mapped_report_file.cc
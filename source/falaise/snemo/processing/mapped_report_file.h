@@ -0,0 +1,139 @@
+/// \file falaise/snemo/processing/mapped_report_file.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Report file written through a shared memory mapping. The file starts
+ *   with a one page header holding a magic word and the committed length
+ *   of the data, which is published with release semantics once data is
+ *   written: other processes can map or read the file while the job runs
+ *   and trust the data up to this length. The file grows by fixed-size
+ *   preallocated segments.
+ *
+ *   Binary producers, like the snapshot log of the process report module,
+ *   reserve room and encode their records directly into the mapping; text
+ *   written through the streambuf interface is formatted directly in the
+ *   mapping too and committed on stream flush. Pointers returned by
+ *   'reserve' are only valid until the next call, which may remap the file.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_MAPPED_REPORT_FILE_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_MAPPED_REPORT_FILE_H 1
+
+// Standard library
+#include <string>
+#include <streambuf>
+#include <stdint.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Memory-mapped report file
+    class mapped_report_file : public std::streambuf
+    {
+    public:
+
+      /// Header layout at the start of the file
+      struct header_type
+      {
+        char magic[8];          //!< "FLPRMAP1"
+        uint32_t header_size;   //!< Offset of the data
+        uint32_t version;       //!< Format version
+        uint64_t committed;     //!< Number of committed data bytes
+        uint64_t capacity;      //!< Number of data bytes allocated in the file
+      };
+
+      /// Size of the header in the file
+      static const size_t HEADER_SIZE = 4096;
+
+      /// Constructor
+      mapped_report_file();
+
+      /// Destructor
+      virtual ~mapped_report_file();
+
+      /// Create the file with a given growth segment size
+      void open(const std::string & filename_, const size_t segment_size_ = 16777216);
+
+      /// Check if the file is open
+      bool is_open() const;
+
+      /// Return room for n bytes at the end of the committed data
+      char * reserve(const size_t n_);
+
+      /// Commit n bytes written after a call to 'reserve'
+      void commit(const size_t n_);
+
+      /// Return the number of committed bytes
+      uint64_t get_committed_size() const;
+
+      /// Commit pending text, trim the file to its committed size and close it
+      void close();
+
+      /// Read the committed data of a report file, return false if it is not valid
+      static bool read(const std::string & filename_, std::string & data_);
+
+    protected:
+
+      /// Grow the file to write one more character
+      virtual int_type overflow(int_type c_);
+
+      /// Commit pending text
+      virtual int sync();
+
+    private:
+
+      /// Make sure n bytes are available after the committed data
+      void _ensure_(const size_t n_);
+
+      /// Map the file with a given data capacity
+      void _map_(const uint64_t capacity_);
+
+      /// Publish the committed length
+      void _publish_();
+
+      /// Point the streambuf put area at the free space
+      void _reset_put_area_();
+
+    private:
+
+      std::string _filename_;    //!< File name
+      int _fd_;                  //!< File descriptor
+      size_t _segment_size_;     //!< Growth segment size
+      char * _mapping_;          //!< Mapping of the whole file
+      uint64_t _capacity_;       //!< Data capacity
+      uint64_t _committed_;      //!< Committed data size
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_MAPPED_REPORT_FILE_H
+
+// end of falaise/snemo/processing/mapped_report_file.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
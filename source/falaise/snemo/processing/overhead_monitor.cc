@@ -0,0 +1,239 @@
+/// \file falaise/snemo/processing/overhead_monitor.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/overhead_monitor.h>
+
+// Standard library:
+#include <chrono>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      int64_t now_ns()
+      {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>
+          (std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+
+    }
+
+    void overhead_monitor::set_initialized(const bool initialized_)
+    {
+      _initialized_ = initialized_;
+      return;
+    }
+
+    bool overhead_monitor::is_initialized() const
+    {
+      return _initialized_;
+    }
+
+    void overhead_monitor::set_logging_priority(const datatools::logger::priority priority_)
+    {
+      _logging_priority_ = priority_;
+      return;
+    }
+
+    datatools::logger::priority overhead_monitor::get_logging_priority() const
+    {
+      return _logging_priority_;
+    }
+
+    bool overhead_monitor::is_adaptive() const
+    {
+      return _budget_ > 0.0;
+    }
+
+    double overhead_monitor::get_budget() const
+    {
+      return _budget_;
+    }
+
+    uint64_t overhead_monitor::get_stride() const
+    {
+      return _stride_;
+    }
+
+    double overhead_monitor::get_overhead() const
+    {
+      return _total_ns_ > 0 ? (double) _self_ns_ / _total_ns_ : 0.0;
+    }
+
+    double overhead_monitor::get_mean_self_cost() const
+    {
+      return _events_ > 0 ? (double) _self_ns_ / _events_ : 0.0;
+    }
+
+    overhead_monitor::overhead_monitor()
+    {
+      _set_defaults();
+      return;
+    }
+
+    overhead_monitor::~overhead_monitor()
+    {
+      if (is_initialized()) {
+        reset();
+      }
+      return;
+    }
+
+    void overhead_monitor::initialize(const datatools::properties & setup_)
+    {
+      DT_THROW_IF(is_initialized(), std::logic_error, "Overhead monitor is already initialized !");
+
+      // Logging priority
+      datatools::logger::priority lp = datatools::logger::extract_logging_configuration(setup_);
+      DT_THROW_IF(lp == datatools::logger::PRIO_UNDEFINED,
+                  std::logic_error,
+                  "Invalid logging priority level for overhead monitor !");
+      set_logging_priority(lp);
+
+      if (setup_.has_key("budget")) {
+        _budget_ = setup_.fetch_real("budget");
+        DT_THROW_IF(_budget_ < 0.0 || _budget_ >= 1.0, std::domain_error,
+                    "Invalid overhead budget " << _budget_ << " !");
+      }
+
+      if (setup_.has_key("window")) {
+        const int window = setup_.fetch_integer("window");
+        DT_THROW_IF(window < 1, std::domain_error, "Invalid overhead window " << window << " !");
+        _window_ = window;
+      }
+
+      if (setup_.has_key("max_stride")) {
+        const int max_stride = setup_.fetch_integer("max_stride");
+        DT_THROW_IF(max_stride < 1, std::domain_error, "Invalid maximal stride " << max_stride << " !");
+        _max_stride_ = max_stride;
+      }
+
+      set_initialized(true);
+      return;
+    }
+
+    void overhead_monitor::reset()
+    {
+      DT_THROW_IF(! is_initialized(), std::logic_error, "Overhead monitor is not initialized !");
+      _set_defaults();
+      return;
+    }
+
+    void overhead_monitor::_set_defaults()
+    {
+      _initialized_      = false;
+      _logging_priority_ = datatools::logger::PRIO_WARNING;
+      _budget_           = 0.0;
+      _window_           = 1000;
+      _max_stride_       = 1024;
+      _stride_           = 1;
+      _since_sample_     = 0;
+      _adaptations_      = 0;
+      _windows_          = 0;
+      _unmet_windows_    = 0;
+      _begin_ns_         = 0;
+      _last_end_ns_      = 0;
+      _events_           = 0;
+      _self_ns_          = 0;
+      _total_ns_         = 0;
+      _window_events_    = 0;
+      _window_self_ns_   = 0;
+      _window_total_ns_  = 0;
+      return;
+    }
+
+    void overhead_monitor::begin()
+    {
+      _begin_ns_ = now_ns();
+      return;
+    }
+
+    uint64_t overhead_monitor::sample()
+    {
+      _since_sample_++;
+      if (_since_sample_ < _stride_) return 0;
+      const uint64_t weight = _since_sample_;
+      _since_sample_ = 0;
+      return weight;
+    }
+
+    void overhead_monitor::end()
+    {
+      const int64_t end_ns = now_ns();
+      const int64_t self_ns = end_ns - _begin_ns_;
+      // The first event has no reference for the event time
+      if (_last_end_ns_ > 0) {
+        const int64_t total_ns = end_ns - _last_end_ns_;
+        _events_++;
+        _self_ns_  += self_ns;
+        _total_ns_ += total_ns;
+        _window_events_++;
+        _window_self_ns_  += self_ns;
+        _window_total_ns_ += total_ns;
+        if (_window_events_ >= _window_) _adapt_();
+      }
+      _last_end_ns_ = end_ns;
+      return;
+    }
+
+    void overhead_monitor::_adapt_()
+    {
+      if (is_adaptive() && _window_total_ns_ > 0) {
+        const double overhead = (double) _window_self_ns_ / _window_total_ns_;
+        _windows_++;
+        // Work done on every event is beyond the reach of the throttle
+        if (overhead > _budget_ && _stride_ == _max_stride_) _unmet_windows_++;
+        if (overhead > _budget_ && _stride_ < _max_stride_) {
+          _stride_ *= 2;
+          if (_stride_ > _max_stride_) _stride_ = _max_stride_;
+          _adaptations_++;
+          DT_LOG_DEBUG(get_logging_priority(), "Overhead " << overhead << " above budget: stride set to " << _stride_);
+        } else if (overhead < 0.25 * _budget_ && _stride_ > 1) {
+          _stride_ /= 2;
+          _adaptations_++;
+          DT_LOG_DEBUG(get_logging_priority(), "Overhead " << overhead << " below budget: stride set to " << _stride_);
+        }
+      }
+      _window_events_   = 0;
+      _window_self_ns_  = 0;
+      _window_total_ns_ = 0;
+      return;
+    }
+
+    void overhead_monitor::report(std::ostream & out_) const
+    {
+      out_ << "Process report self-overhead" << std::endl;
+      const std::ios::fmtflags flags = out_.flags();
+      const std::streamsize precision = out_.precision();
+      out_.setf(std::ios::fixed);
+      out_.precision(3);
+      out_ << " ↳ Timed events        : " << _events_ << std::endl;
+      out_ << " ↳ Self cost per event : " << 1e-3 * get_mean_self_cost() << " µs" << std::endl;
+      out_ << " ↳ Overhead            : " << 100.0 * get_overhead() << " % of event time" << std::endl;
+      if (is_adaptive()) {
+        out_ << " ↳ Overhead budget     : " << 100.0 * _budget_ << " %" << std::endl;
+        out_ << " ↳ Throttle stride     : 1/" << _stride_
+             << " (" << _adaptations_ << " adjustments)" << std::endl;
+        if (_unmet_windows_ > 0) {
+          out_ << " ↳ Budget not honoured : " << _unmet_windows_ << "/" << _windows_
+               << " windows above the budget at the maximal stride, the work needed on every"
+               << " event exceeds the budget" << std::endl;
+        }
+      }
+      out_.flags(flags);
+      out_.precision(precision);
+      return;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/overhead_monitor.cc
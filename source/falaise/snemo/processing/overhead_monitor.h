@@ -0,0 +1,152 @@
+/// \file falaise/snemo/processing/overhead_monitor.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Accounting of the time spent by the process report module itself with
+ *   respect to the time of the whole event. When an overhead budget is set,
+ *   the sampling stride of optional instrumentation is doubled as long as
+ *   the measured overhead exceeds the budget, and halved back when it falls
+ *   well below. Windows still above the budget at the maximal stride are
+ *   counted: the work done on every event then exceeds the budget by itself.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_OVERHEAD_MONITOR_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_OVERHEAD_MONITOR_H 1
+
+// Standard library
+#include <iostream>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/datatools
+#include <bayeux/datatools/logger.h>
+
+namespace datatools {
+  class properties;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Self-overhead monitor and adaptive throttle
+    class overhead_monitor
+    {
+    public:
+
+      /// Setting initialization flag
+      void set_initialized(const bool initialized_);
+
+      /// Getting initialization flag
+      bool is_initialized() const;
+
+      /// Setting logging priority
+      void set_logging_priority(const datatools::logger::priority priority_);
+
+      /// Getting logging priority
+      datatools::logger::priority get_logging_priority() const;
+
+      /// Check if throttling is active
+      bool is_adaptive() const;
+
+      /// Return the overhead budget as a fraction of the event time
+      double get_budget() const;
+
+      /// Return the current sampling stride of optional features
+      uint64_t get_stride() const;
+
+      /// Return the measured overhead as a fraction of the event time
+      double get_overhead() const;
+
+      /// Return the mean self cost per event in nanoseconds
+      double get_mean_self_cost() const;
+
+      /// Constructor:
+      overhead_monitor();
+
+      /// Destructor:
+      ~overhead_monitor();
+
+      /// Initialize the monitor through configuration properties
+      void initialize(const datatools::properties & setup_);
+
+      /// Reset the monitor
+      void reset();
+
+      /// Mark the entry in the module processing
+      void begin();
+
+      /// Return the number of events represented by the current event if
+      /// optional features must run on it, 0 otherwise
+      uint64_t sample();
+
+      /// Mark the exit of the module processing
+      void end();
+
+      /// Main report method
+      void report(std::ostream & out_) const;
+
+    protected:
+
+      /// Set default values to class members:
+      void _set_defaults();
+
+    private:
+
+      /// Adapt the stride to the overhead measured on the last window
+      void _adapt_();
+
+    private:
+
+      bool _initialized_;                             //!< Initialize flag
+      datatools::logger::priority _logging_priority_; //!< Logging flag
+      double _budget_;                                //!< Overhead budget (0: no throttling)
+      uint64_t _window_;                              //!< Number of events between adaptations
+      uint64_t _max_stride_;                          //!< Maximal sampling stride
+      uint64_t _stride_;                              //!< Current sampling stride
+      uint64_t _since_sample_;                        //!< Events since the last sampled event
+      uint64_t _adaptations_;                         //!< Number of stride changes
+      uint64_t _windows_;                             //!< Number of adaptation windows
+      uint64_t _unmet_windows_;                       //!< Windows above the budget at the maximal stride
+      int64_t _begin_ns_;                             //!< Entry time of the current event
+      int64_t _last_end_ns_;                          //!< Exit time of the previous event
+      uint64_t _events_;                              //!< Number of timed events
+      int64_t _self_ns_;                              //!< Total time spent in the module
+      int64_t _total_ns_;                             //!< Total event time
+      uint64_t _window_events_;                       //!< Events in the current window
+      int64_t _window_self_ns_;                       //!< Module time in the current window
+      int64_t _window_total_ns_;                      //!< Event time in the current window
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_OVERHEAD_MONITOR_H
+
+// end of falaise/snemo/processing/overhead_monitor.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
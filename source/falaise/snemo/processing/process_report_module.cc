@@ -6,6 +6,7 @@
 // Standard library:
 #include <stdexcept>
 #include <sstream>
+#include <chrono>
 
 // Third party:
 // - Bayeux/datatools:
@@ -16,11 +17,28 @@
 // - Bayeux/cuts:
 #include <bayeux/cuts/cut_service.h>
 #include <bayeux/cuts/cut_manager.h>
+// - Bayeux/dpp:
+#include <bayeux/dpp/module_manager.h>
 
 // This project (Falaise):
+#include <falaise/snemo/datamodels/data_model.h>
+#include <falaise/snemo/datamodels/event_header.h>
 #include <falaise/snemo/processing/services.h>
 #include <falaise/snemo/processing/cut_report_driver.h>
+#include <falaise/snemo/processing/cached_cut.h>
 #include <falaise/snemo/processing/geometry_report_driver.h>
+#include <falaise/snemo/processing/profiling_report_driver.h>
+#include <falaise/snemo/processing/event_report_driver.h>
+#include <falaise/snemo/processing/complexity_report_driver.h>
+#include <falaise/snemo/processing/regression_gate.h>
+#include <falaise/snemo/processing/overhead_monitor.h>
+#include <falaise/snemo/processing/resource_sampler.h>
+#include <falaise/snemo/processing/report_checkpoint.h>
+#include <falaise/snemo/processing/report_file_sink.h>
+#include <falaise/snemo/processing/mapped_report_file.h>
+#include <falaise/snemo/processing/live_publisher.h>
+#include <falaise/snemo/processing/report_snapshot.h>
+#include <falaise/snemo/processing/state_io.h>
 
 namespace snemo {
 
@@ -30,14 +48,251 @@ namespace snemo {
     DPP_MODULE_REGISTRATION_IMPLEMENT(process_report_module,
                                       "snemo::processing::process_report_module")
 
+    namespace {
+      // Checkpoint section tags
+      const uint32_t MODULE_TAG = make_state_tag('M', 'O', 'D', 'U');
+      const uint32_t CRD_TAG    = make_state_tag('C', 'R', 'D', '_');
+      const uint32_t PRD_TAG    = make_state_tag('P', 'R', 'D', '_');
+      const uint32_t ERD_TAG    = make_state_tag('E', 'R', 'D', '_');
+      const uint32_t ERDK_TAG   = make_state_tag('E', 'R', 'D', 'K');
+      const uint32_t XRD_TAG    = make_state_tag('X', 'R', 'D', '_');
+      const uint32_t GATE_TAG   = make_state_tag('R', 'G', 'A', 'T');
+
+      /// Read the run and event numbers of a record
+      bool get_event_id(const datatools::things & data_, int32_t & run_, int32_t & event_)
+      {
+        const std::string & label = snemo::datamodel::data_info::default_event_header_label();
+        if (! data_.has(label) || ! data_.is_a<snemo::datamodel::event_header>(label)) return false;
+        const datatools::event_id & id = data_.get<snemo::datamodel::event_header>(label).get_id();
+        run_   = id.get_run_number();
+        event_ = id.get_event_number();
+        return true;
+      }
+    }
+
     void process_report_module::_set_defaults()
     {
       _CRD_.reset();
       _GRD_.reset();
+      _PRD_.reset();
+      _ERD_.reset();
+      _XRD_.reset();
+      _regression_gate_.reset();
+      _overhead_.reset();
+      _resources_.reset();
+      _samplings_.clear();
+      _checkpoint_.reset();
+      _file_stream_.reset();
+      _file_sink_.reset();
+      _mapped_file_.reset();
+      _checkpoint_period_ = 10000;
+      _checkpoint_keep_   = false;
+      _number_of_events_  = 0;
+      _checkpoint_payload_.clear();
+      _checkpoint_pending_   = false;
+      _has_last_id_    = false;
+      _last_run_       = -1;
+      _last_event_     = -1;
+      _resume_skip_    = false;
+      _skipped_events_ = 0;
+      _XRD_deferred_weight_ = 0;
+      _efficiencies_pending_ = false;
+      _live_pending_         = false;
+      _snapshot_pending_     = false;
+      _stopped_     = false;
+      _stop_status_ = dpp::base_module::PROCESS_STOP;
+      _reported_    = false;
+      _regression_  = false;
+      _live_.reset();
+      _live_period_      = 1000;
+      _live_interval_ns_ = 1000000000;
+      _live_last_ns_     = 0;
+      _live_events_      = 0;
+      _live_counters_.clear();
+      _snapshot_period_ = 0;
+      _start_ns_        = 0;
+      _start_events_    = 0;
+      _snapshot_names_.reset();
+      _snapshot_log_.reset();
+      // The last snapshot stays readable after the reset
       _out_ = 0;
       return;
     }
 
+    bool process_report_module::_print_reports()
+    {
+      if (_reported_) return _regression_;
+      if (_CRD_) _CRD_->report(*_out_);
+      if (_GRD_) _GRD_->report(*_out_);
+      if (_ERD_) _ERD_->report(*_out_);
+      if (_XRD_) _XRD_->report(*_out_);
+      if (_PRD_) _PRD_->report(*_out_);
+      if (_overhead_) _overhead_->report(*_out_);
+      if (_resources_) {
+        _resources_->stop();
+        _resources_->report(*_out_);
+      }
+      if (_regression_gate_) _regression_ = _regression_gate_->report(*_out_);
+      _out_->flush();
+      _reported_ = true;
+      return _regression_;
+    }
+
+    void process_report_module::_publish_live(const bool force_)
+    {
+      const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now().time_since_epoch()).count();
+      if (! force_ && now - _live_last_ns_ < _live_interval_ns_) return;
+      _live_last_ns_ = now;
+      if (_CRD_) _CRD_->get_tracked_counters(_live_counters_);
+      const bool first_error = (_live_->get_number_of_errors() == 0);
+      if (! _live_->publish(_live_events_, _live_counters_)
+          && first_error && _live_->get_number_of_errors() > 0) {
+        DT_LOG_ERROR(get_logging_priority(), "Module '" << get_name() << "' cannot push live updates : "
+                     << _live_->get_last_error() << " !");
+      }
+      return;
+    }
+
+    void process_report_module::_publish_snapshot(const bool last_)
+    {
+      const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now().time_since_epoch()).count();
+      const std::shared_ptr<const report_snapshot> previous = std::atomic_load(&_snapshot_);
+      std::shared_ptr<report_snapshot> a_snapshot = std::make_shared<report_snapshot>();
+      a_snapshot->last       = last_;
+      a_snapshot->elapsed    = 1e-9 * (now - _start_ns_);
+      a_snapshot->events     = _number_of_events_;
+      a_snapshot->job_events = _number_of_events_ - _start_events_;
+      if (a_snapshot->elapsed > 0.0) {
+        a_snapshot->throughput = a_snapshot->job_events / a_snapshot->elapsed;
+      }
+      a_snapshot->recent_throughput = a_snapshot->throughput;
+      if (previous) {
+        a_snapshot->sequence = previous->sequence + 1;
+        if (previous->elapsed < a_snapshot->elapsed) {
+          a_snapshot->recent_throughput = (a_snapshot->job_events - previous->job_events)
+            / (a_snapshot->elapsed - previous->elapsed);
+        }
+      }
+      a_snapshot->cut_names = _snapshot_names_;
+      if (_CRD_) _CRD_->get_tracked_counters(a_snapshot->counters);
+      if (_snapshot_log_) {
+        // Encoded in place: concurrent readers only see whole records
+        const size_t size = a_snapshot->get_counters_record_size();
+        a_snapshot->encode_counters_record(_snapshot_log_->reserve(size));
+        _snapshot_log_->commit(size);
+      }
+      // Readers still holding the previous snapshot keep it alive
+      std::atomic_store(&_snapshot_, std::shared_ptr<const report_snapshot>(a_snapshot));
+      return;
+    }
+
+    int process_report_module::get_regression_status() const
+    {
+      return _regression_status_;
+    }
+
+    std::shared_ptr<const report_snapshot> process_report_module::get_snapshot() const
+    {
+      return std::atomic_load(&_snapshot_);
+    }
+
+    const process_report_module & process_report_module::get_from(dpp::module_handle_dict_type & module_dict_,
+                                                                  const std::string & name_)
+    {
+      dpp::module_handle_dict_type::iterator found = module_dict_.find(name_);
+      DT_THROW_IF(found == module_dict_.end(), std::logic_error,
+                  "No module named '" << name_ << "' !");
+      dpp::base_module & the_module = found->second.grab_initialized_module_handle().grab();
+      const process_report_module * the_report = dynamic_cast<const process_report_module *>(&the_module);
+      DT_THROW_IF(the_report == 0, std::logic_error,
+                  "Module '" << name_ << "' is not a process report module !");
+      return *the_report;
+    }
+
+    void process_report_module::_store_state(std::string & payload_, state_block_list & blocks_) const
+    {
+      state_writer writer;
+      // Reuse the buffer capacity from one checkpoint to the other
+      writer.grab_data().swap(payload_);
+      writer.grab_data().clear();
+      size_t section = writer.begin_section(MODULE_TAG);
+      writer.write_uint64(_number_of_events_);
+      writer.write_uint32(_has_last_id_ ? 1 : 0);
+      writer.write_int64(_last_run_);
+      writer.write_int64(_last_event_);
+      writer.end_section(section);
+      if (_CRD_) {
+        section = writer.begin_section(CRD_TAG);
+        _CRD_->store_state(writer);
+        writer.end_section(section);
+      }
+      if (_PRD_) {
+        section = writer.begin_section(PRD_TAG);
+        _PRD_->store_state(writer);
+        writer.end_section(section);
+      }
+      if (_ERD_) {
+        section = writer.begin_section(ERD_TAG);
+        _ERD_->store_state(writer);
+        writer.end_section(section);
+      }
+      if (_XRD_) {
+        section = writer.begin_section(XRD_TAG);
+        _XRD_->store_state(writer);
+        writer.end_section(section);
+      }
+      if (_regression_gate_) {
+        section = writer.begin_section(GATE_TAG);
+        _regression_gate_->store_state(writer);
+        writer.end_section(section);
+      }
+      // Exact event ids: the content of this last section is made of the
+      // key log blocks, appended by the checkpoint writer thread
+      blocks_.clear();
+      if (_ERD_ && _ERD_->is_exact()) {
+        uint64_t size = 0;
+        _ERD_->get_key_blocks(blocks_, size);
+        writer.write_section_header(ERDK_TAG, size);
+      }
+      writer.grab_data().swap(payload_);
+      return;
+    }
+
+    void process_report_module::_load_state(const std::string & payload_)
+    {
+      state_reader reader(payload_);
+      while (! reader.at_end()) {
+        uint32_t tag = 0;
+        state_reader section = reader.read_section(tag);
+        if (tag == MODULE_TAG) {
+          _number_of_events_ = section.read_uint64();
+          // Id of the last counted record, records up to it are skipped
+          _has_last_id_ = (section.read_uint32() != 0);
+          _last_run_    = (int32_t) section.read_int64();
+          _last_event_  = (int32_t) section.read_int64();
+          _resume_skip_ = _has_last_id_;
+        } else if (tag == CRD_TAG) {
+          if (_CRD_) _CRD_->load_state(section);
+        } else if (tag == PRD_TAG) {
+          if (_PRD_) _PRD_->load_state(section);
+        } else if (tag == ERD_TAG) {
+          if (_ERD_) _ERD_->load_state(section);
+        } else if (tag == ERDK_TAG) {
+          if (_ERD_) _ERD_->load_keys(section);
+        } else if (tag == XRD_TAG) {
+          if (_XRD_) _XRD_->load_state(section);
+        } else if (tag == GATE_TAG) {
+          if (_regression_gate_) _regression_gate_->load_state(section);
+        } else {
+          DT_LOG_WARNING(get_logging_priority(), "Skipping unknown checkpoint section in module '"
+                         << get_name() << "' !");
+        }
+      }
+      return;
+    }
+
     void process_report_module::initialize(const datatools::properties  & setup_,
                                            datatools::service_manager   & service_manager_,
                                            dpp::module_handle_dict_type & /* module_dict_ */)
@@ -60,7 +315,39 @@ namespace snemo {
                     std::logic_error,
                     "Missing 'output.filename' property in module '"
                     << get_name () << "' ! ");
-        const std::string _output_filename_ = setup_.fetch_string("output.filename");
+        const std::string output_filename = setup_.fetch_path("output.filename");
+        report_file_sink::compression_type compression = report_file_sink::guess_compression(output_filename);
+        if (setup_.has_key("output.compression")) {
+          compression = report_file_sink::get_compression(setup_.fetch_string("output.compression"));
+        }
+        size_t block_size = 65536;
+        if (setup_.has_key("output.block_size")) {
+          const int size = setup_.fetch_integer("output.block_size");
+          DT_THROW_IF(size < 1, std::domain_error,
+                      "Invalid output block size " << size << " in module '" << get_name() << "' !");
+          block_size = size;
+        }
+        _file_sink_.reset(new report_file_sink);
+        _file_sink_->open(output_filename, compression, block_size);
+        _file_stream_.reset(new std::ostream(_file_sink_.get()));
+        _out_ = _file_stream_.get();
+      } else if (output_str == "mapped") {
+        DT_THROW_IF(! setup_.has_key("output.filename"),
+                    std::logic_error,
+                    "Missing 'output.filename' property in module '"
+                    << get_name() << "' !");
+        const std::string output_filename = setup_.fetch_path("output.filename");
+        size_t segment_size = 16777216;
+        if (setup_.has_key("output.segment_size")) {
+          const int size = setup_.fetch_integer("output.segment_size");
+          DT_THROW_IF(size <= 0, std::domain_error,
+                      "Invalid output segment size " << size << " in module '" << get_name() << "' !");
+          segment_size = size;
+        }
+        _mapped_file_.reset(new mapped_report_file);
+        _mapped_file_->open(output_filename, segment_size);
+        _file_stream_.reset(new std::ostream(_mapped_file_.get()));
+        _out_ = _file_stream_.get();
       } else {
         DT_THROW_IF(true, std::logic_error,
                     "Invalid output label '" << output_str << " for module '" << get_name () << "' !");
@@ -75,6 +362,24 @@ namespace snemo {
            idriver != driver_names.end(); ++idriver) {
         const std::string & a_driver_name = *idriver;
 
+        // Event sampling policy of the drivers that support it: the PRD
+        // keeps the detail of sampled events, the XRD only reads the banks
+        // of sampled events and weights them
+        if (setup_.has_key(a_driver_name + ".sampling.mode")) {
+          DT_THROW_IF(a_driver_name != snemo::processing::profiling_report_driver::get_id()
+                      && a_driver_name != snemo::processing::complexity_report_driver::get_id(),
+                      std::logic_error,
+                      "Driver '" << a_driver_name << "' needs every event and cannot be sampled !");
+          datatools::properties sampling_config;
+          setup_.export_and_rename_starting_with(sampling_config, a_driver_name + ".sampling.", "");
+          sampling_policy & policy = _samplings_[a_driver_name];
+          policy.initialize(sampling_config);
+          DT_THROW_IF(a_driver_name == snemo::processing::complexity_report_driver::get_id()
+                      && policy.get_mode() == sampling_policy::MODE_RESERVOIR,
+                      std::logic_error,
+                      "Driver '" << a_driver_name << "' does not support the reservoir sampling mode !");
+        }
+
         if (a_driver_name == snemo::processing::cut_report_driver::get_id()) {
           // Initialize Cut Report Driver
           _CRD_.reset(new snemo::processing::cut_report_driver);
@@ -120,11 +425,159 @@ namespace snemo {
           datatools::properties GRD_config;
           setup_.export_and_rename_starting_with(GRD_config, a_driver_name + ".", "");
           _GRD_->initialize(GRD_config);
+        } else if (a_driver_name == snemo::processing::profiling_report_driver::get_id()) {
+          // Initialize Profiling Report Driver
+          _PRD_.reset(new snemo::processing::profiling_report_driver);
+          _PRD_->set_label(get_name());
+          datatools::properties PRD_config;
+          setup_.export_and_rename_starting_with(PRD_config, a_driver_name + ".", "");
+          _PRD_->initialize(PRD_config);
+          if (_samplings_.count(a_driver_name)) _PRD_->set_sampling_policy(_samplings_[a_driver_name]);
+        } else if (a_driver_name == snemo::processing::event_report_driver::get_id()) {
+          // Initialize Event Report Driver
+          _ERD_.reset(new snemo::processing::event_report_driver);
+          datatools::properties ERD_config;
+          setup_.export_and_rename_starting_with(ERD_config, a_driver_name + ".", "");
+          _ERD_->initialize(ERD_config);
+        } else if (a_driver_name == snemo::processing::complexity_report_driver::get_id()) {
+          // Initialize Complexity Report Driver
+          _XRD_.reset(new snemo::processing::complexity_report_driver);
+          datatools::properties XRD_config;
+          setup_.export_and_rename_starting_with(XRD_config, a_driver_name + ".", "");
+          _XRD_->initialize(XRD_config);
         } else {
           DT_THROW_IF(true, std::logic_error, "Driver '" << a_driver_name << "' does not exist !");
         }
       }
 
+      // Performance regression gate :
+      _regression_status_ = 0;
+      if (setup_.has_key("regression.baseline") || setup_.has_key("regression.store")) {
+        _regression_gate_.reset(new snemo::processing::regression_gate);
+        datatools::properties regression_config;
+        setup_.export_and_rename_starting_with(regression_config, "regression.", "");
+        _regression_gate_->initialize(regression_config);
+      }
+
+      // Self-overhead accounting and throttling of expensive drivers :
+      if (setup_.has_key("overhead.budget")
+          || (setup_.has_key("overhead.report") && setup_.fetch_boolean("overhead.report"))) {
+        _overhead_.reset(new snemo::processing::overhead_monitor);
+        datatools::properties overhead_config;
+        setup_.export_and_rename_starting_with(overhead_config, "overhead.", "");
+        _overhead_->initialize(overhead_config);
+      }
+
+      // I/O and CPU usage sampled in the background :
+      if (setup_.has_key("resources.report") && setup_.fetch_boolean("resources.report")) {
+        _resources_.reset(new snemo::processing::resource_sampler);
+        datatools::properties resources_config;
+        setup_.export_and_rename_starting_with(resources_config, "resources.", "");
+        _resources_->initialize(resources_config);
+      }
+
+      // Early stop once the cut flow precision targets are reached :
+      if (setup_.has_key("early_stop.status")) {
+        const std::string status = setup_.fetch_string("early_stop.status");
+        if (status == "stop") {
+          _stop_status_ = dpp::base_module::PROCESS_STOP;
+        } else if (status == "fatal") {
+          _stop_status_ = dpp::base_module::PROCESS_FATAL;
+        } else {
+          DT_THROW_IF(true, std::logic_error, "Invalid early stop status '" << status
+                      << "' in module '" << get_name() << "' !");
+        }
+      }
+
+      // Checkpointing of the report state :
+      if (setup_.has_key("checkpoint.filename")) {
+        const std::string checkpoint_filename = setup_.fetch_path("checkpoint.filename");
+        if (setup_.has_key("checkpoint.period")) {
+          const int period = setup_.fetch_integer("checkpoint.period");
+          DT_THROW_IF(period < 1, std::domain_error,
+                      "Invalid checkpoint period " << period << " in module '" << get_name() << "' !");
+          _checkpoint_period_ = period;
+        }
+        if (setup_.has_key("checkpoint.keep")) {
+          _checkpoint_keep_ = setup_.fetch_boolean("checkpoint.keep");
+        }
+        // New exact event ids are logged for incremental checkpoints
+        if (_ERD_) _ERD_->set_key_log(true);
+        if (setup_.has_key("checkpoint.resume") && setup_.fetch_boolean("checkpoint.resume")) {
+          std::string payload;
+          if (report_checkpoint::load(checkpoint_filename, payload)) {
+            _load_state(payload);
+            DT_LOG_NOTICE(get_logging_priority(), "Module '" << get_name() << "' resumed from checkpoint '"
+                          << checkpoint_filename << "' after " << _number_of_events_ << " events");
+          } else {
+            DT_LOG_WARNING(get_logging_priority(), "No valid checkpoint '" << checkpoint_filename
+                           << "' to resume from: module '" << get_name() << "' starts from scratch !");
+          }
+        }
+        _checkpoint_.reset(new snemo::processing::report_checkpoint);
+        _checkpoint_->set_filename(checkpoint_filename);
+        _checkpoint_->set_logging_priority(get_logging_priority());
+        _checkpoint_->start();
+      }
+
+      // Live push of the counters to a collector process :
+      if (setup_.has_key("live.socket")) {
+        if (setup_.has_key("live.period")) {
+          const int period = setup_.fetch_integer("live.period");
+          DT_THROW_IF(period < 1, std::domain_error,
+                      "Invalid live period " << period << " in module '" << get_name() << "' !");
+          _live_period_ = period;
+        }
+        if (setup_.has_key("live.interval")) {
+          const double interval = setup_.fetch_real("live.interval");
+          DT_THROW_IF(interval < 0.0, std::domain_error,
+                      "Invalid live interval " << interval << " in module '" << get_name() << "' !");
+          _live_interval_ns_ = (int64_t) (1e9 * interval);
+        }
+        _live_.reset(new snemo::processing::live_publisher);
+        _live_->open(setup_.fetch_path("live.socket"));
+        std::vector<std::string> names;
+        std::vector<char> group_starts;
+        if (_CRD_) {
+          const std::vector<const std::string *> & tracked = _CRD_->get_tracked_cut_names();
+          for (size_t i = 0; i < tracked.size(); i++) names.push_back(*tracked[i]);
+          group_starts = _CRD_->get_tracked_group_starts();
+        }
+        _live_->set_cuts(names, group_starts);
+      }
+
+      // Snapshots of the statistics for the other modules :
+      if (setup_.has_key("snapshot.period")) {
+        const int period = setup_.fetch_integer("snapshot.period");
+        DT_THROW_IF(period < 1, std::domain_error,
+                    "Invalid snapshot period " << period << " in module '" << get_name() << "' !");
+        _snapshot_period_ = period;
+        std::shared_ptr<std::vector<std::string> > names = std::make_shared<std::vector<std::string> >();
+        if (_CRD_) {
+          const std::vector<const std::string *> & tracked = _CRD_->get_tracked_cut_names();
+          for (size_t i = 0; i < tracked.size(); i++) names->push_back(*tracked[i]);
+        }
+        _snapshot_names_ = names;
+      }
+      if (setup_.has_key("snapshot.log")) {
+        DT_THROW_IF(_snapshot_period_ == 0, std::logic_error,
+                    "Missing 'snapshot.period' property for the snapshot log of module '"
+                    << get_name() << "' !");
+        _snapshot_log_.reset(new mapped_report_file);
+        _snapshot_log_->open(setup_.fetch_path("snapshot.log"), 1048576);
+        const size_t size = report_snapshot::get_names_record_size(*_snapshot_names_);
+        report_snapshot::encode_names_record(*_snapshot_names_, _snapshot_log_->reserve(size));
+        _snapshot_log_->commit(size);
+      }
+      _start_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now().time_since_epoch()).count();
+      _start_events_ = _number_of_events_;
+      if (_snapshot_period_ > 0) {
+        // Do not chain with the snapshots of a previous initialization
+        std::atomic_store(&_snapshot_, std::shared_ptr<const report_snapshot>());
+        _publish_snapshot(false);
+      }
+
       // Tag the module as initialized :
       _set_initialized(true);
       return;
@@ -136,10 +589,63 @@ namespace snemo {
                   std::logic_error,
                   "Module '" << get_name() << "' is not initialized !");
 
-      if (_CRD_) _CRD_->report(*_out_);
+      if (_checkpoint_) {
+        // The job went to its end: the last checkpoint is only useful on demand
+        _checkpoint_->stop();
+        if (! _checkpoint_keep_) _checkpoint_->remove();
+      }
+
+      if (_live_) {
+        // Last chance to deliver the end of the job
+        _publish_live(true);
+        DT_LOG_NOTICE(get_logging_priority(), "Module '" << get_name() << "' pushed "
+                      << _live_->get_number_of_sent() << " live updates ("
+                      << _live_->get_number_of_dropped() << " undelivered, "
+                      << _live_->get_number_of_errors() << " failed)");
+        _live_->close();
+      }
+
+      if (_snapshot_period_ > 0) _publish_snapshot(true);
+
+      if (_snapshot_log_) {
+        _snapshot_log_->close();
+        DT_LOG_NOTICE(get_logging_priority(), "Module '" << get_name() << "' logged "
+                      << _snapshot_log_->get_committed_size() << " bytes of snapshots");
+      }
+
+      const bool regression = _print_reports();
+      const int regression_status = (regression ? _regression_gate_->get_exit_status() : 0);
+
+      if (_file_sink_) {
+        // Other resources must still be released
+        try {
+          _file_stream_->flush();
+          _file_sink_->close();
+          DT_LOG_NOTICE(get_logging_priority(), "Module '" << get_name() << "' wrote "
+                        << _file_sink_->get_output_size() << " bytes for "
+                        << _file_sink_->get_input_size() << " bytes of report");
+        } catch (std::exception & error) {
+          DT_LOG_ERROR(get_logging_priority(), "Module '" << get_name() << "': " << error.what());
+        }
+      }
+
+      if (_mapped_file_) {
+        _file_stream_->flush();
+        _mapped_file_->close();
+        DT_LOG_NOTICE(get_logging_priority(), "Module '" << get_name() << "' wrote "
+                      << _mapped_file_->get_committed_size() << " bytes of report");
+      }
 
       _set_initialized(false);
       _set_defaults();
+
+      // The status is left to the caller: the module never ends the process
+      // as the other modules still have to be reset
+      _regression_status_ = regression_status;
+      if (regression) {
+        DT_LOG_ERROR(get_logging_priority(), "Performance regression detected by module '"
+                     << get_name() << "' (status " << regression_status << ") !");
+      }
       return;
     }
 
@@ -147,6 +653,7 @@ namespace snemo {
     process_report_module::process_report_module(datatools::logger::priority logging_priority_)
       : dpp::base_module(logging_priority_)
     {
+      _regression_status_ = 0;
       _set_defaults();
       return;
     }
@@ -159,11 +666,147 @@ namespace snemo {
     }
 
     // Processing :
-    dpp::base_module::process_status process_report_module::process(datatools::things & /*data_record_*/)
+    dpp::base_module::process_status process_report_module::process(datatools::things & data_record_)
     {
       DT_THROW_IF(! is_initialized(), std::logic_error,
                   "Module '" << get_name() << "' is not initialized !");
 
+      // Cut decisions cached before this module belong to the previous
+      // stage or record
+      cached_cut::invalidate_all();
+
+      // Remaining events are not processed anymore
+      if (_stopped_) return _stop_status_;
+
+      // Records already counted before the checkpoint we resumed from
+      if (_checkpoint_) {
+        int32_t run = -1, event = -1;
+        const bool has_id = get_event_id(data_record_, run, event);
+        if (_resume_skip_ && has_id) {
+          if (run < _last_run_ || (run == _last_run_ && event <= _last_event_)) {
+            _skipped_events_++;
+            return dpp::base_module::PROCESS_SUCCESS;
+          }
+          if (run == _last_run_ && event != _last_event_ + 1) {
+            DT_LOG_WARNING(get_logging_priority(), "Module '" << get_name() << "' resumed after event "
+                           << _last_run_ << "_" << _last_event_ << " but the next record is " << run << "_"
+                           << event << ": the records in between are not counted !");
+          }
+        }
+        if (_resume_skip_) {
+          _resume_skip_ = false;
+          DT_LOG_NOTICE(get_logging_priority(), "Module '" << get_name() << "' skipped " << _skipped_events_
+                        << " records already counted before the checkpoint");
+        }
+        _has_last_id_ = has_id;
+        _last_run_    = run;
+        _last_event_  = event;
+      }
+
+      if (_overhead_) _overhead_->begin();
+
+      // Optional work is only done on the events chosen by the overhead
+      // throttle, periodic tasks that fall due in between are deferred
+      const bool optional = (_overhead_ ? _overhead_->sample() > 0 : true);
+
+      // The pipeline is timed from one event to the other, before this
+      // module. Bank reads are done on the events sampled by the XRD policy
+      // if any, and are optional: the weight of a skipped event goes to the
+      // next measured one so that results estimate all the events
+      if (_XRD_) {
+        uint64_t weight = 1;
+        std::map<std::string, sampling_policy>::iterator found
+          = _samplings_.find(complexity_report_driver::get_id());
+        if (found != _samplings_.end()) {
+          weight = (found->second.sample() ? found->second.get_weight() : 0);
+        }
+        _XRD_deferred_weight_ += weight;
+        if (weight > 0 && optional) {
+          _XRD_->process(data_record_, _XRD_deferred_weight_);
+          _XRD_deferred_weight_ = 0;
+        } else {
+          _XRD_->process(data_record_, 0);
+        }
+      }
+
+      if (_resources_) _resources_->count_event();
+
+      if (_regression_gate_) _regression_gate_->process();
+
+      // Event ids are needed for every event to catch duplicates
+      if (_ERD_) _ERD_->process(data_record_);
+
+      // Cut counters are attributed to the segment of every event
+      if (_CRD_) {
+        _CRD_->process(data_record_);
+        if (_CRD_->is_snapshot_due()) _efficiencies_pending_ = true;
+        if (_efficiencies_pending_ && optional) {
+          _CRD_->report_efficiencies(*_out_);
+          _efficiencies_pending_ = false;
+        }
+        if (_CRD_->check_precision_targets()) {
+          DT_LOG_NOTICE(get_logging_priority(), "Cut flow precision targets reached: module '"
+                        << get_name() << "' stops the processing after " << _number_of_events_ + 1 << " events"
+                        << (_stop_status_ == dpp::base_module::PROCESS_FATAL
+                            ? " (the fatal status that ends the event loop is deliberate)" : ""));
+          _stopped_ = true;
+        }
+      }
+
+      // Counters are probed on every event so that each interval covers the
+      // stage of a single event, sampled events are kept in detail
+      if (_PRD_) {
+        _PRD_->process();
+        std::map<std::string, sampling_policy>::iterator found
+          = _samplings_.find(profiling_report_driver::get_id());
+        if (found != _samplings_.end() && optional) {
+          sampling_policy & policy = found->second;
+          if (policy.sample()) {
+            if (policy.get_mode() == sampling_policy::MODE_RESERVOIR) {
+              _PRD_->keep_sample(policy.get_slot(), _number_of_events_);
+            } else {
+              _PRD_->record_sample();
+            }
+          }
+        }
+      }
+
+      _number_of_events_++;
+      if (_checkpoint_ && _number_of_events_ % _checkpoint_period_ == 0) _checkpoint_pending_ = true;
+      if (_checkpoint_pending_ && optional) {
+        state_block_list blocks;
+        _store_state(_checkpoint_payload_, blocks);
+        _checkpoint_->submit(_checkpoint_payload_, blocks);
+        _checkpoint_pending_ = false;
+      }
+
+      if (_live_) {
+        _live_events_++;
+        if (_live_events_ % _live_period_ == 0) _live_pending_ = true;
+        if (_live_pending_ && optional) {
+          _publish_live(false);
+          _live_pending_ = false;
+        }
+      }
+
+      if (_snapshot_period_ > 0 && (_number_of_events_ - _start_events_) % _snapshot_period_ == 0) {
+        _snapshot_pending_ = true;
+      }
+      if (_snapshot_pending_ && optional) {
+        _publish_snapshot(false);
+        _snapshot_pending_ = false;
+      }
+
+      if (_overhead_) _overhead_->end();
+
+      if (_stopped_) {
+        // The final report is printed once, when the targets are reached,
+        // and is readable right away in a file
+        _print_reports();
+        if (_file_sink_) _file_sink_->flush_block();
+        return _stop_status_;
+      }
+
       return dpp::base_module::PROCESS_SUCCESS;
     }
 
@@ -237,6 +880,334 @@ namespace snemo {
 
     }
 
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("regression.baseline")
+        .set_terse_description("Performance baseline file to compare with")
+        .set_traits(datatools::TYPE_STRING)
+        .set_path(true)
+        .set_mandatory(false)
+        .set_long_description("At reset, throughput and latency percentiles are compared \n"
+                              "with the baseline using Poisson bootstrap intervals.     \n")
+        .add_example("Compare with a previous run: :: \n"
+                     "                                \n"
+                     "  regression.baseline : string as path = \"baseline.conf\" \n"
+                     "                                \n"
+                     )
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("regression.store")
+        .set_terse_description("File where to store the performance state of the run")
+        .set_traits(datatools::TYPE_STRING)
+        .set_path(true)
+        .set_mandatory(false)
+        .set_long_description("The stored file can be used as a baseline by later runs.")
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("regression.threshold")
+        .set_terse_description("Relative threshold beyond which a change is a regression")
+        .set_traits(datatools::TYPE_REAL)
+        .set_mandatory(false)
+        .set_default_value_real(0.05)
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("regression.exit_status")
+        .set_terse_description("Status recorded when a regression is detected")
+        .set_traits(datatools::TYPE_INTEGER)
+        .set_mandatory(false)
+        .set_default_value_integer(1)
+        .set_long_description("The module never ends the process: the status is written \n"
+                              "to 'regression.status_file' (0 without regression) and is \n"
+                              "returned by 'get_regression_status()' after the reset.   \n")
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("regression.status_file")
+        .set_terse_description("File where to write the status of the regression check")
+        .set_traits(datatools::TYPE_STRING)
+        .set_path(true)
+        .set_mandatory(false)
+        .set_long_description("The file holds a single integer, so that a script can end \n"
+                              "with the status of the check once the job is over.       \n")
+        .add_example("Fail a CI job on regression: :: \n"
+                     "                                \n"
+                     "  regression.status_file : string as path = \"regression.status\" \n"
+                     "                                \n"
+                     "then ``flreconstruct ... && exit $(cat regression.status)``. \n"
+                     )
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("overhead.report")
+        .set_terse_description("Flag to report the time spent by the module itself")
+        .set_traits(datatools::TYPE_BOOLEAN)
+        .set_mandatory(false)
+        .set_default_value_boolean(false)
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("overhead.budget")
+        .set_terse_description("Overhead budget as a fraction of the event time")
+        .set_traits(datatools::TYPE_REAL)
+        .set_mandatory(false)
+        .set_long_description("Beyond the budget, optional work is only done on one event \n"
+                              "out of N, N being doubled every window of 'overhead.window'\n"
+                              "events (default 1000) while the budget is exceeded, up to  \n"
+                              "'overhead.max_stride' (default 1024). Optional work is the \n"
+                              "complexity measures (XRD, weighted so that they estimate \n"
+                              "all the events), the detail records of sampled           \n"
+                              "events (PRD), and the periodic efficiency reports, live    \n"
+                              "pushes, snapshots and checkpoints, which are deferred to   \n"
+                              "the next chosen event. Duplicate detection (ERD), cut      \n"
+                              "attribution and segments (CRD), drift tests and PRD probes \n"
+                              "need every event: when they alone exceed the budget, the   \n"
+                              "overhead report says that it cannot be honoured.           \n")
+        .add_example("Keep the module below 0.5% of the event time: :: \n"
+                     "                                \n"
+                     "  overhead.budget : real = 0.005 \n"
+                     "                                \n"
+                     )
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("resources.report")
+        .set_terse_description("Flag to report the I/O and CPU usage of the job")
+        .set_traits(datatools::TYPE_BOOLEAN)
+        .set_mandatory(false)
+        .set_default_value_boolean(false)
+        .set_long_description("A background thread samples /proc/self/io, /proc/self/stat \n"
+                              "and /proc/self/schedstat together with the process CPU time\n"
+                              "and the number of processed events. The report gives the   \n"
+                              "read/write rates, CPU utilization and I/O wait share over   \n"
+                              "the job and along a timeline of 'resources.timeline_rows'   \n"
+                              "rows (default 20). Block I/O wait needs the kernel delay    \n"
+                              "accounting and is reported as n/a otherwise.               \n")
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("resources.interval")
+        .set_terse_description("Sampling interval of the I/O and CPU usage (s)")
+        .set_traits(datatools::TYPE_REAL)
+        .set_mandatory(false)
+        .set_default_value_real(1.0)
+        .set_long_description("At most 'resources.max_samples' samples (default 1024) are \n"
+                              "kept: the time resolution is then halved.                  \n")
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("checkpoint.filename")
+        .set_terse_description("Checkpoint file of the report state")
+        .set_traits(datatools::TYPE_STRING)
+        .set_path(true)
+        .set_mandatory(false)
+        .set_long_description("Every 'checkpoint.period' events (default 10000), the state  \n"
+                              "of the drivers is written in the background to this file,   \n"
+                              "atomically replaced, together with the run and event numbers\n"
+                              "of the last counted record. The file is removed at the end  \n"
+                              "of the job unless 'checkpoint.keep' is set.                  \n")
+        .add_example("Checkpoint every 50000 events: :: \n"
+                     "                                \n"
+                     "  checkpoint.filename : string as path = \"report.ckp\" \n"
+                     "  checkpoint.period : integer = 50000 \n"
+                     "                                \n"
+                     )
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("checkpoint.resume")
+        .set_terse_description("Flag to resume the report state from the checkpoint file")
+        .set_traits(datatools::TYPE_BOOLEAN)
+        .set_mandatory(false)
+        .set_default_value_boolean(false)
+        .set_long_description("A missing or corrupted checkpoint is reported and the job \n"
+                              "starts from scratch. The restarted job may reprocess records\n"
+                              "already counted, e.g. from the last flush of the output    \n"
+                              "file: records up to the last counted one (in run and event \n"
+                              "number order) are passed on without being counted again.  \n"
+                              "A gap of event numbers after it, when the restart point is \n"
+                              "past the checkpoint, is reported as records not counted.   \n")
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("checkpoint.keep")
+        .set_terse_description("Flag to keep the checkpoint file at the end of the job")
+        .set_traits(datatools::TYPE_BOOLEAN)
+        .set_mandatory(false)
+        .set_default_value_boolean(false)
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("early_stop.status")
+        .set_terse_description("Status returned once the cut flow precision targets are reached")
+        .set_traits(datatools::TYPE_STRING)
+        .set_mandatory(false)
+        .set_default_value_string("stop")
+        .set_long_description("When the 'CRD.precision' targets are reached, the final   \n"
+                              "report is printed and every following event returns this \n"
+                              "status without being processed:                          \n"
+                              " - 'stop' : records are not passed to downstream modules  \n"
+                              "   and the job ends normally. The input is still read and \n"
+                              "   the upstream modules still process every record until  \n"
+                              "   the end of the input.                                  \n"
+                              " - 'fatal': the data processing driver ends the event     \n"
+                              "   loop right away, which also saves the time of the input\n"
+                              "   and of the upstream modules. The driver handles it as  \n"
+                              "   a fatal error: the job ends with an error exit status  \n"
+                              "   and batch systems report it as failed. Only use it when\n"
+                              "   the calling script expects this status.                \n")
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("output.compression")
+        .set_terse_description("Compression of the output file")
+        .set_traits(datatools::TYPE_STRING)
+        .set_mandatory(false)
+        .set_long_description("Allowed values are 'none', 'gzip' and 'zstd' (if the library \n"
+                              "was found at build time). Default is guessed from the file   \n"
+                              "extension ('.gz', '.zst'). Blocks of 'output.block_size'     \n"
+                              "bytes (default 65536) are compressed independently by a      \n"
+                              "background thread so that the file stays readable up to the  \n"
+                              "last written block if the job is killed.                     \n")
+        .add_example("Write a gzip compressed report: :: \n"
+                     "                                \n"
+                     "  output : string = \"file\" \n"
+                     "  output.filename : string as path = \"report.log.gz\" \n"
+                     "                                \n"
+                     )
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("output.segment_size")
+        .set_terse_description("Growth segment size of a memory-mapped output file")
+        .set_traits(datatools::TYPE_INTEGER)
+        .set_mandatory(false)
+        .set_default_value_integer(16777216)
+        .set_long_description("With 'output' set to 'mapped', the report is formatted      \n"
+                              "directly in a shared mapping of the output file, which is   \n"
+                              "preallocated by segments of this size and trimmed at the    \n"
+                              "end of the job. The first page of the file is a header whose\n"
+                              "committed length tells concurrent readers how many bytes of \n"
+                              "the file are complete.                                      \n")
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("live.socket")
+        .set_terse_description("Unix socket of a live collector process")
+        .set_traits(datatools::TYPE_STRING)
+        .set_path(true)
+        .set_mandatory(false)
+        .set_long_description("Every 'live.period' events (default 1000), and at most every \n"
+                              "'live.interval' seconds (default 1), the difference of the   \n"
+                              "event and cut flow counters with the last delivered push is  \n"
+                              "sent to the 'flprocessreport-collector' program listening on \n"
+                              "this socket. Sending never blocks: when no collector listens,\n"
+                              "the counters are delivered with a later push. The cut names  \n"
+                              "are only sent when needed, other messages carry the indexes  \n"
+                              "of the changed cuts; large pushes are split in 64 kB messages.\n")
+        .add_example("Push counters to a collector: :: \n"
+                     "                                \n"
+                     "  live.socket : string as path = \"/tmp/report.sock\" \n"
+                     "  live.period : integer = 500 \n"
+                     "  live.interval : real = 2.0 \n"
+                     "                                \n"
+                     )
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("live.period")
+        .set_terse_description("Number of events between two live pushes")
+        .set_traits(datatools::TYPE_INTEGER)
+        .set_mandatory(false)
+        .set_default_value_integer(1000)
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("live.interval")
+        .set_terse_description("Minimal time in seconds between two live pushes")
+        .set_traits(datatools::TYPE_REAL)
+        .set_mandatory(false)
+        .set_default_value_real(1.0)
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("snapshot.period")
+        .set_terse_description("Number of events between two snapshots of the statistics")
+        .set_traits(datatools::TYPE_INTEGER)
+        .set_mandatory(false)
+        .set_long_description("Other modules of the pipeline read the last snapshot of the   \n"
+                              "counters and throughput from any thread through                \n"
+                              "'process_report_module::get_from(module_dict_, name).get_snapshot()'.\n"
+                              "A snapshot is immutable: a new one is published at the         \n"
+                              "initialization, every 'snapshot.period' events and at the      \n"
+                              "reset. Without this key, no snapshot is published.             \n")
+        .add_example("Publish a snapshot every 100 events: :: \n"
+                     "                                \n"
+                     "  snapshot.period : integer = 100 \n"
+                     "                                \n"
+                     )
+        ;
+    }
+
+    {
+      configuration_property_description & cpd = ocd_.add_configuration_property_info();
+      cpd.set_name_pattern("snapshot.log")
+        .set_terse_description("Memory-mapped file logging the snapshots for external tools")
+        .set_traits(datatools::TYPE_STRING)
+        .set_path(true)
+        .set_mandatory(false)
+        .set_long_description("Needs 'snapshot.period'. Each snapshot is encoded as a binary \n"
+                              "record directly in a shared mapping of the file, after a     \n"
+                              "record of the cut names. External tools can read the file    \n"
+                              "while the job runs with 'mapped_report_file::read' and decode\n"
+                              "it with 'report_snapshot::decode_log'.                       \n")
+        .add_example("Log the snapshots: :: \n"
+                     "                                \n"
+                     "  snapshot.period : integer = 100 \n"
+                     "  snapshot.log : string as path = \"snapshots.dat\" \n"
+                     "                                \n"
+                     )
+        ;
+    }
+
     // Additionnal configuration hints :
     ocd_.set_configuration_hints("Here is a full configuration example in the ``datatools::properties`` \n"
                                  "ASCII format::                                                        \n"
@@ -32,10 +32,20 @@
 #ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_PROCESS_REPORT_MODULE_H
 #define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_PROCESS_REPORT_MODULE_H 1
 
+// Standard library:
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
 // Third party:
 // - Bayeux/dpp:
 #include <bayeux/dpp/base_module.h>
 
+// This project:
+#include <falaise/snemo/processing/sampling_policy.h>
+#include <falaise/snemo/processing/state_io.h>
+
 namespace snemo {
 
   namespace processing {
@@ -43,6 +53,17 @@ namespace snemo {
     // Forward declaration
     class cut_report_driver;
     class geometry_report_driver;
+    class profiling_report_driver;
+    class event_report_driver;
+    class complexity_report_driver;
+    class regression_gate;
+    class overhead_monitor;
+    class resource_sampler;
+    class report_checkpoint;
+    class report_file_sink;
+    class mapped_report_file;
+    class live_publisher;
+    struct report_snapshot;
 
     /// \brief A process report module
     class process_report_module : public dpp::base_module
@@ -66,16 +87,89 @@ namespace snemo {
       /// Data record processing
       virtual process_status process(datatools::things & data_);
 
+      /// Return the status of the regression gate at the last reset:
+      /// 'regression.exit_status' if a regression was detected, 0 otherwise
+      int get_regression_status() const;
+
+      /// Return the last published snapshot of the statistics, null if none
+      /// has been published. Safe to call from any thread.
+      std::shared_ptr<const report_snapshot> get_snapshot() const;
+
+      /// Return the report module of a given name from a module dictionary,
+      /// initializing it if needed
+      static const process_report_module & get_from(dpp::module_handle_dict_type & module_dict_,
+                                                    const std::string & name_);
+
     protected:
 
       /// Give default values to specific class members.
       void _set_defaults();
 
+      /// Print the reports of all drivers, return true if a performance
+      /// regression has been detected
+      bool _print_reports();
+
+      /// Encode the state of the drivers in a checkpoint payload, shared
+      /// blocks to append to the payload are added to a list
+      void _store_state(std::string & payload_, state_block_list & blocks_) const;
+
+      /// Resume the state of the drivers from a checkpoint payload
+      void _load_state(const std::string & payload_);
+
+      /// Push the counters to the live collector, at most every 'live.interval'
+      /// seconds unless forced
+      void _publish_live(const bool force_);
+
+      /// Publish a new snapshot of the statistics
+      void _publish_snapshot(const bool last_);
+
     private:
 
       std::ostream * _out_;                                               //<! Output stream handle
+      boost::scoped_ptr<snemo::processing::report_file_sink> _file_sink_; //!< Output file sink
+      boost::scoped_ptr<snemo::processing::mapped_report_file> _mapped_file_; //!< Memory-mapped output file
+      boost::scoped_ptr<std::ostream> _file_stream_;                      //!< Output file stream
       boost::scoped_ptr<snemo::processing::cut_report_driver> _CRD_;      //!< Cut report driver
       boost::scoped_ptr<snemo::processing::geometry_report_driver> _GRD_; //!< Geometry report driver
+      boost::scoped_ptr<snemo::processing::profiling_report_driver> _PRD_; //!< Profiling report driver
+      boost::scoped_ptr<snemo::processing::event_report_driver> _ERD_;    //!< Event report driver
+      boost::scoped_ptr<snemo::processing::complexity_report_driver> _XRD_; //!< Complexity report driver
+      boost::scoped_ptr<snemo::processing::regression_gate> _regression_gate_; //!< Performance regression gate
+      boost::scoped_ptr<snemo::processing::overhead_monitor> _overhead_;       //!< Self-overhead monitor
+      boost::scoped_ptr<snemo::processing::resource_sampler> _resources_;      //!< I/O and CPU usage sampler
+      std::map<std::string, snemo::processing::sampling_policy> _samplings_;   //!< Sampling policies per driver id
+      boost::scoped_ptr<snemo::processing::report_checkpoint> _checkpoint_;    //!< Checkpoint writer
+      uint64_t _checkpoint_period_;                                       //!< Number of events between checkpoints
+      bool _checkpoint_keep_;                                             //!< Keep the checkpoint file at reset
+      uint64_t _number_of_events_;                                        //!< Number of processed events (resumed included)
+      std::string _checkpoint_payload_;                                   //!< Reused checkpoint buffer
+      bool _checkpoint_pending_;                                          //!< Checkpoint deferred by the throttle
+      bool _has_last_id_;                                                 //!< The last counted record has an id
+      int32_t _last_run_;                                                 //!< Run number of the last counted record
+      int32_t _last_event_;                                               //!< Event number of the last counted record
+      bool _resume_skip_;                                                 //!< Skip records counted before the checkpoint
+      uint64_t _skipped_events_;                                          //!< Records skipped on resume
+      uint64_t _XRD_deferred_weight_;                                     //!< Events represented by the next complexity measure
+      bool _efficiencies_pending_;                                        //!< Efficiency report deferred by the throttle
+      bool _live_pending_;                                                //!< Live push deferred by the throttle
+      bool _snapshot_pending_;                                            //!< Snapshot deferred by the throttle
+      bool _stopped_;                                                     //!< Precision targets reached
+      process_status _stop_status_;                                       //!< Status returned once stopped
+      bool _reported_;                                                    //!< Reports already printed
+      bool _regression_;                                                  //!< Performance regression detected
+      int _regression_status_;                                            //!< Regression status of the last reset
+      boost::scoped_ptr<snemo::processing::live_publisher> _live_;        //!< Live collector publisher
+      uint64_t _live_period_;                                             //!< Number of events between pushes
+      int64_t _live_interval_ns_;                                         //!< Minimal time between pushes
+      int64_t _live_last_ns_;                                             //!< Time of the last push
+      uint64_t _live_events_;                                             //!< Number of events processed by this job
+      std::vector<uint64_t> _live_counters_;                              //!< Reused cut counters
+      uint64_t _snapshot_period_;                                         //!< Number of events between snapshots
+      int64_t _start_ns_;                                                 //!< Time of the module initialization
+      uint64_t _start_events_;                                            //!< Number of resumed events
+      std::shared_ptr<const std::vector<std::string> > _snapshot_names_;  //!< Cut names shared by snapshots
+      std::shared_ptr<const report_snapshot> _snapshot_;                  //!< Last published snapshot
+      boost::scoped_ptr<snemo::processing::mapped_report_file> _snapshot_log_; //!< Binary log of the snapshots
 
       // Macro to automate the registration of the module :
       DPP_MODULE_REGISTRATION_INTERFACE(process_report_module)
@@ -0,0 +1,557 @@
+/// \file falaise/snemo/processing/profiling_report_driver.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/profiling_report_driver.h>
+
+// This project:
+#include <falaise/snemo/processing/state_io.h>
+#include <falaise/snemo/processing/sampling_policy.h>
+
+// Standard library:
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/object_configuration_description.h>
+
+// System:
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      /// Process-wide group of counters shared by all profiling drivers so that
+      /// consecutive probes, from any module, measure consecutive intervals
+      struct counter_group
+      {
+        counter_group() : users(0), source(profiling_report_driver::SOURCE_NONE), has_last(false)
+        {
+          for (size_t i = 0; i < profiling_report_driver::COUNTER_NBR; i++) fds[i] = -1;
+        }
+
+        static counter_group & instance()
+        {
+          static counter_group g;
+          return g;
+        }
+
+        /// Try to open the perf counters, return the errno of the failure if any
+        int open_perf()
+        {
+#if defined(__linux__)
+          static const uint64_t configs[profiling_report_driver::COUNTER_NBR] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES
+          };
+          for (size_t i = 0; i < profiling_report_driver::COUNTER_NBR; i++) {
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type           = PERF_TYPE_HARDWARE;
+            attr.size           = sizeof(attr);
+            attr.config         = configs[i];
+            attr.disabled       = (i == 0 ? 1 : 0);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.read_format    = PERF_FORMAT_GROUP
+              | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const int fd = syscall(__NR_perf_event_open, &attr, 0, -1, (i == 0 ? -1 : fds[0]), 0);
+            if (fd < 0) {
+              const int error = errno;
+              close_perf();
+              return error;
+            }
+            fds[i] = fd;
+          }
+          ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+          ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+          return 0;
+#else
+          return ENOSYS;
+#endif
+        }
+
+        void close_perf()
+        {
+          for (size_t i = 0; i < profiling_report_driver::COUNTER_NBR; i++) {
+            if (fds[i] >= 0) ::close(fds[i]);
+            fds[i] = -1;
+          }
+          return;
+        }
+
+        /// Read the group, scaling values for counter multiplexing
+        bool read_perf(uint64_t * values_) const
+        {
+          uint64_t buffer[3 + profiling_report_driver::COUNTER_NBR];
+          const ssize_t sz = ::read(fds[0], buffer, sizeof(buffer));
+          if (sz != (ssize_t) sizeof(buffer)) return false;
+          const uint64_t enabled = buffer[1];
+          const uint64_t running = buffer[2];
+          for (size_t i = 0; i < profiling_report_driver::COUNTER_NBR; i++) {
+            const uint64_t raw = buffer[3 + i];
+            if (running == 0)             values_[i] = 0;
+            else if (running == enabled)  values_[i] = raw;
+            else values_[i] = (uint64_t) ((double) raw * enabled / running);
+          }
+          return true;
+        }
+
+        size_t users;
+        profiling_report_driver::source_type source;
+        int fds[profiling_report_driver::COUNTER_NBR];
+        bool has_last;
+        profiling_report_driver::reading_type last;
+      };
+
+    }
+
+    profiling_report_driver::reading_type::reading_type()
+      : wall_ns(0), cpu_us(0), voluntary_switches(0), involuntary_switches(0)
+    {
+      for (size_t i = 0; i < COUNTER_NBR; i++) counters[i] = 0;
+      return;
+    }
+
+    profiling_report_driver::accumulator_type::accumulator_type()
+    {
+      reset();
+      return;
+    }
+
+    void profiling_report_driver::accumulator_type::reset()
+    {
+      events  = 0;
+      wall_ns = 0;
+      for (size_t i = 0; i < COUNTER_NBR; i++) counters[i] = 0;
+      cpu_us  = 0;
+      voluntary_switches   = 0;
+      involuntary_switches = 0;
+      return;
+    }
+
+    const std::string & profiling_report_driver::get_id()
+    {
+      static const std::string s("PRD");
+      return s;
+    }
+
+    void profiling_report_driver::set_initialized(const bool initialized_)
+    {
+      _initialized_ = initialized_;
+      return;
+    }
+
+    bool profiling_report_driver::is_initialized() const
+    {
+      return _initialized_;
+    }
+
+    void profiling_report_driver::set_logging_priority(const datatools::logger::priority priority_)
+    {
+      _logging_priority_ = priority_;
+      return;
+    }
+
+    datatools::logger::priority profiling_report_driver::get_logging_priority() const
+    {
+      return _logging_priority_;
+    }
+
+    void profiling_report_driver::set_label(const std::string & label_)
+    {
+      _label_ = label_;
+      return;
+    }
+
+    const std::string & profiling_report_driver::get_label() const
+    {
+      return _label_;
+    }
+
+    profiling_report_driver::source_type profiling_report_driver::get_source() const
+    {
+      return _source_;
+    }
+
+    const profiling_report_driver::accumulator_type & profiling_report_driver::get_accumulator() const
+    {
+      return _accumulator_;
+    }
+
+    void profiling_report_driver::set_sampling_policy(const sampling_policy & policy_)
+    {
+      _sampling_ = &policy_;
+      if (policy_.get_mode() == sampling_policy::MODE_RESERVOIR) {
+        sample_type empty;
+        empty.event = 0;
+        empty.filled = false;
+        empty.wall_ns = empty.instructions = empty.cpu_us = 0.0;
+        _reservoir_.assign(policy_.get_reservoir_size(), empty);
+      }
+      return;
+    }
+
+    void profiling_report_driver::record_sample()
+    {
+      if (! _last_sample_.filled) return;
+      _sampled_costs_.fill(_last_sample_.wall_ns);
+      return;
+    }
+
+    void profiling_report_driver::keep_sample(const size_t slot_, const uint64_t event_number_)
+    {
+      if (slot_ >= _reservoir_.size() || ! _last_sample_.filled) return;
+      _reservoir_[slot_] = _last_sample_;
+      _reservoir_[slot_].event = event_number_;
+      return;
+    }
+
+    /// Constructor
+    profiling_report_driver::profiling_report_driver()
+    {
+      _set_defaults();
+      return;
+    }
+
+    /// Destructor
+    profiling_report_driver::~profiling_report_driver()
+    {
+      if (is_initialized()) {
+        reset();
+      }
+      return;
+    }
+
+    /// Initialize the driver through configuration properties
+    void profiling_report_driver::initialize(const datatools::properties & setup_)
+    {
+      DT_THROW_IF(is_initialized(), std::logic_error, "Driver is already initialized !");
+
+      // Logging priority
+      datatools::logger::priority lp = datatools::logger::extract_logging_configuration(setup_);
+      DT_THROW_IF(lp == datatools::logger::PRIO_UNDEFINED,
+                  std::logic_error,
+                  "Invalid logging priority level for profiling report driver !");
+      set_logging_priority(lp);
+
+      if (setup_.has_key("label")) {
+        _label_ = setup_.fetch_string("label");
+      }
+
+      if (setup_.has_key("hardware_counters")) {
+        _use_hardware_counters_ = setup_.fetch_boolean("hardware_counters");
+      }
+
+      counter_group & group = counter_group::instance();
+      if (group.users == 0) {
+        group.source = SOURCE_RUSAGE;
+        if (_use_hardware_counters_) {
+          const int error = group.open_perf();
+          if (error == 0) {
+            group.source = SOURCE_PERF;
+          } else {
+            DT_LOG_WARNING(get_logging_priority(),
+                           "Hardware performance counters are not available ("
+                           << std::strerror(error) << ") ! Falling back to getrusage statistics.");
+          }
+        }
+        group.has_last = false;
+      }
+      group.users++;
+      _source_ = group.source;
+      _accumulator_.reset();
+
+      set_initialized(true);
+      return;
+    }
+
+    /// Reset the driver
+    void profiling_report_driver::reset()
+    {
+      DT_THROW_IF(! is_initialized(), std::logic_error, "Driver is not initialized !");
+
+      counter_group & group = counter_group::instance();
+      if (--group.users == 0) {
+        group.close_perf();
+        group.source   = SOURCE_NONE;
+        group.has_last = false;
+      }
+
+      _set_defaults();
+      return;
+    }
+
+    void profiling_report_driver::_set_defaults()
+    {
+      _initialized_          = false;
+      _logging_priority_     = datatools::logger::PRIO_WARNING;
+      _label_.clear();
+      _use_hardware_counters_ = true;
+      _source_               = SOURCE_NONE;
+      _accumulator_.reset();
+      _sampling_ = 0;
+      _last_sample_.event        = 0;
+      _last_sample_.filled       = false;
+      _last_sample_.wall_ns      = 0.0;
+      _last_sample_.instructions = 0.0;
+      _last_sample_.cpu_us       = 0.0;
+      _sampled_costs_.clear();
+      _reservoir_.clear();
+      return;
+    }
+
+    void profiling_report_driver::_read_(reading_type & reading_) const
+    {
+      reading_.wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now().time_since_epoch()).count();
+      const counter_group & group = counter_group::instance();
+      if (_source_ == SOURCE_PERF) {
+        group.read_perf(reading_.counters);
+      } else if (_source_ == SOURCE_RUSAGE) {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+          reading_.cpu_us = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL
+            + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+          reading_.voluntary_switches   = usage.ru_nvcsw;
+          reading_.involuntary_switches = usage.ru_nivcsw;
+        }
+      }
+      return;
+    }
+
+    void profiling_report_driver::process()
+    {
+      DT_THROW_IF(! is_initialized(), std::logic_error, "Driver is not initialized !");
+
+      counter_group & group = counter_group::instance();
+      reading_type current;
+      _read_(current);
+      if (group.has_last) {
+        const reading_type & last = group.last;
+        _accumulator_.events++;
+        _accumulator_.wall_ns += current.wall_ns - last.wall_ns;
+        for (size_t i = 0; i < COUNTER_NBR; i++) {
+          if (current.counters[i] > last.counters[i]) {
+            _accumulator_.counters[i] += current.counters[i] - last.counters[i];
+          }
+        }
+        _accumulator_.cpu_us               += current.cpu_us - last.cpu_us;
+        _accumulator_.voluntary_switches   += current.voluntary_switches - last.voluntary_switches;
+        _accumulator_.involuntary_switches += current.involuntary_switches - last.involuntary_switches;
+        _last_sample_.filled       = true;
+        _last_sample_.wall_ns      = current.wall_ns - last.wall_ns;
+        _last_sample_.instructions = (double) (current.counters[COUNTER_INSTRUCTIONS]
+                                               - last.counters[COUNTER_INSTRUCTIONS]);
+        _last_sample_.cpu_us       = current.cpu_us - last.cpu_us;
+      }
+      group.last     = current;
+      group.has_last = true;
+      return;
+    }
+
+    void profiling_report_driver::store_state(state_writer & writer_) const
+    {
+      const accumulator_type & acc = _accumulator_;
+      writer_.write_uint32(_source_);
+      writer_.write_uint64(acc.events);
+      writer_.write_int64(acc.wall_ns);
+      for (size_t i = 0; i < COUNTER_NBR; i++) writer_.write_uint64(acc.counters[i]);
+      writer_.write_int64(acc.cpu_us);
+      writer_.write_int64(acc.voluntary_switches);
+      writer_.write_int64(acc.involuntary_switches);
+      return;
+    }
+
+    void profiling_report_driver::load_state(state_reader & reader_)
+    {
+      const uint32_t source = reader_.read_uint32();
+      accumulator_type resumed;
+      resumed.events  = reader_.read_uint64();
+      resumed.wall_ns = reader_.read_int64();
+      for (size_t i = 0; i < COUNTER_NBR; i++) resumed.counters[i] = reader_.read_uint64();
+      resumed.cpu_us               = reader_.read_int64();
+      resumed.voluntary_switches   = reader_.read_int64();
+      resumed.involuntary_switches = reader_.read_int64();
+      // Cycles and CPU time can not be added
+      if (source != (uint32_t) _source_) {
+        DT_LOG_WARNING(get_logging_priority(), "Resumed profiling statistics come from another counter source: "
+                       "profiling statistics are not resumed !");
+        return;
+      }
+      accumulator_type & acc = _accumulator_;
+      acc.events  += resumed.events;
+      acc.wall_ns += resumed.wall_ns;
+      for (size_t i = 0; i < COUNTER_NBR; i++) acc.counters[i] += resumed.counters[i];
+      acc.cpu_us               += resumed.cpu_us;
+      acc.voluntary_switches   += resumed.voluntary_switches;
+      acc.involuntary_switches += resumed.involuntary_switches;
+      return;
+    }
+
+    void profiling_report_driver::report(std::ostream & out_)
+    {
+      const accumulator_type & acc = _accumulator_;
+      const double nevents = (acc.events > 0 ? (double) acc.events : 1.0);
+      out_ << "Profiling report for '" << _label_ << "' ("
+           << (_source_ == SOURCE_PERF ? "hardware counters" : "getrusage") << ")" << std::endl;
+      const std::ios::fmtflags flags = out_.flags();
+      const std::streamsize precision = out_.precision();
+      out_.setf(std::ios::fixed);
+      out_.precision(3);
+      out_ << " ↳ Number of events         : " << acc.events << std::endl;
+      out_ << " ↳ Wall time per event      : " << 1e-6 * acc.wall_ns / nevents << " ms" << std::endl;
+      if (_source_ == SOURCE_PERF) {
+        const uint64_t cycles = acc.counters[COUNTER_CYCLES];
+        const uint64_t instr  = acc.counters[COUNTER_INSTRUCTIONS];
+        const double kinstr = (instr > 0 ? 1e-3 * instr : 1.0);
+        out_ << " ↳ Cycles per event         : " << cycles / nevents << std::endl;
+        out_ << " ↳ Instructions per event   : " << instr / nevents << std::endl;
+        out_ << " ↳ Instructions per cycle   : " << (cycles > 0 ? (double) instr / cycles : 0.0) << std::endl;
+        out_ << " ↳ Cache misses per kinstr  : " << acc.counters[COUNTER_CACHE_MISSES] / kinstr << std::endl;
+        out_ << " ↳ Branch misses per kinstr : " << acc.counters[COUNTER_BRANCH_MISSES] / kinstr << std::endl;
+      } else if (_source_ == SOURCE_RUSAGE) {
+        out_ << " ↳ CPU time per event       : " << 1e-3 * acc.cpu_us / nevents << " ms" << std::endl;
+        out_ << " ↳ CPU utilization          : "
+             << (acc.wall_ns > 0 ? 100.0 * 1e3 * acc.cpu_us / acc.wall_ns : 0.0) << " %" << std::endl;
+        out_ << " ↳ Voluntary switches       : " << acc.voluntary_switches << std::endl;
+        out_ << " ↳ Involuntary switches     : " << acc.involuntary_switches << std::endl;
+      }
+      if (_sampled_costs_.get_count() > 0) {
+        out_ << " ↳ Sampled events           : " << _sampled_costs_.get_count()
+             << " (" << _sampling_->get_description() << ")" << std::endl;
+        out_ << "   - wall time median       : " << 1e-6 * _sampled_costs_.get_quantile(0.50) << " ms" << std::endl;
+        out_ << "   - wall time 90%          : " << 1e-6 * _sampled_costs_.get_quantile(0.90) << " ms" << std::endl;
+        out_ << "   - wall time 99%          : " << 1e-6 * _sampled_costs_.get_quantile(0.99) << " ms" << std::endl;
+      }
+      if (! _reservoir_.empty()) {
+        // Empty slots: first event without reference or short job
+        std::vector<sample_type> samples;
+        for (size_t i = 0; i < _reservoir_.size(); i++) {
+          if (_reservoir_[i].filled) samples.push_back(_reservoir_[i]);
+        }
+        std::sort(samples.begin(), samples.end(),
+                  [] (const sample_type & a_, const sample_type & b_) { return a_.event < b_.event; });
+        out_ << " ↳ Reservoir of " << samples.size() << " sampled events :" << std::endl;
+        for (size_t i = 0; i < samples.size(); i++) {
+          const sample_type & a_sample = samples[i];
+          out_ << "   - event " << std::setw(10) << a_sample.event
+               << " : " << std::setw(10) << 1e-6 * a_sample.wall_ns << " ms";
+          if (_source_ == SOURCE_PERF) {
+            out_ << ", " << std::setw(14) << a_sample.instructions << " instructions";
+          } else if (_source_ == SOURCE_RUSAGE) {
+            out_ << ", " << std::setw(10) << 1e-3 * a_sample.cpu_us << " ms CPU";
+          }
+          out_ << std::endl;
+        }
+      }
+      out_.flags(flags);
+      out_.precision(precision);
+      return;
+    }
+
+    // static
+    void profiling_report_driver::init_ocd(datatools::object_configuration_description & ocd_)
+    {
+
+      // Prefix "PRD" stands for "Profiling Report Driver" :
+      datatools::logger::declare_ocd_logging_configuration(ocd_, "fatal", "PRD.");
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("PRD.hardware_counters")
+          .set_terse_description("Flag to use hardware performance counters")
+          .set_traits(datatools::TYPE_BOOLEAN)
+          .set_mandatory(false)
+          .set_default_value_boolean(true)
+          .set_long_description("When perf events are not permitted, the driver falls \n"
+                                "back to getrusage CPU time and context switches.     \n")
+          .add_example("Only use getrusage statistics:: \n"
+                       "                                \n"
+                       "  PRD.hardware_counters : boolean = false \n"
+                       "                                \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("PRD.sampling.mode")
+          .set_terse_description("Sampling mode of the events whose individual cost is kept")
+          .set_traits(datatools::TYPE_STRING)
+          .set_mandatory(false)
+          .set_default_value_string("all")
+          .set_long_description("Counters are probed on every event whatever the mode, so \n"
+                                "that totals are exact. The mode selects the events whose \n"
+                                "individual cost is kept in detail. Allowed values are:   \n"
+                                " - 'all': every event,                                   \n"
+                                " - 'every': one event out of 'PRD.sampling.every',       \n"
+                                " - 'bernoulli': events with 'PRD.sampling.probability',  \n"
+                                " - 'reservoir': 'PRD.sampling.reservoir_size' events     \n"
+                                "   uniformly sampled over the job and listed in the report.\n"
+                                "In the first three modes, the wall time distribution of  \n"
+                                "the sampled events is reported. The random generator is  \n"
+                                "seeded with 'PRD.sampling.seed'.                         \n")
+          .add_example("Keep the cost of 1% of the events:: \n"
+                       "                                \n"
+                       "  PRD.sampling.mode : string = \"bernoulli\" \n"
+                       "  PRD.sampling.probability : real = 0.01 \n"
+                       "  PRD.sampling.seed : integer = 314159 \n"
+                       "                                \n");
+      }
+
+      {
+        datatools::configuration_property_description & cpd = ocd_.add_property_info();
+        cpd.set_name_pattern("PRD.label")
+          .set_terse_description("The label under which statistics are aggregated")
+          .set_traits(datatools::TYPE_STRING)
+          .set_mandatory(false)
+          .set_long_description("Default to the name of the process report module.")
+          .add_example("Label the reconstruction stage:: \n"
+                       "                                 \n"
+                       "  PRD.label : string = \"tracking\" \n"
+                       "                                 \n");
+      }
+
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+/* OCD support */
+#include <bayeux/datatools/object_configuration_description.h>
+DOCD_CLASS_IMPLEMENT_LOAD_BEGIN(snemo::processing::profiling_report_driver,ocd_)
+{
+  ocd_.set_class_name("snemo::processing::profiling_report_driver");
+  ocd_.set_class_description("A driver class to produce report related to hardware performance counters");
+  ocd_.set_class_library("Falaise_ProcessReport");
+  ocd_.set_class_documentation("This driver does a report of cycles, instructions, cache and branch misses.\n");
+
+  // Invoke specific OCD support :
+  ::snemo::processing::profiling_report_driver::init_ocd(ocd_);
+
+  ocd_.set_validation_support(true);
+  ocd_.lock();
+  return;
+}
+DOCD_CLASS_IMPLEMENT_LOAD_END() // Closing macro for implementation
+DOCD_CLASS_SYSTEM_REGISTRATION(snemo::processing::profiling_report_driver,
+                               "snemo::processing::profiling_report_driver")
+
+// end of falaise/snemo/processing/profiling_report_driver.cc
@@ -0,0 +1,230 @@
+/// \file falaise/snemo/processing/profiling_report_driver.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   A driver class that produce a report of hardware performance counters
+ *   (cycles, instructions, cache and branch misses) read through the Linux
+ *   perf_event_open interface. When perf events are not permitted, the
+ *   driver falls back to getrusage CPU time and context switch counts.
+ *
+ *   Each call to 'process' is a probe: counters are read and the difference
+ *   with the previous probe, whatever process report module did it, is
+ *   attributed to the driver label. Putting one process report module after
+ *   each stage of the pipeline thus gives a per-stage breakdown.
+ *
+ *   Probes are cheap and made on every event, so that the interval of each
+ *   stage always belongs to a single event and totals are exact. A sampling
+ *   policy only selects the events whose individual cost is kept: their
+ *   wall time distribution, or in reservoir mode the events themselves for
+ *   inspection at the end of the job.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_PROFILING_REPORT_DRIVER_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_PROFILING_REPORT_DRIVER_H 1
+
+// Standard library
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/datatools
+#include <bayeux/datatools/logger.h>
+
+// This project:
+#include <falaise/snemo/processing/latency_histogram.h>
+
+namespace datatools {
+  class properties;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    class state_writer;
+    class state_reader;
+    class sampling_policy;
+
+    /// \brief Profiling report driver
+    class profiling_report_driver
+    {
+    public:
+
+      /// Counter type
+      enum counter_type {
+        COUNTER_CYCLES        = 0,
+        COUNTER_INSTRUCTIONS  = 1,
+        COUNTER_CACHE_MISSES  = 2,
+        COUNTER_BRANCH_MISSES = 3,
+        COUNTER_NBR           = 4
+      };
+
+      /// Counter source type
+      enum source_type {
+        SOURCE_NONE     = 0,
+        SOURCE_PERF     = 1,
+        SOURCE_RUSAGE   = 2
+      };
+
+      /// Raw reading of the counters at a given probe
+      struct reading_type
+      {
+        reading_type();
+        int64_t wall_ns;                 //!< Steady clock time
+        uint64_t counters[COUNTER_NBR];  //!< Hardware counters (perf source)
+        int64_t cpu_us;                  //!< User+system CPU time (rusage source)
+        int64_t voluntary_switches;      //!< Voluntary context switches (rusage source)
+        int64_t involuntary_switches;    //!< Involuntary context switches (rusage source)
+      };
+
+      /// Statistics accumulated between probes
+      struct accumulator_type
+      {
+        accumulator_type();
+        void reset();
+        uint64_t events;
+        int64_t wall_ns;
+        uint64_t counters[COUNTER_NBR];
+        int64_t cpu_us;
+        int64_t voluntary_switches;
+        int64_t involuntary_switches;
+      };
+
+      /// Cost of a single sampled event
+      struct sample_type
+      {
+        uint64_t event;         //!< Event number
+        bool filled;            //!< Slot holds a measured event
+        double wall_ns;         //!< Wall time of the event
+        double instructions;    //!< Instructions of the event (perf source)
+        double cpu_us;          //!< CPU time of the event (rusage source)
+      };
+
+      /// Return driver id
+      static const std::string & get_id();
+
+      /// Setting initialization flag
+      void set_initialized(const bool initialized_);
+
+      /// Getting initialization flag
+      bool is_initialized() const;
+
+      /// Setting logging priority
+      void set_logging_priority(const datatools::logger::priority priority_);
+
+      /// Getting logging priority
+      datatools::logger::priority get_logging_priority() const;
+
+      /// Set the label under which statistics are aggregated
+      void set_label(const std::string & label_);
+
+      /// Return the label under which statistics are aggregated
+      const std::string & get_label() const;
+
+      /// Return the active counter source
+      source_type get_source() const;
+
+      /// Return the accumulated statistics
+      const accumulator_type & get_accumulator() const;
+
+      /// Set the sampling policy selecting the events kept in detail (not owned)
+      void set_sampling_policy(const sampling_policy & policy_);
+
+      /// Add the cost of the current event to the sampled distribution
+      void record_sample();
+
+      /// Keep the cost of the current event in a reservoir slot
+      void keep_sample(const size_t slot_, const uint64_t event_number_);
+
+      /// Constructor:
+      profiling_report_driver();
+
+      /// Destructor:
+      ~profiling_report_driver();
+
+      /// Initialize the driver through configuration properties
+      void initialize(const datatools::properties & setup_);
+
+      /// Reset the driver
+      void reset();
+
+      /// Probe the counters and accumulate the difference with the previous
+      /// probe as the cost of the current event
+      void process();
+
+      /// Main report method
+      void report(std::ostream & out_);
+
+      /// Store the accumulated statistics
+      void store_state(state_writer & writer_) const;
+
+      /// Add statistics accumulated by a previous job with the same counter
+      /// source, ignore them otherwise
+      void load_state(state_reader & reader_);
+
+      /// OCD support:
+      static void init_ocd(datatools::object_configuration_description & ocd_);
+
+    protected:
+
+      /// Set default values to class members:
+      void _set_defaults();
+
+    private:
+
+      /// Read the current counter values
+      void _read_(reading_type & reading_) const;
+
+    private:
+
+      bool _initialized_;                             //!< Initialize flag
+      datatools::logger::priority _logging_priority_; //!< Logging flag
+      std::string _label_;                            //!< Aggregation label
+      bool _use_hardware_counters_;                   //!< Request hardware counters
+      source_type _source_;                           //!< Active counter source
+      accumulator_type _accumulator_;                 //!< Accumulated statistics
+      const sampling_policy * _sampling_;             //!< Sampling policy
+      sample_type _last_sample_;                      //!< Cost of the current event
+      latency_histogram _sampled_costs_;              //!< Wall time of sampled events
+      std::vector<sample_type> _reservoir_;           //!< Reservoir of sampled events
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#include <bayeux/datatools/ocd_macros.h>
+
+// Declare the OCD interface of the module
+DOCD_CLASS_DECLARATION(snemo::processing::profiling_report_driver)
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_PROFILING_REPORT_DRIVER_H
+
+// end of falaise/snemo/processing/profiling_report_driver.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,364 @@
+/// \file falaise/snemo/processing/regression_gate.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/regression_gate.h>
+
+// This project:
+#include <falaise/snemo/processing/state_io.h>
+
+// Standard library:
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      /// Compared metrics
+      enum metric_type {
+        METRIC_THROUGHPUT = 0,
+        METRIC_MEAN       = 1,
+        METRIC_P50        = 2,
+        METRIC_P90        = 3,
+        METRIC_P99        = 4,
+        METRIC_NBR        = 5
+      };
+
+      const char * metric_labels[METRIC_NBR] = {
+        "Throughput (Hz)", "Mean latency (ms)", "Latency p50 (ms)", "Latency p90 (ms)", "Latency p99 (ms)"
+      };
+
+      void compute_metrics(const latency_histogram & h_, double * metrics_)
+      {
+        const double mean = h_.get_mean();
+        metrics_[METRIC_THROUGHPUT] = (mean > 0.0 ? 1e9 / mean : 0.0);
+        metrics_[METRIC_MEAN] = 1e-6 * mean;
+        metrics_[METRIC_P50]  = 1e-6 * h_.get_quantile(0.50);
+        metrics_[METRIC_P90]  = 1e-6 * h_.get_quantile(0.90);
+        metrics_[METRIC_P99]  = 1e-6 * h_.get_quantile(0.99);
+        return;
+      }
+
+      /// Poisson bootstrap replica: each bin content is drawn from a Poisson
+      /// law of mean the observed content
+      void resample(const latency_histogram & h_, std::mt19937_64 & rng_, latency_histogram & replica_)
+      {
+        const std::vector<double> & counts = h_.get_counts();
+        const std::vector<double> & sums   = h_.get_sums();
+        std::vector<double> rcounts(counts.size(), 0.0);
+        std::vector<double> rsums(sums.size(), 0.0);
+        for (size_t i = 0; i < counts.size(); i++) {
+          if (counts[i] <= 0.0) continue;
+          std::poisson_distribution<uint64_t> poisson(counts[i]);
+          rcounts[i] = (double) poisson(rng_);
+          rsums[i]   = rcounts[i] * sums[i] / counts[i];
+        }
+        replica_.set_contents(rcounts, rsums);
+        return;
+      }
+
+      double sorted_quantile(const std::vector<double> & values_, const double q_)
+      {
+        if (values_.empty()) return 0.0;
+        const double x = q_ * (values_.size() - 1);
+        const size_t i = (size_t) x;
+        if (i + 1 >= values_.size()) return values_.back();
+        const double f = x - i;
+        return values_[i] * (1.0 - f) + values_[i + 1] * f;
+      }
+
+    }
+
+    void regression_gate::set_initialized(const bool initialized_)
+    {
+      _initialized_ = initialized_;
+      return;
+    }
+
+    bool regression_gate::is_initialized() const
+    {
+      return _initialized_;
+    }
+
+    void regression_gate::set_logging_priority(const datatools::logger::priority priority_)
+    {
+      _logging_priority_ = priority_;
+      return;
+    }
+
+    datatools::logger::priority regression_gate::get_logging_priority() const
+    {
+      return _logging_priority_;
+    }
+
+    bool regression_gate::has_baseline() const
+    {
+      return _has_baseline_;
+    }
+
+    int regression_gate::get_exit_status() const
+    {
+      return _exit_status_;
+    }
+
+    const latency_histogram & regression_gate::get_latencies() const
+    {
+      return _latencies_;
+    }
+
+    latency_histogram & regression_gate::grab_latencies()
+    {
+      return _latencies_;
+    }
+
+    regression_gate::regression_gate()
+    {
+      _set_defaults();
+      return;
+    }
+
+    regression_gate::~regression_gate()
+    {
+      if (is_initialized()) {
+        reset();
+      }
+      return;
+    }
+
+    void regression_gate::initialize(const datatools::properties & setup_)
+    {
+      DT_THROW_IF(is_initialized(), std::logic_error, "Regression gate is already initialized !");
+
+      // Logging priority
+      datatools::logger::priority lp = datatools::logger::extract_logging_configuration(setup_);
+      DT_THROW_IF(lp == datatools::logger::PRIO_UNDEFINED,
+                  std::logic_error,
+                  "Invalid logging priority level for regression gate !");
+      set_logging_priority(lp);
+
+      if (setup_.has_key("baseline")) {
+        _baseline_filename_ = setup_.fetch_path("baseline");
+      }
+
+      if (setup_.has_key("store")) {
+        _store_filename_ = setup_.fetch_path("store");
+      }
+
+      if (setup_.has_key("threshold")) {
+        _threshold_ = setup_.fetch_real("threshold");
+        DT_THROW_IF(_threshold_ < 0.0, std::domain_error,
+                    "Invalid negative regression threshold !");
+      }
+
+      if (setup_.has_key("confidence_level")) {
+        _confidence_level_ = setup_.fetch_real("confidence_level");
+        DT_THROW_IF(_confidence_level_ <= 0.0 || _confidence_level_ >= 1.0, std::domain_error,
+                    "Invalid confidence level " << _confidence_level_ << " !");
+      }
+
+      if (setup_.has_key("bootstrap_samples")) {
+        const int n = setup_.fetch_integer("bootstrap_samples");
+        DT_THROW_IF(n < 10, std::domain_error, "Number of bootstrap samples must be at least 10 !");
+        _bootstrap_samples_ = n;
+      }
+
+      if (setup_.has_key("seed")) {
+        _seed_ = setup_.fetch_integer("seed");
+      }
+
+      if (setup_.has_key("min_events")) {
+        _min_events_ = setup_.fetch_integer("min_events");
+      }
+
+      if (setup_.has_key("exit_status")) {
+        _exit_status_ = setup_.fetch_integer("exit_status");
+      }
+
+      if (setup_.has_key("status_file")) {
+        _status_filename_ = setup_.fetch_path("status_file");
+      }
+
+      if (! _baseline_filename_.empty()) {
+        load_baseline(_baseline_filename_);
+      }
+
+      set_initialized(true);
+      return;
+    }
+
+    void regression_gate::reset()
+    {
+      DT_THROW_IF(! is_initialized(), std::logic_error, "Regression gate is not initialized !");
+      _set_defaults();
+      return;
+    }
+
+    void regression_gate::_set_defaults()
+    {
+      _initialized_      = false;
+      _logging_priority_ = datatools::logger::PRIO_WARNING;
+      _baseline_filename_.clear();
+      _store_filename_.clear();
+      _threshold_         = 0.05;
+      _confidence_level_  = 0.95;
+      _bootstrap_samples_ = 1000;
+      _seed_              = 0;
+      _min_events_        = 100;
+      _exit_status_       = 1;
+      _status_filename_.clear();
+      _has_last_          = false;
+      _last_ns_           = 0;
+      _latencies_.clear();
+      _baseline_.clear();
+      _has_baseline_      = false;
+      return;
+    }
+
+    void regression_gate::process()
+    {
+      const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now().time_since_epoch()).count();
+      if (_has_last_) _latencies_.fill((double) (now - _last_ns_));
+      _last_ns_  = now;
+      _has_last_ = true;
+      return;
+    }
+
+    void regression_gate::store(const std::string & filename_) const
+    {
+      datatools::properties state;
+      state.store_real("events", (double) _latencies_.get_count(), "Number of timed events");
+      _latencies_.export_to(state, "latency.");
+      datatools::properties::write_config(filename_, state);
+      return;
+    }
+
+    void regression_gate::load_baseline(const std::string & filename_)
+    {
+      datatools::properties state;
+      datatools::properties::read_config(filename_, state);
+      _baseline_.import_from(state, "latency.");
+      _has_baseline_ = true;
+      DT_LOG_NOTICE(get_logging_priority(), "Loaded performance baseline '" << filename_ << "' with "
+                    << _baseline_.get_count() << " events");
+      return;
+    }
+
+    void regression_gate::store_state(state_writer & writer_) const
+    {
+      writer_.write_doubles(_latencies_.get_counts());
+      writer_.write_doubles(_latencies_.get_sums());
+      return;
+    }
+
+    void regression_gate::load_state(state_reader & reader_)
+    {
+      std::vector<double> counts, sums;
+      reader_.read_doubles(counts);
+      reader_.read_doubles(sums);
+      latency_histogram resumed;
+      resumed.set_contents(counts, sums);
+      _latencies_.merge(resumed);
+      return;
+    }
+
+    bool regression_gate::report(std::ostream & out_)
+    {
+      bool regression = false;
+
+      if (_has_baseline_) {
+        out_ << "Performance regression check against '" << _baseline_filename_ << "'" << std::endl;
+        out_ << " ↳ Baseline events : " << _baseline_.get_count() << std::endl;
+        out_ << " ↳ Current events  : " << _latencies_.get_count() << std::endl;
+        if (_baseline_.get_count() < _min_events_ || _latencies_.get_count() < _min_events_) {
+          out_ << " ↳ Not enough events to compare (minimum " << _min_events_ << ")" << std::endl;
+        } else {
+          double baseline[METRIC_NBR], current[METRIC_NBR];
+          compute_metrics(_baseline_, baseline);
+          compute_metrics(_latencies_, current);
+
+          // Bootstrap distribution of current/baseline ratios
+          std::mt19937_64 rng(_seed_);
+          std::vector<std::vector<double> > ratios(METRIC_NBR);
+          latency_histogram baseline_replica, current_replica;
+          for (size_t b = 0; b < _bootstrap_samples_; b++) {
+            resample(_baseline_, rng, baseline_replica);
+            resample(_latencies_, rng, current_replica);
+            double rb[METRIC_NBR], rc[METRIC_NBR];
+            compute_metrics(baseline_replica, rb);
+            compute_metrics(current_replica, rc);
+            for (size_t m = 0; m < METRIC_NBR; m++) {
+              if (rb[m] > 0.0) ratios[m].push_back(rc[m] / rb[m]);
+            }
+          }
+
+          const double alpha = 1.0 - _confidence_level_;
+          const std::ios::fmtflags flags = out_.flags();
+          const std::streamsize precision = out_.precision();
+          out_.setf(std::ios::fixed);
+          out_ << " ↳ Ratios current/baseline with " << 100.0 * _confidence_level_
+               << "% bootstrap intervals, threshold " << 100.0 * _threshold_ << "%" << std::endl;
+          for (size_t m = 0; m < METRIC_NBR; m++) {
+            std::vector<double> & r = ratios[m];
+            std::sort(r.begin(), r.end());
+            const double low  = sorted_quantile(r, 0.5 * alpha);
+            const double high = sorted_quantile(r, 1.0 - 0.5 * alpha);
+            const double ratio = (baseline[m] > 0.0 ? current[m] / baseline[m] : 0.0);
+            // Throughput regresses when it decreases, latencies when they increase
+            const bool worse = (m == METRIC_THROUGHPUT
+                                ? high < 1.0 - _threshold_
+                                : low  > 1.0 + _threshold_);
+            const bool better = (m == METRIC_THROUGHPUT
+                                 ? low  > 1.0 + _threshold_
+                                 : high < 1.0 - _threshold_);
+            if (worse) regression = true;
+            out_ << "   " << std::left << std::setw(18) << metric_labels[m] << std::right
+                 << std::setprecision(3)
+                 << " : " << std::setw(12) << baseline[m]
+                 << " → " << std::setw(12) << current[m]
+                 << "  ratio " << ratio
+                 << " [" << low << ", " << high << "]"
+                 << (worse ? "  REGRESSION" : (better ? "  improvement" : ""))
+                 << std::endl;
+          }
+          out_.flags(flags);
+          out_.precision(precision);
+          out_ << " ↳ " << (regression ? "Performance regression detected !" : "No performance regression")
+               << std::endl;
+        }
+      }
+
+      if (! _store_filename_.empty()) {
+        store(_store_filename_);
+        DT_LOG_NOTICE(get_logging_priority(), "Performance state stored in '" << _store_filename_ << "'");
+      }
+
+      if (! _status_filename_.empty()) {
+        // Read by the calling script: the plugin never ends the process itself
+        std::ofstream status_file(_status_filename_.c_str());
+        status_file << (regression ? _exit_status_ : 0) << std::endl;
+        if (! status_file) {
+          DT_LOG_ERROR(get_logging_priority(), "Cannot write the regression status file '"
+                       << _status_filename_ << "' !");
+        }
+      }
+
+      return regression;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/regression_gate.cc
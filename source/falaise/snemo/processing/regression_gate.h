@@ -0,0 +1,156 @@
+/// \file falaise/snemo/processing/regression_gate.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   A performance regression gate. The latency between two consecutive
+ *   events is histogrammed and, at the end of the job, the throughput and
+ *   latency percentiles are compared with a baseline stored by a previous
+ *   run. Confidence intervals on the current/baseline ratios are computed by
+ *   Poisson bootstrap of both histograms; a regression is flagged when the
+ *   whole interval lies beyond the relative threshold. The verdict can be
+ *   written to a status file for the calling script.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REGRESSION_GATE_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REGRESSION_GATE_H 1
+
+// Standard library
+#include <string>
+#include <iostream>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/datatools
+#include <bayeux/datatools/logger.h>
+
+// This project:
+#include <falaise/snemo/processing/latency_histogram.h>
+
+namespace datatools {
+  class properties;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    class state_writer;
+    class state_reader;
+
+    /// \brief Performance regression gate
+    class regression_gate
+    {
+    public:
+
+      /// Setting initialization flag
+      void set_initialized(const bool initialized_);
+
+      /// Getting initialization flag
+      bool is_initialized() const;
+
+      /// Setting logging priority
+      void set_logging_priority(const datatools::logger::priority priority_);
+
+      /// Getting logging priority
+      datatools::logger::priority get_logging_priority() const;
+
+      /// Check if a baseline has been loaded
+      bool has_baseline() const;
+
+      /// Return the status recorded when a regression is detected
+      int get_exit_status() const;
+
+      /// Return the current latency histogram
+      const latency_histogram & get_latencies() const;
+
+      /// Return a mutable reference to the current latency histogram
+      latency_histogram & grab_latencies();
+
+      /// Constructor:
+      regression_gate();
+
+      /// Destructor:
+      ~regression_gate();
+
+      /// Initialize the gate through configuration properties
+      void initialize(const datatools::properties & setup_);
+
+      /// Reset the gate
+      void reset();
+
+      /// Record the time of a new event
+      void process();
+
+      /// Store the current state as a baseline file
+      void store(const std::string & filename_) const;
+
+      /// Load a baseline file
+      void load_baseline(const std::string & filename_);
+
+      /// Store the current latencies
+      void store_state(state_writer & writer_) const;
+
+      /// Add latencies recorded by a previous job
+      void load_state(state_reader & reader_);
+
+      /// Compare with the baseline, store the current state if requested
+      /// and return true if a regression has been detected
+      bool report(std::ostream & out_);
+
+    protected:
+
+      /// Set default values to class members:
+      void _set_defaults();
+
+    private:
+
+      bool _initialized_;                             //!< Initialize flag
+      datatools::logger::priority _logging_priority_; //!< Logging flag
+      std::string _baseline_filename_;                //!< Baseline file to compare with
+      std::string _store_filename_;                   //!< File where to store the current state
+      double _threshold_;                             //!< Relative threshold
+      double _confidence_level_;                      //!< Confidence level of intervals
+      size_t _bootstrap_samples_;                     //!< Number of bootstrap samples
+      uint64_t _seed_;                                //!< Bootstrap random seed
+      uint64_t _min_events_;                          //!< Minimal number of events to compare
+      int _exit_status_;                              //!< Status recorded on regression
+      std::string _status_filename_;                  //!< File where to write the status
+      bool _has_last_;                                //!< Previous event time is valid
+      int64_t _last_ns_;                              //!< Previous event time
+      latency_histogram _latencies_;                  //!< Current latencies
+      latency_histogram _baseline_;                   //!< Baseline latencies
+      bool _has_baseline_;                            //!< Baseline flag
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REGRESSION_GATE_H
+
+// end of falaise/snemo/processing/regression_gate.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
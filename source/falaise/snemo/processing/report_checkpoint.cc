@@ -0,0 +1,234 @@
+/// \file falaise/snemo/processing/report_checkpoint.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/report_checkpoint.h>
+
+// Standard library:
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+
+// System:
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      const char checkpoint_magic[8] = { 'F', 'L', 'P', 'R', 'C', 'K', 'P', '5' };
+
+      uint64_t fnv1a(const std::string & data_)
+      {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < data_.size(); i++) {
+          hash ^= (unsigned char) data_[i];
+          hash *= 1099511628211ULL;
+        }
+        return hash;
+      }
+
+      void encode_uint64(const uint64_t value_, char * bytes_)
+      {
+        for (size_t i = 0; i < 8; i++) bytes_[i] = (char) ((value_ >> (8 * i)) & 0xFF);
+        return;
+      }
+
+      uint64_t decode_uint64(const char * bytes_)
+      {
+        uint64_t value = 0;
+        for (size_t i = 0; i < 8; i++) value |= (uint64_t) (unsigned char) bytes_[i] << (8 * i);
+        return value;
+      }
+
+      bool write_all(const int fd_, const char * data_, size_t size_)
+      {
+        while (size_ > 0) {
+          const ssize_t n = ::write(fd_, data_, size_);
+          if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+          }
+          data_ += n;
+          size_ -= n;
+        }
+        return true;
+      }
+
+    }
+
+    report_checkpoint::report_checkpoint()
+      : _logging_priority_(datatools::logger::PRIO_WARNING),
+        _has_pending_(false), _stop_(false), _running_(false), _writes_(0)
+    {
+      return;
+    }
+
+    report_checkpoint::~report_checkpoint()
+    {
+      if (is_running()) stop();
+      return;
+    }
+
+    void report_checkpoint::set_filename(const std::string & filename_)
+    {
+      DT_THROW_IF(is_running(), std::logic_error, "Checkpoint writer is running !");
+      _filename_ = filename_;
+      return;
+    }
+
+    const std::string & report_checkpoint::get_filename() const
+    {
+      return _filename_;
+    }
+
+    void report_checkpoint::set_logging_priority(const datatools::logger::priority priority_)
+    {
+      _logging_priority_ = priority_;
+      return;
+    }
+
+    datatools::logger::priority report_checkpoint::get_logging_priority() const
+    {
+      return _logging_priority_;
+    }
+
+    bool report_checkpoint::is_running() const
+    {
+      return _running_;
+    }
+
+    uint64_t report_checkpoint::get_number_of_writes() const
+    {
+      return _writes_.load();
+    }
+
+    void report_checkpoint::start()
+    {
+      DT_THROW_IF(is_running(), std::logic_error, "Checkpoint writer is already running !");
+      DT_THROW_IF(_filename_.empty(), std::logic_error, "Missing checkpoint file name !");
+      _stop_ = false;
+      _has_pending_ = false;
+      _thread_ = std::thread(&report_checkpoint::_run_, this);
+      _running_ = true;
+      return;
+    }
+
+    void report_checkpoint::stop()
+    {
+      DT_THROW_IF(! is_running(), std::logic_error, "Checkpoint writer is not running !");
+      {
+        std::lock_guard<std::mutex> lock(_mutex_);
+        _stop_ = true;
+      }
+      _cv_.notify_one();
+      _thread_.join();
+      _running_ = false;
+      return;
+    }
+
+    void report_checkpoint::submit(std::string & payload_, const state_block_list & blocks_)
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex_);
+        _pending_.swap(payload_);
+        _pending_blocks_ = blocks_;
+        _has_pending_ = true;
+      }
+      _cv_.notify_one();
+      return;
+    }
+
+    void report_checkpoint::_run_()
+    {
+      std::string payload;
+      state_block_list blocks;
+      while (true) {
+        {
+          std::unique_lock<std::mutex> lock(_mutex_);
+          _cv_.wait(lock, [this] { return _has_pending_ || _stop_; });
+          if (! _has_pending_) break;
+          payload.swap(_pending_);
+          blocks.swap(_pending_blocks_);
+          _pending_blocks_.clear();
+          _has_pending_ = false;
+        }
+        try {
+          for (size_t i = 0; i < blocks.size(); i++) payload.append(*blocks[i]);
+          blocks.clear();
+          write(_filename_, payload);
+          _writes_++;
+        } catch (std::exception & error) {
+          // Do not kill the job for a failed checkpoint
+          DT_LOG_WARNING(get_logging_priority(), "Checkpoint not written: " << error.what());
+        }
+      }
+      return;
+    }
+
+    void report_checkpoint::remove() const
+    {
+      std::remove(_filename_.c_str());
+      return;
+    }
+
+    // static
+    void report_checkpoint::write(const std::string & filename_, const std::string & payload_)
+    {
+      const std::string tmp_filename = filename_ + ".tmp";
+      const int fd = ::open(tmp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      DT_THROW_IF(fd < 0, std::runtime_error,
+                  "Cannot open checkpoint file '" << tmp_filename << "' : " << std::strerror(errno));
+      char header[16];
+      std::memcpy(header, checkpoint_magic, 8);
+      encode_uint64(payload_.size(), header + 8);
+      char trailer[8];
+      encode_uint64(fnv1a(payload_), trailer);
+      const bool ok = write_all(fd, header, sizeof(header))
+        && write_all(fd, payload_.data(), payload_.size())
+        && write_all(fd, trailer, sizeof(trailer))
+        && ::fsync(fd) == 0;
+      ::close(fd);
+      DT_THROW_IF(! ok, std::runtime_error,
+                  "Cannot write checkpoint file '" << tmp_filename << "' : " << std::strerror(errno));
+      DT_THROW_IF(std::rename(tmp_filename.c_str(), filename_.c_str()) != 0, std::runtime_error,
+                  "Cannot rename checkpoint file '" << tmp_filename << "' : " << std::strerror(errno));
+      return;
+    }
+
+    // static
+    bool report_checkpoint::load(const std::string & filename_, std::string & payload_)
+    {
+      std::ifstream fin(filename_.c_str(), std::ios::binary);
+      if (! fin) return false;
+      char header[16];
+      if (! fin.read(header, sizeof(header))) return false;
+      if (std::memcmp(header, checkpoint_magic, 8) != 0) return false;
+      const uint64_t size = decode_uint64(header + 8);
+      // Do not trust the size of a corrupted header
+      const std::streamoff position = fin.tellg();
+      if (! fin.seekg(0, std::ios::end)) return false;
+      const std::streamoff remaining = fin.tellg() - position;
+      if (remaining < 8 || size > (uint64_t) (remaining - 8)) return false;
+      fin.seekg(position);
+      payload_.resize(size);
+      if (size > 0 && ! fin.read(&payload_[0], size)) return false;
+      char trailer[8];
+      if (! fin.read(trailer, sizeof(trailer))) return false;
+      return decode_uint64(trailer) == fnv1a(payload_);
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/report_checkpoint.cc
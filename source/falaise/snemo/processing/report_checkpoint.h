@@ -0,0 +1,138 @@
+/// \file falaise/snemo/processing/report_checkpoint.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Periodic checkpoint of the report state. The state is encoded by the
+ *   event thread and handed over to a background thread which writes it
+ *   to a temporary file, syncs it and atomically renames it over the
+ *   checkpoint file. If the writer is still busy, only the latest state is
+ *   kept. Large append-only parts of the state are handed over as shared
+ *   immutable blocks and appended to the payload by the writer thread, so
+ *   that the event thread does not copy them. The file starts with a magic
+ *   word and the payload size, and ends with a FNV-1a checksum of the
+ *   payload.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REPORT_CHECKPOINT_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REPORT_CHECKPOINT_H 1
+
+// Standard library
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/datatools
+#include <bayeux/datatools/logger.h>
+
+// This project:
+#include <falaise/snemo/processing/state_io.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Background checkpoint writer
+    class report_checkpoint
+    {
+    public:
+
+      /// Constructor
+      report_checkpoint();
+
+      /// Destructor
+      ~report_checkpoint();
+
+      /// Set the checkpoint file name
+      void set_filename(const std::string & filename_);
+
+      /// Return the checkpoint file name
+      const std::string & get_filename() const;
+
+      /// Setting logging priority
+      void set_logging_priority(const datatools::logger::priority priority_);
+
+      /// Getting logging priority
+      datatools::logger::priority get_logging_priority() const;
+
+      /// Check if the writer thread is running
+      bool is_running() const;
+
+      /// Start the writer thread
+      void start();
+
+      /// Write the pending state if any and stop the writer thread
+      void stop();
+
+      /// Hand a state over to the writer thread. The content of the payload
+      /// is swapped with a previously written buffer to avoid allocations.
+      /// Blocks are appended to the payload by the writer thread.
+      void submit(std::string & payload_, const state_block_list & blocks_ = state_block_list());
+
+      /// Return the number of checkpoints written
+      uint64_t get_number_of_writes() const;
+
+      /// Remove the checkpoint file
+      void remove() const;
+
+      /// Read and check a checkpoint file, return false if it is missing or invalid
+      static bool load(const std::string & filename_, std::string & payload_);
+
+      /// Write a checkpoint file atomically
+      static void write(const std::string & filename_, const std::string & payload_);
+
+    private:
+
+      /// Writer thread loop
+      void _run_();
+
+    private:
+
+      std::string _filename_;             //!< Checkpoint file name
+      datatools::logger::priority _logging_priority_; //!< Logging flag
+      std::thread _thread_;               //!< Writer thread
+      mutable std::mutex _mutex_;         //!< Protect the pending state
+      std::condition_variable _cv_;       //!< Wake up the writer thread
+      std::string _pending_;              //!< State waiting to be written
+      state_block_list _pending_blocks_;  //!< Blocks appended to the pending state
+      bool _has_pending_;                 //!< Pending state flag
+      bool _stop_;                        //!< Stop request
+      bool _running_;                     //!< Running flag
+      std::atomic<uint64_t> _writes_;     //!< Number of checkpoints written
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REPORT_CHECKPOINT_H
+
+// end of falaise/snemo/processing/report_checkpoint.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,258 @@
+/// \file falaise/snemo/processing/report_file_sink.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/report_file_sink.h>
+
+// Standard library:
+#include <stdexcept>
+
+// Third party:
+// - Boost:
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/logger.h>
+
+#if defined(FALAISE_PROCESSREPORT_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+      /// Maximal number of blocks waiting to be written
+      const size_t MAX_QUEUED_BLOCKS = 8;
+    }
+
+    // static
+    report_file_sink::compression_type report_file_sink::get_compression(const std::string & label_)
+    {
+      if (label_ == "none") return COMPRESSION_NONE;
+      if (label_ == "gzip") return COMPRESSION_GZIP;
+      if (label_ == "zstd") return COMPRESSION_ZSTD;
+      DT_THROW_IF(true, std::logic_error, "Invalid compression '" << label_ << "' !");
+      return COMPRESSION_NONE;
+    }
+
+    // static
+    report_file_sink::compression_type report_file_sink::guess_compression(const std::string & filename_)
+    {
+      const auto ends_with = [&filename_] (const std::string & suffix_)
+        {
+          return filename_.size() >= suffix_.size()
+          && filename_.compare(filename_.size() - suffix_.size(), suffix_.size(), suffix_) == 0;
+        };
+      if (ends_with(".gz")) return COMPRESSION_GZIP;
+      if (ends_with(".zst")) return COMPRESSION_ZSTD;
+      return COMPRESSION_NONE;
+    }
+
+    // static
+    bool report_file_sink::is_supported(const compression_type compression_)
+    {
+#if defined(FALAISE_PROCESSREPORT_WITH_ZSTD)
+      (void) compression_;
+      return true;
+#else
+      return compression_ != COMPRESSION_ZSTD;
+#endif
+    }
+
+    report_file_sink::report_file_sink()
+      : _compression_(COMPRESSION_NONE), _block_size_(65536), _stop_(false), _open_(false),
+        _input_size_(0), _output_size_(0), _failed_(false)
+    {
+      return;
+    }
+
+    report_file_sink::~report_file_sink()
+    {
+      if (is_open()) {
+        try {
+          close();
+        } catch (std::exception & error) {
+          DT_LOG_ERROR(datatools::logger::PRIO_ERROR, error.what());
+        }
+      }
+      return;
+    }
+
+    void report_file_sink::open(const std::string & filename_,
+                                const compression_type compression_,
+                                const size_t block_size_)
+    {
+      DT_THROW_IF(is_open(), std::logic_error, "File sink is already open !");
+      DT_THROW_IF(! is_supported(compression_), std::logic_error,
+                  "Compression of '" << filename_ << "' is not supported by this build !");
+      DT_THROW_IF(block_size_ == 0, std::domain_error, "Invalid null block size !");
+      _file_.clear();
+      _file_.open(filename_.c_str(), std::ios::binary | std::ios::trunc);
+      DT_THROW_IF(! _file_, std::runtime_error, "Cannot open file '" << filename_ << "' !");
+      _filename_    = filename_;
+      _failed_      = false;
+      _error_.clear();
+      _compression_ = compression_;
+      _block_size_  = block_size_;
+      _block_.clear();
+      _block_.reserve(_block_size_);
+      _stop_        = false;
+      _input_size_  = 0;
+      _output_size_ = 0;
+      _open_        = true;
+      _thread_ = std::thread(&report_file_sink::_run_, this);
+      return;
+    }
+
+    bool report_file_sink::is_open() const
+    {
+      return _open_;
+    }
+
+    report_file_sink::int_type report_file_sink::overflow(int_type c_)
+    {
+      if (traits_type::eq_int_type(c_, traits_type::eof())) return traits_type::not_eof(c_);
+      const char c = traits_type::to_char_type(c_);
+      xsputn(&c, 1);
+      return c_;
+    }
+
+    std::streamsize report_file_sink::xsputn(const char * s_, std::streamsize n_)
+    {
+      // A failed sink makes the stream bad
+      if (! _open_ || _failed_) return 0;
+      _block_.append(s_, n_);
+      if (_block_.size() >= _block_size_) _hand_over_();
+      return n_;
+    }
+
+    int report_file_sink::sync()
+    {
+      return 0;
+    }
+
+    void report_file_sink::flush_block()
+    {
+      _hand_over_();
+      _check_error_();
+      return;
+    }
+
+    void report_file_sink::_hand_over_()
+    {
+      if (_block_.empty()) return;
+      std::string a_block;
+      a_block.reserve(_block_size_);
+      a_block.swap(_block_);
+      std::unique_lock<std::mutex> lock(_mutex_);
+      // Slow down the producer if the writer lags behind
+      _drained_.wait(lock, [this] { return _queue_.size() < MAX_QUEUED_BLOCKS; });
+      _input_size_ += a_block.size();
+      _queue_.push_back(std::string());
+      _queue_.back().swap(a_block);
+      _cv_.notify_one();
+      return;
+    }
+
+    void report_file_sink::close()
+    {
+      if (! _open_) return;
+      _hand_over_();
+      {
+        std::lock_guard<std::mutex> lock(_mutex_);
+        _stop_ = true;
+      }
+      _cv_.notify_one();
+      if (_thread_.joinable()) _thread_.join();
+      _file_.close();
+      _open_ = false;
+      _check_error_();
+      DT_THROW_IF(! _file_, std::runtime_error, "Cannot close file '" << _filename_ << "' !");
+      return;
+    }
+
+    void report_file_sink::_check_error_() const
+    {
+      if (! _failed_) return;
+      std::lock_guard<std::mutex> lock(_mutex_);
+      DT_THROW(std::runtime_error, "Report file '" << _filename_ << "' is incomplete: " << _error_);
+    }
+
+    uint64_t report_file_sink::get_input_size() const
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      return _input_size_;
+    }
+
+    uint64_t report_file_sink::get_output_size() const
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      return _output_size_;
+    }
+
+    void report_file_sink::_encode_(const std::string & block_, std::string & encoded_) const
+    {
+      encoded_.clear();
+      if (_compression_ == COMPRESSION_GZIP) {
+        // Concatenated gzip members form a valid gzip file
+        boost::iostreams::filtering_ostream gz;
+        gz.push(boost::iostreams::gzip_compressor());
+        gz.push(boost::iostreams::back_inserter(encoded_));
+        gz.write(block_.data(), block_.size());
+        gz.reset();
+      }
+#if defined(FALAISE_PROCESSREPORT_WITH_ZSTD)
+      else if (_compression_ == COMPRESSION_ZSTD) {
+        // Concatenated zstd frames form a valid zstd file
+        encoded_.resize(ZSTD_compressBound(block_.size()));
+        const size_t size = ZSTD_compress(&encoded_[0], encoded_.size(), block_.data(), block_.size(), 3);
+        DT_THROW_IF(ZSTD_isError(size), std::runtime_error,
+                    "zstd compression failed: " << ZSTD_getErrorName(size) << " !");
+        encoded_.resize(size);
+      }
+#endif
+      else {
+        encoded_ = block_;
+      }
+      return;
+    }
+
+    void report_file_sink::_run_()
+    {
+      std::string a_block;
+      std::string encoded;
+      while (true) {
+        {
+          std::unique_lock<std::mutex> lock(_mutex_);
+          _cv_.wait(lock, [this] { return _stop_ || ! _queue_.empty(); });
+          if (_queue_.empty()) break;
+          a_block.swap(_queue_.front());
+          _queue_.pop_front();
+        }
+        _drained_.notify_one();
+        // After a failure, blocks are dropped so that producers never wait
+        if (_failed_) continue;
+        try {
+          _encode_(a_block, encoded);
+          _file_.write(encoded.data(), encoded.size());
+          _file_.flush();
+          DT_THROW_IF(! _file_, std::runtime_error, "write failed");
+          std::lock_guard<std::mutex> lock(_mutex_);
+          _output_size_ += encoded.size();
+        } catch (std::exception & error) {
+          std::lock_guard<std::mutex> lock(_mutex_);
+          _error_  = error.what();
+          _failed_ = true;
+        }
+      }
+      return;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/report_file_sink.cc
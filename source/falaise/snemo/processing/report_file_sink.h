@@ -0,0 +1,159 @@
+/// \file falaise/snemo/processing/report_file_sink.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Output file sink of the report module. Text is gathered in blocks
+ *   which are handed over to a background thread; each block is written as
+ *   an independent member (gzip) or frame (zstd), or as is without
+ *   compression, and the file is flushed after each of them. A job killed
+ *   in the middle thus leaves a file readable up to its last complete block.
+ *   An error of the writer thread (compression or write failure) stops the
+ *   output: it is rethrown on the caller thread by the next 'flush_block'
+ *   or 'close', and the stream using the sink goes bad.
+ *   zstd support is only built when the library is found at configure time.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REPORT_FILE_SINK_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REPORT_FILE_SINK_H 1
+
+// Standard library
+#include <string>
+#include <deque>
+#include <fstream>
+#include <streambuf>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdint.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Block-compressed file sink written by a background thread
+    class report_file_sink : public std::streambuf
+    {
+    public:
+
+      /// Compression type
+      enum compression_type {
+        COMPRESSION_NONE = 0,
+        COMPRESSION_GZIP = 1,
+        COMPRESSION_ZSTD = 2
+      };
+
+      /// Return the compression from its label ('none', 'gzip' or 'zstd')
+      static compression_type get_compression(const std::string & label_);
+
+      /// Guess the compression from the file extension
+      static compression_type guess_compression(const std::string & filename_);
+
+      /// Check if a compression is supported by this build
+      static bool is_supported(const compression_type compression_);
+
+      /// Constructor
+      report_file_sink();
+
+      /// Destructor
+      virtual ~report_file_sink();
+
+      /// Open the file and start the writer thread
+      void open(const std::string & filename_,
+                const compression_type compression_ = COMPRESSION_NONE,
+                const size_t block_size_ = 65536);
+
+      /// Check if the sink is open
+      bool is_open() const;
+
+      /// Hand the current block over to the writer thread, throw if the
+      /// writer thread has failed
+      void flush_block();
+
+      /// Write all pending blocks, stop the writer thread and close the
+      /// file, throw if the writer thread has failed
+      void close();
+
+      /// Return the number of bytes received
+      uint64_t get_input_size() const;
+
+      /// Return the number of bytes written to the file
+      uint64_t get_output_size() const;
+
+    protected:
+
+      /// Append a character to the current block
+      virtual int_type overflow(int_type c_);
+
+      /// Append characters to the current block
+      virtual std::streamsize xsputn(const char * s_, std::streamsize n_);
+
+      /// Text is only handed over by blocks: nothing to do on stream flush
+      virtual int sync();
+
+    private:
+
+      /// Hand the current block over to the writer thread
+      void _hand_over_();
+
+      /// Throw the error of the writer thread if any
+      void _check_error_() const;
+
+      /// Writer thread loop
+      void _run_();
+
+      /// Compress a block into a member/frame
+      void _encode_(const std::string & block_, std::string & encoded_) const;
+
+    private:
+
+      std::string _filename_;                //!< Output file name
+      std::ofstream _file_;                  //!< Output file
+      compression_type _compression_;        //!< Compression type
+      size_t _block_size_;                   //!< Block size
+      std::string _block_;                   //!< Block being filled
+      std::thread _thread_;                  //!< Writer thread
+      mutable std::mutex _mutex_;            //!< Protect the queue and sizes
+      std::condition_variable _cv_;          //!< Wake up the writer thread
+      std::condition_variable _drained_;     //!< Wake up a producer waiting for room
+      std::deque<std::string> _queue_;       //!< Blocks waiting to be written
+      bool _stop_;                           //!< Stop request
+      bool _open_;                           //!< Open flag
+      uint64_t _input_size_;                 //!< Number of bytes received
+      uint64_t _output_size_;                //!< Number of bytes written
+      std::atomic<bool> _failed_;            //!< The writer thread has failed
+      std::string _error_;                   //!< Error of the writer thread
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REPORT_FILE_SINK_H
+
+// end of falaise/snemo/processing/report_file_sink.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,200 @@
+/// \file falaise/snemo/processing/report_snapshot.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/report_snapshot.h>
+
+// Standard library:
+#include <cstring>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      /// Type and size words at the start of every record
+      const size_t RECORD_HEADER_SIZE = 8;
+
+      /// Fixed part of a counters record after its header
+      const size_t COUNTERS_FIXED_SIZE = 56;
+
+      size_t padded(const size_t size_)
+      {
+        return (size_ + 7) / 8 * 8;
+      }
+
+      template <typename T>
+      char * put(char * room_, const T value_)
+      {
+        std::memcpy(room_, &value_, sizeof(T));
+        return room_ + sizeof(T);
+      }
+
+      template <typename T>
+      const char * get(const char * data_, T & value_)
+      {
+        std::memcpy(&value_, data_, sizeof(T));
+        return data_ + sizeof(T);
+      }
+
+    }
+
+    report_snapshot::report_snapshot()
+    {
+      sequence          = 0;
+      last              = false;
+      elapsed           = 0.0;
+      events            = 0;
+      job_events        = 0;
+      throughput        = 0.0;
+      recent_throughput = 0.0;
+      return;
+    }
+
+    size_t report_snapshot::get_number_of_cuts() const
+    {
+      return counters.size() / COUNTERS_PER_CUT;
+    }
+
+    int report_snapshot::find_cut(const std::string & name_) const
+    {
+      if (! cut_names) return -1;
+      for (size_t i = 0; i < cut_names->size(); i++) {
+        if ((*cut_names)[i] == name_) return i;
+      }
+      return -1;
+    }
+
+    uint64_t report_snapshot::get_processed(const size_t index_) const
+    {
+      DT_THROW_IF(index_ >= get_number_of_cuts(), std::range_error, "Invalid cut index " << index_ << " !");
+      return counters[index_ * COUNTERS_PER_CUT];
+    }
+
+    uint64_t report_snapshot::get_accepted(const size_t index_) const
+    {
+      DT_THROW_IF(index_ >= get_number_of_cuts(), std::range_error, "Invalid cut index " << index_ << " !");
+      return counters[index_ * COUNTERS_PER_CUT + 1];
+    }
+
+    uint64_t report_snapshot::get_rejected(const size_t index_) const
+    {
+      DT_THROW_IF(index_ >= get_number_of_cuts(), std::range_error, "Invalid cut index " << index_ << " !");
+      return counters[index_ * COUNTERS_PER_CUT + 2];
+    }
+
+    double report_snapshot::get_efficiency(const size_t index_) const
+    {
+      const uint64_t processed = get_processed(index_);
+      return processed > 0 ? (double) get_accepted(index_) / processed : 0.0;
+    }
+
+    // static
+    size_t report_snapshot::get_names_record_size(const std::vector<std::string> & names_)
+    {
+      size_t size = RECORD_HEADER_SIZE + sizeof(uint32_t);
+      for (size_t i = 0; i < names_.size(); i++) size += sizeof(uint32_t) + names_[i].size();
+      return padded(size);
+    }
+
+    // static
+    void report_snapshot::encode_names_record(const std::vector<std::string> & names_, char * room_)
+    {
+      const size_t size = get_names_record_size(names_);
+      char * p = room_;
+      p = put<uint32_t>(p, RECORD_CUT_NAMES);
+      p = put<uint32_t>(p, size);
+      p = put<uint32_t>(p, names_.size());
+      for (size_t i = 0; i < names_.size(); i++) {
+        p = put<uint32_t>(p, names_[i].size());
+        std::memcpy(p, names_[i].data(), names_[i].size());
+        p += names_[i].size();
+      }
+      std::memset(p, 0, room_ + size - p);
+      return;
+    }
+
+    size_t report_snapshot::get_counters_record_size() const
+    {
+      return RECORD_HEADER_SIZE + COUNTERS_FIXED_SIZE + counters.size() * sizeof(uint64_t);
+    }
+
+    void report_snapshot::encode_counters_record(char * room_) const
+    {
+      char * p = room_;
+      p = put<uint32_t>(p, RECORD_COUNTERS);
+      p = put<uint32_t>(p, get_counters_record_size());
+      p = put<uint64_t>(p, sequence);
+      p = put<uint32_t>(p, last ? 1 : 0);
+      p = put<uint32_t>(p, get_number_of_cuts());
+      p = put<double>(p, elapsed);
+      p = put<uint64_t>(p, events);
+      p = put<uint64_t>(p, job_events);
+      p = put<double>(p, throughput);
+      p = put<double>(p, recent_throughput);
+      if (! counters.empty()) std::memcpy(p, &counters[0], counters.size() * sizeof(uint64_t));
+      return;
+    }
+
+    // static
+    bool report_snapshot::decode_log(const std::string & data_, std::vector<report_snapshot> & snapshots_)
+    {
+      std::shared_ptr<const std::vector<std::string> > names;
+      size_t offset = 0;
+      while (offset < data_.size()) {
+        if (data_.size() - offset < RECORD_HEADER_SIZE) return false;
+        const char * p = data_.data() + offset;
+        uint32_t type = 0, size = 0;
+        p = get(p, type);
+        p = get(p, size);
+        if (size < RECORD_HEADER_SIZE || size % 8 != 0 || size > data_.size() - offset) return false;
+        const char * end = data_.data() + offset + size;
+        if (type == RECORD_CUT_NAMES) {
+          if (end - p < 4) return false;
+          uint32_t ncuts = 0;
+          p = get(p, ncuts);
+          std::shared_ptr<std::vector<std::string> > a_names = std::make_shared<std::vector<std::string> >();
+          for (uint32_t i = 0; i < ncuts; i++) {
+            uint32_t length = 0;
+            if (end - p < 4) return false;
+            p = get(p, length);
+            if ((size_t) (end - p) < length) return false;
+            a_names->push_back(std::string(p, length));
+            p += length;
+          }
+          names = a_names;
+        } else if (type == RECORD_COUNTERS) {
+          if ((size_t) (end - p) < COUNTERS_FIXED_SIZE) return false;
+          report_snapshot a_snapshot;
+          uint32_t last = 0, ncuts = 0;
+          p = get(p, a_snapshot.sequence);
+          p = get(p, last);
+          p = get(p, ncuts);
+          p = get(p, a_snapshot.elapsed);
+          p = get(p, a_snapshot.events);
+          p = get(p, a_snapshot.job_events);
+          p = get(p, a_snapshot.throughput);
+          p = get(p, a_snapshot.recent_throughput);
+          if ((size_t) (end - p) != ncuts * COUNTERS_PER_CUT * sizeof(uint64_t)) return false;
+          a_snapshot.last = (last != 0);
+          a_snapshot.counters.resize(ncuts * COUNTERS_PER_CUT);
+          if (ncuts > 0) std::memcpy(&a_snapshot.counters[0], p, end - p);
+          a_snapshot.cut_names = names;
+          snapshots_.push_back(a_snapshot);
+        }
+        // Unknown record types are skipped
+        offset += size;
+      }
+      return true;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/report_snapshot.cc
@@ -0,0 +1,126 @@
+/// \file falaise/snemo/processing/report_snapshot.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Immutable snapshot of the statistics of a process report module, meant
+ *   to be read by other modules of the pipeline (prescalers, output
+ *   splitters...) from any thread. The report module publishes a new
+ *   snapshot every few events by swapping a shared pointer: readers keep
+ *   the snapshot they acquired alive for as long as they need it and
+ *   never see a partially updated one.
+ *
+ *   Cut names are shared by all the snapshots of a job, only the counters
+ *   are copied at each publication.
+ *
+ *   Snapshots can also be logged as binary records for external tools: a
+ *   cut names record is written once, then a counters record per snapshot.
+ *   Each record starts with its type and its size (two 32-bit words) and is
+ *   padded to 8 bytes. Records are encoded directly into the room given by
+ *   the caller, e.g. a memory-mapped report file.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REPORT_SNAPSHOT_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REPORT_SNAPSHOT_H 1
+
+// Standard library
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Immutable snapshot of the process report statistics
+    struct report_snapshot
+    {
+      /// Counters per cut: processed, accepted and rejected entries
+      static const size_t COUNTERS_PER_CUT = 3;
+
+      /// Binary record type
+      enum record_type {
+        RECORD_CUT_NAMES = 1,
+        RECORD_COUNTERS  = 2
+      };
+
+      /// Default constructor
+      report_snapshot();
+
+      /// Return the number of cuts
+      size_t get_number_of_cuts() const;
+
+      /// Return the index of a cut, -1 if the cut is not followed
+      int find_cut(const std::string & name_) const;
+
+      /// Return the number of entries processed by a cut
+      uint64_t get_processed(const size_t index_) const;
+
+      /// Return the number of entries accepted by a cut
+      uint64_t get_accepted(const size_t index_) const;
+
+      /// Return the number of entries rejected by a cut
+      uint64_t get_rejected(const size_t index_) const;
+
+      /// Return the efficiency of a cut, null when nothing was processed
+      double get_efficiency(const size_t index_) const;
+
+      /// Return the size of the cut names record
+      static size_t get_names_record_size(const std::vector<std::string> & names_);
+
+      /// Encode the cut names record into a room of 'get_names_record_size' bytes
+      static void encode_names_record(const std::vector<std::string> & names_, char * room_);
+
+      /// Return the size of the counters record of this snapshot
+      size_t get_counters_record_size() const;
+
+      /// Encode the counters record into a room of 'get_counters_record_size' bytes
+      void encode_counters_record(char * room_) const;
+
+      /// Decode a log of records, return false if it is corrupted. Complete
+      /// records before the corruption are kept.
+      static bool decode_log(const std::string & data_, std::vector<report_snapshot> & snapshots_);
+
+      uint64_t sequence;          //!< Publication number, starting at 0
+      bool last;                  //!< Published at the end of the job
+      double elapsed;             //!< Time since the module initialization (s)
+      uint64_t events;            //!< Number of events, resumed ones included
+      uint64_t job_events;        //!< Number of events processed by this job
+      double throughput;          //!< Mean throughput of this job (Hz)
+      double recent_throughput;   //!< Throughput since the previous snapshot (Hz)
+      std::shared_ptr<const std::vector<std::string> > cut_names; //!< Followed cuts
+      std::vector<uint64_t> counters; //!< COUNTERS_PER_CUT counters per cut, this job only
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_REPORT_SNAPSHOT_H
+
+// end of falaise/snemo/processing/report_snapshot.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,333 @@
+/// \file falaise/snemo/processing/resource_sampler.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/resource_sampler.h>
+
+// Standard library:
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/exception.h>
+
+// System:
+#include <time.h>
+#include <unistd.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace {
+
+      int64_t steady_ns()
+      {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>
+          (std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+
+      /// Check if the kernel accounts for the block I/O delay of tasks
+      bool has_delay_accounting()
+      {
+        // Kernels before 5.14 have no switch and account by default
+        std::ifstream sysctl("/proc/sys/kernel/task_delayacct");
+        if (! sysctl) return true;
+        int enabled = 0;
+        return (sysctl >> enabled) && enabled != 0;
+      }
+
+      /// Difference of two samples per unit of time
+      double rate(const double delta_, const double dt_)
+      {
+        return dt_ > 0.0 ? delta_ / dt_ : 0.0;
+      }
+
+    }
+
+    void resource_sampler::set_initialized(const bool initialized_)
+    {
+      _initialized_ = initialized_;
+      return;
+    }
+
+    bool resource_sampler::is_initialized() const
+    {
+      return _initialized_;
+    }
+
+    void resource_sampler::set_logging_priority(const datatools::logger::priority priority_)
+    {
+      _logging_priority_ = priority_;
+      return;
+    }
+
+    datatools::logger::priority resource_sampler::get_logging_priority() const
+    {
+      return _logging_priority_;
+    }
+
+    resource_sampler::resource_sampler()
+    {
+      _set_defaults();
+      return;
+    }
+
+    resource_sampler::~resource_sampler()
+    {
+      if (is_initialized()) {
+        reset();
+      }
+      return;
+    }
+
+    void resource_sampler::_set_defaults()
+    {
+      _initialized_      = false;
+      _logging_priority_ = datatools::logger::PRIO_WARNING;
+      _interval_         = 1.0;
+      _max_samples_      = 1024;
+      _timeline_rows_    = 20;
+      _delay_accounting_ = false;
+      _start_ns_         = 0;
+      _events_.store(0);
+      _samples_.clear();
+      _stop_             = false;
+      return;
+    }
+
+    void resource_sampler::initialize(const datatools::properties & setup_)
+    {
+      DT_THROW_IF(is_initialized(), std::logic_error, "Resource sampler is already initialized !");
+
+      // Logging priority
+      datatools::logger::priority lp = datatools::logger::extract_logging_configuration(setup_);
+      DT_THROW_IF(lp == datatools::logger::PRIO_UNDEFINED,
+                  std::logic_error,
+                  "Invalid logging priority level for resource sampler !");
+      set_logging_priority(lp);
+
+      if (setup_.has_key("interval")) {
+        _interval_ = setup_.fetch_real("interval");
+        DT_THROW_IF(_interval_ <= 0.0, std::domain_error,
+                    "Invalid sampling interval " << _interval_ << " !");
+      }
+
+      if (setup_.has_key("max_samples")) {
+        const int n = setup_.fetch_integer("max_samples");
+        DT_THROW_IF(n < 4, std::domain_error, "At least 4 samples must be kept !");
+        _max_samples_ = n;
+      }
+
+      if (setup_.has_key("timeline_rows")) {
+        const int n = setup_.fetch_integer("timeline_rows");
+        DT_THROW_IF(n < 0, std::domain_error, "Invalid number of timeline rows " << n << " !");
+        _timeline_rows_ = n;
+      }
+
+      _delay_accounting_ = has_delay_accounting();
+      if (! _delay_accounting_) {
+        DT_LOG_NOTICE(get_logging_priority(), "Kernel delay accounting is disabled "
+                      "(kernel.task_delayacct): block I/O wait is not available");
+      }
+      _start_ns_ = steady_ns();
+      _samples_.reserve(_max_samples_);
+      _add_sample_();
+      _stop_ = false;
+      _thread_ = std::thread(&resource_sampler::_run_, this);
+      set_initialized(true);
+      return;
+    }
+
+    void resource_sampler::reset()
+    {
+      DT_THROW_IF(! is_initialized(), std::logic_error, "Resource sampler is not initialized !");
+      stop();
+      _set_defaults();
+      return;
+    }
+
+    void resource_sampler::count_event()
+    {
+      _events_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    void resource_sampler::stop()
+    {
+      if (! _thread_.joinable()) return;
+      {
+        std::lock_guard<std::mutex> lock(_mutex_);
+        _stop_ = true;
+      }
+      _cv_.notify_one();
+      _thread_.join();
+      _add_sample_();
+      return;
+    }
+
+    void resource_sampler::_run_()
+    {
+      const std::chrono::nanoseconds interval((int64_t) (1e9 * _interval_));
+      std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now() + interval;
+      std::unique_lock<std::mutex> lock(_mutex_);
+      while (! _stop_) {
+        if (_cv_.wait_until(lock, next, [this] { return _stop_; })) break;
+        lock.unlock();
+        _add_sample_();
+        lock.lock();
+        next += interval;
+      }
+      return;
+    }
+
+    void resource_sampler::_read_(sample_type & sample_) const
+    {
+      sample_.time   = 1e-9 * (steady_ns() - _start_ns_);
+      sample_.events = _events_.load(std::memory_order_relaxed);
+      sample_.read_bytes = sample_.write_bytes = sample_.rchar = sample_.wchar = 0;
+      sample_.io_wait = sample_.run_wait = 0.0;
+
+      {
+        std::ifstream io("/proc/self/io");
+        std::string key;
+        uint64_t value;
+        while (io >> key >> value) {
+          if (key == "rchar:") sample_.rchar = value;
+          else if (key == "wchar:") sample_.wchar = value;
+          else if (key == "read_bytes:") sample_.read_bytes = value;
+          else if (key == "write_bytes:") sample_.write_bytes = value;
+        }
+      }
+
+      {
+        // Fields after the command name, which may contain spaces: the
+        // aggregated block I/O delay is the 42nd field
+        std::ifstream stat("/proc/self/stat");
+        std::string line;
+        std::getline(stat, line);
+        const size_t end_of_name = line.rfind(')');
+        if (end_of_name != std::string::npos) {
+          std::istringstream fields(line.substr(end_of_name + 1));
+          std::string field;
+          for (int i = 3; fields >> field; i++) {
+            if (i == 42) {
+              sample_.io_wait = std::strtod(field.c_str(), 0) / ::sysconf(_SC_CLK_TCK);
+              break;
+            }
+          }
+        }
+      }
+
+      {
+        std::ifstream schedstat("/proc/self/schedstat");
+        uint64_t run_ns = 0, wait_ns = 0;
+        if (schedstat >> run_ns >> wait_ns) sample_.run_wait = 1e-9 * wait_ns;
+      }
+
+      struct timespec ts;
+      ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+      sample_.cpu = ts.tv_sec + 1e-9 * ts.tv_nsec;
+      return;
+    }
+
+    void resource_sampler::_add_sample_()
+    {
+      sample_type a_sample;
+      _read_(a_sample);
+      std::lock_guard<std::mutex> lock(_mutex_);
+      if (_samples_.size() == _max_samples_) {
+        // Halve the resolution, keeping the first and the last samples
+        size_t n = 0;
+        for (size_t i = 0; i < _samples_.size(); i += 2) _samples_[n++] = _samples_[i];
+        _samples_.resize(n);
+      }
+      _samples_.push_back(a_sample);
+      return;
+    }
+
+    void resource_sampler::get_samples(std::vector<sample_type> & samples_) const
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      samples_ = _samples_;
+      return;
+    }
+
+    void resource_sampler::report(std::ostream & out_)
+    {
+      std::vector<sample_type> samples;
+      get_samples(samples);
+      if (_thread_.joinable()) {
+        // Include the time since the last sample
+        sample_type a_sample;
+        _read_(a_sample);
+        samples.push_back(a_sample);
+      }
+      if (samples.size() < 2) return;
+
+      const std::ios::fmtflags flags = out_.flags();
+      const std::streamsize precision = out_.precision();
+      const sample_type & first = samples.front();
+      const sample_type & last  = samples.back();
+      const double dt = last.time - first.time;
+      out_ << "Resource usage over " << std::fixed << std::setprecision(1) << dt << " s" << std::endl;
+      out_ << " ↳ Throughput        : " << rate(last.events - first.events, dt) << " Hz" << std::endl;
+      out_ << " ↳ Storage read      : " << std::setprecision(3)
+           << 1e-6 * rate(last.read_bytes - first.read_bytes, dt) << " MB/s ("
+           << 1e-6 * rate(last.rchar - first.rchar, dt) << " MB/s through read calls)" << std::endl;
+      out_ << " ↳ Storage write     : "
+           << 1e-6 * rate(last.write_bytes - first.write_bytes, dt) << " MB/s ("
+           << 1e-6 * rate(last.wchar - first.wchar, dt) << " MB/s through write calls)" << std::endl;
+      out_ << std::setprecision(1);
+      out_ << " ↳ CPU utilization   : " << 100.0 * rate(last.cpu - first.cpu, dt) << " %" << std::endl;
+      out_ << " ↳ Block I/O wait    : ";
+      if (_delay_accounting_) {
+        out_ << 100.0 * rate(last.io_wait - first.io_wait, dt) << " %" << std::endl;
+      } else {
+        out_ << "n/a (kernel.task_delayacct is disabled)" << std::endl;
+      }
+      out_ << " ↳ Run queue wait    : " << 100.0 * rate(last.run_wait - first.run_wait, dt) << " %" << std::endl;
+
+      if (_timeline_rows_ > 0) {
+        out_ << " ↳ Timeline" << std::endl;
+        out_ << "   " << std::setw(10) << "time (s)" << std::setw(12) << "events/s"
+             << std::setw(8) << "CPU %" << std::setw(10) << "I/O wt %"
+             << std::setw(12) << "read MB/s" << std::setw(12) << "write MB/s" << std::endl;
+        const size_t nrows = std::min(_timeline_rows_, samples.size() - 1);
+        size_t previous = 0;
+        for (size_t row = 1; row <= nrows; row++) {
+          const size_t current = row * (samples.size() - 1) / nrows;
+          const sample_type & a = samples[previous];
+          const sample_type & b = samples[current];
+          const double t = b.time - a.time;
+          out_ << "   " << std::setprecision(1) << std::setw(10) << b.time
+               << std::setw(12) << rate(b.events - a.events, t)
+               << std::setw(8) << 100.0 * rate(b.cpu - a.cpu, t)
+               << std::setw(10);
+          if (_delay_accounting_) {
+            out_ << 100.0 * rate(b.io_wait - a.io_wait, t);
+          } else {
+            out_ << "n/a";
+          }
+          out_ << std::setprecision(3)
+               << std::setw(12) << 1e-6 * rate(b.read_bytes - a.read_bytes, t)
+               << std::setw(12) << 1e-6 * rate(b.write_bytes - a.write_bytes, t) << std::endl;
+          previous = current;
+        }
+      }
+      out_.flags(flags);
+      out_.precision(precision);
+      return;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/resource_sampler.cc
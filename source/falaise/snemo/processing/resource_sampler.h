@@ -0,0 +1,163 @@
+/// \file falaise/snemo/processing/resource_sampler.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Background sampler of the process resources: bytes read and written
+ *   (/proc/self/io), block I/O delay (/proc/self/stat, needs the kernel
+ *   delay accounting, reported as not available when kernel.task_delayacct
+ *   is off), run queue wait of the main thread
+ *   (/proc/self/schedstat) and process CPU time. A sampler thread reads
+ *   them at a fixed interval together with an atomic event counter, so
+ *   that the only work left to the event thread is to increment this
+ *   counter.
+ *
+ *   Samples are cumulative values: when the timeline is full, every other
+ *   sample is dropped, which keeps the memory bounded and the totals
+ *   exact while halving the time resolution.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_RESOURCE_SAMPLER_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_RESOURCE_SAMPLER_H 1
+
+// Standard library
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/datatools
+#include <bayeux/datatools/logger.h>
+
+namespace datatools {
+  class properties;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Background sampler of I/O and CPU usage
+    class resource_sampler
+    {
+    public:
+
+      /// Cumulative resource usage at a given time
+      struct sample_type
+      {
+        double time;            //!< Time since the start (s)
+        uint64_t events;        //!< Number of processed events
+        uint64_t read_bytes;    //!< Bytes read (storage layer)
+        uint64_t write_bytes;   //!< Bytes written (storage layer)
+        uint64_t rchar;         //!< Bytes read (all read calls)
+        uint64_t wchar;         //!< Bytes written (all write calls)
+        double cpu;             //!< Process CPU time (s)
+        double io_wait;         //!< Block I/O delay (s)
+        double run_wait;        //!< Run queue wait of the main thread (s)
+      };
+
+      /// Setting initialization flag
+      void set_initialized(const bool initialized_);
+
+      /// Getting initialization flag
+      bool is_initialized() const;
+
+      /// Setting logging priority
+      void set_logging_priority(const datatools::logger::priority priority_);
+
+      /// Getting logging priority
+      datatools::logger::priority get_logging_priority() const;
+
+      /// Constructor:
+      resource_sampler();
+
+      /// Destructor:
+      ~resource_sampler();
+
+      /// Initialize the sampler through configuration properties and start
+      /// the sampler thread
+      void initialize(const datatools::properties & setup_);
+
+      /// Stop the sampler thread and reset
+      void reset();
+
+      /// Count a processed event (event thread)
+      void count_event();
+
+      /// Stop the sampler thread after a last sample
+      void stop();
+
+      /// Return a copy of the timeline
+      void get_samples(std::vector<sample_type> & samples_) const;
+
+      /// Main report method
+      void report(std::ostream & out_);
+
+    protected:
+
+      /// Set default values to class members:
+      void _set_defaults();
+
+    private:
+
+      /// Read the current resource usage
+      void _read_(sample_type & sample_) const;
+
+      /// Add a sample to the timeline
+      void _add_sample_();
+
+      /// Sampler thread loop
+      void _run_();
+
+    private:
+
+      bool _initialized_;                             //!< Initialize flag
+      datatools::logger::priority _logging_priority_; //!< Logging flag
+      double _interval_;                              //!< Sampling interval (s)
+      size_t _max_samples_;                           //!< Maximum number of samples
+      size_t _timeline_rows_;                         //!< Number of rows of the reported timeline
+      bool _delay_accounting_;                        //!< Block I/O delay is accounted by the kernel
+      int64_t _start_ns_;                             //!< Start time
+      std::atomic<uint64_t> _events_;                 //!< Number of processed events
+      std::vector<sample_type> _samples_;             //!< Timeline
+      mutable std::mutex _mutex_;                     //!< Protect the timeline and the stop request
+      std::condition_variable _cv_;                   //!< Wake up the sampler thread
+      std::thread _thread_;                           //!< Sampler thread
+      bool _stop_;                                    //!< Stop request
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_RESOURCE_SAMPLER_H
+
+// end of falaise/snemo/processing/resource_sampler.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
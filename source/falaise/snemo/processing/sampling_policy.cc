@@ -0,0 +1,187 @@
+/// \file falaise/snemo/processing/sampling_policy.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/sampling_policy.h>
+
+// Standard library:
+#include <sstream>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    sampling_policy::sampling_policy()
+    {
+      reset();
+      return;
+    }
+
+    void sampling_policy::reset()
+    {
+      _mode_           = MODE_ALL;
+      _every_          = 1;
+      _probability_    = 1.0;
+      _reservoir_size_ = 0;
+      _rng_.seed(0);
+      _events_         = 0;
+      _sampled_        = 0;
+      _since_sample_   = 0;
+      _weight_         = 0;
+      _slot_           = 0;
+      return;
+    }
+
+    void sampling_policy::initialize(const datatools::properties & setup_)
+    {
+      reset();
+
+      if (setup_.has_key("mode")) {
+        const std::string mode = setup_.fetch_string("mode");
+        if (mode == "all") {
+          _mode_ = MODE_ALL;
+        } else if (mode == "every") {
+          _mode_ = MODE_EVERY;
+        } else if (mode == "bernoulli") {
+          _mode_ = MODE_BERNOULLI;
+        } else if (mode == "reservoir") {
+          _mode_ = MODE_RESERVOIR;
+        } else {
+          DT_THROW_IF(true, std::logic_error, "Invalid sampling mode '" << mode << "' !");
+        }
+      }
+
+      if (_mode_ == MODE_EVERY) {
+        DT_THROW_IF(! setup_.has_key("every"), std::logic_error, "Missing 'every' sampling period !");
+        const int every = setup_.fetch_integer("every");
+        DT_THROW_IF(every < 1, std::domain_error, "Invalid sampling period " << every << " !");
+        _every_ = every;
+      }
+
+      if (_mode_ == MODE_BERNOULLI) {
+        DT_THROW_IF(! setup_.has_key("probability"), std::logic_error, "Missing sampling 'probability' !");
+        _probability_ = setup_.fetch_real("probability");
+        DT_THROW_IF(_probability_ <= 0.0 || _probability_ > 1.0, std::domain_error,
+                    "Invalid sampling probability " << _probability_ << " !");
+      }
+
+      if (_mode_ == MODE_RESERVOIR) {
+        DT_THROW_IF(! setup_.has_key("reservoir_size"), std::logic_error, "Missing 'reservoir_size' !");
+        const int size = setup_.fetch_integer("reservoir_size");
+        DT_THROW_IF(size < 1, std::domain_error, "Invalid reservoir size " << size << " !");
+        _reservoir_size_ = size;
+      }
+
+      if (setup_.has_key("seed")) {
+        _rng_.seed(setup_.fetch_integer("seed"));
+      }
+      return;
+    }
+
+    sampling_policy::mode_type sampling_policy::get_mode() const
+    {
+      return _mode_;
+    }
+
+    bool sampling_policy::is_estimate() const
+    {
+      return _mode_ != MODE_ALL;
+    }
+
+    size_t sampling_policy::get_reservoir_size() const
+    {
+      return _reservoir_size_;
+    }
+
+    bool sampling_policy::sample()
+    {
+      _events_++;
+      _since_sample_++;
+      bool sampled = false;
+      switch (_mode_) {
+      case MODE_ALL:
+        sampled = true;
+        break;
+      case MODE_EVERY:
+        sampled = (_since_sample_ >= _every_);
+        break;
+      case MODE_BERNOULLI:
+        sampled = (std::generate_canonical<double, 53>(_rng_) < _probability_);
+        break;
+      case MODE_RESERVOIR:
+        // Algorithm R: the n-th event replaces a random slot with probability K/n
+        if (_events_ <= _reservoir_size_) {
+          sampled = true;
+          _slot_  = _events_ - 1;
+        } else {
+          const uint64_t j = std::uniform_int_distribution<uint64_t>(0, _events_ - 1)(_rng_);
+          if (j < _reservoir_size_) {
+            sampled = true;
+            _slot_  = j;
+          }
+        }
+        break;
+      }
+      if (sampled) {
+        _sampled_++;
+        _weight_ = _since_sample_;
+        _since_sample_ = 0;
+      }
+      return sampled;
+    }
+
+    uint64_t sampling_policy::get_weight() const
+    {
+      return _weight_;
+    }
+
+    size_t sampling_policy::get_slot() const
+    {
+      return _slot_;
+    }
+
+    uint64_t sampling_policy::get_number_of_events() const
+    {
+      return _events_;
+    }
+
+    uint64_t sampling_policy::get_number_of_sampled_events() const
+    {
+      return _sampled_;
+    }
+
+    double sampling_policy::get_scale() const
+    {
+      return _sampled_ > 0 ? (double) _events_ / _sampled_ : 0.0;
+    }
+
+    std::string sampling_policy::get_description() const
+    {
+      std::ostringstream oss;
+      switch (_mode_) {
+      case MODE_ALL:
+        oss << "all events";
+        break;
+      case MODE_EVERY:
+        oss << "1 event out of " << _every_;
+        break;
+      case MODE_BERNOULLI:
+        oss << "Bernoulli sampling with probability " << _probability_;
+        break;
+      case MODE_RESERVOIR:
+        oss << "reservoir of " << _reservoir_size_ << " events";
+        break;
+      }
+      return oss.str();
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/sampling_policy.cc
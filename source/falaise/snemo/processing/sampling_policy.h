@@ -0,0 +1,127 @@
+/// \file falaise/snemo/processing/sampling_policy.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Event sampling policy of an expensive report driver: every event,
+ *   one event out of N, Bernoulli sampling with a seeded generator, or
+ *   reservoir sampling of K events (each event ends up in the reservoir
+ *   with the same probability K/N). Sampled events carry the number of
+ *   events they stand for, so that driver results can be scaled.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_SAMPLING_POLICY_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_SAMPLING_POLICY_H 1
+
+// Standard library
+#include <string>
+#include <random>
+#include <stdint.h>
+
+namespace datatools {
+  class properties;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    /// \brief Event sampling policy
+    class sampling_policy
+    {
+    public:
+
+      /// Sampling mode
+      enum mode_type {
+        MODE_ALL       = 0,
+        MODE_EVERY     = 1,
+        MODE_BERNOULLI = 2,
+        MODE_RESERVOIR = 3
+      };
+
+      /// Constructor
+      sampling_policy();
+
+      /// Configure the policy from properties ('mode', 'every', 'probability',
+      /// 'reservoir_size' and 'seed' keys)
+      void initialize(const datatools::properties & setup_);
+
+      /// Reset the policy
+      void reset();
+
+      /// Return the sampling mode
+      mode_type get_mode() const;
+
+      /// Check if results are estimated from a subset of events
+      bool is_estimate() const;
+
+      /// Return the reservoir size (reservoir mode)
+      size_t get_reservoir_size() const;
+
+      /// Decide if the current event is sampled
+      bool sample();
+
+      /// Return the number of events represented by the last sampled event,
+      /// i.e. the number of events since the previous sampled one
+      uint64_t get_weight() const;
+
+      /// Return the reservoir slot of the last sampled event (reservoir mode)
+      size_t get_slot() const;
+
+      /// Return the number of seen events
+      uint64_t get_number_of_events() const;
+
+      /// Return the number of sampled events
+      uint64_t get_number_of_sampled_events() const;
+
+      /// Return the factor scaling sampled quantities to all events
+      double get_scale() const;
+
+      /// Return a short description of the policy
+      std::string get_description() const;
+
+    private:
+
+      mode_type _mode_;            //!< Sampling mode
+      uint64_t _every_;            //!< Sampling period (every mode)
+      double _probability_;        //!< Sampling probability (Bernoulli mode)
+      size_t _reservoir_size_;     //!< Reservoir size (reservoir mode)
+      std::mt19937_64 _rng_;       //!< Random generator
+      uint64_t _events_;           //!< Number of seen events
+      uint64_t _sampled_;          //!< Number of sampled events
+      uint64_t _since_sample_;     //!< Number of events since the last sampled one
+      uint64_t _weight_;           //!< Weight of the last sampled event
+      size_t _slot_;               //!< Reservoir slot of the last sampled event
+    };
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_SAMPLING_POLICY_H
+
+// end of falaise/snemo/processing/sampling_policy.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,187 @@
+/// \file falaise/snemo/processing/state_io.cc
+
+// Ourselves:
+#include <falaise/snemo/processing/state_io.h>
+
+// Standard library:
+#include <cstring>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    state_writer::state_writer()
+    {
+      return;
+    }
+
+    void state_writer::write_uint32(const uint32_t value_)
+    {
+      char bytes[4];
+      for (size_t i = 0; i < 4; i++) bytes[i] = (char) ((value_ >> (8 * i)) & 0xFF);
+      _data_.append(bytes, 4);
+      return;
+    }
+
+    void state_writer::write_uint64(const uint64_t value_)
+    {
+      char bytes[8];
+      for (size_t i = 0; i < 8; i++) bytes[i] = (char) ((value_ >> (8 * i)) & 0xFF);
+      _data_.append(bytes, 8);
+      return;
+    }
+
+    void state_writer::write_int64(const int64_t value_)
+    {
+      write_uint64((uint64_t) value_);
+      return;
+    }
+
+    void state_writer::write_double(const double value_)
+    {
+      uint64_t bits;
+      std::memcpy(&bits, &value_, sizeof(bits));
+      write_uint64(bits);
+      return;
+    }
+
+    void state_writer::write_string(const std::string & value_)
+    {
+      write_uint32((uint32_t) value_.size());
+      _data_.append(value_);
+      return;
+    }
+
+    void state_writer::write_doubles(const std::vector<double> & values_)
+    {
+      write_uint32((uint32_t) values_.size());
+      for (size_t i = 0; i < values_.size(); i++) write_double(values_[i]);
+      return;
+    }
+
+    size_t state_writer::begin_section(const uint32_t tag_)
+    {
+      write_uint32(tag_);
+      const size_t position = _data_.size();
+      write_uint64(0);
+      return position;
+    }
+
+    void state_writer::end_section(const size_t position_)
+    {
+      const uint64_t size = _data_.size() - position_ - 8;
+      for (size_t i = 0; i < 8; i++) _data_[position_ + i] = (char) ((size >> (8 * i)) & 0xFF);
+      return;
+    }
+
+    void state_writer::write_section_header(const uint32_t tag_, const uint64_t size_)
+    {
+      write_uint32(tag_);
+      write_uint64(size_);
+      return;
+    }
+
+    const std::string & state_writer::get_data() const
+    {
+      return _data_;
+    }
+
+    std::string & state_writer::grab_data()
+    {
+      return _data_;
+    }
+
+    state_reader::state_reader(const char * data_, const size_t size_)
+      : _data_(data_), _size_(size_), _position_(0)
+    {
+      return;
+    }
+
+    state_reader::state_reader(const std::string & data_)
+      : _data_(data_.data()), _size_(data_.size()), _position_(0)
+    {
+      return;
+    }
+
+    bool state_reader::at_end() const
+    {
+      return _position_ >= _size_;
+    }
+
+    void state_reader::_require_(const size_t size_) const
+    {
+      DT_THROW_IF(size_ > _size_ - _position_, std::runtime_error,
+                  "Truncated state data (" << size_ << " bytes needed at offset "
+                  << _position_ << " of " << _size_ << ") !");
+      return;
+    }
+
+    uint32_t state_reader::read_uint32()
+    {
+      _require_(4);
+      uint32_t value = 0;
+      for (size_t i = 0; i < 4; i++) value |= (uint32_t) (unsigned char) _data_[_position_ + i] << (8 * i);
+      _position_ += 4;
+      return value;
+    }
+
+    uint64_t state_reader::read_uint64()
+    {
+      _require_(8);
+      uint64_t value = 0;
+      for (size_t i = 0; i < 8; i++) value |= (uint64_t) (unsigned char) _data_[_position_ + i] << (8 * i);
+      _position_ += 8;
+      return value;
+    }
+
+    int64_t state_reader::read_int64()
+    {
+      return (int64_t) read_uint64();
+    }
+
+    double state_reader::read_double()
+    {
+      const uint64_t bits = read_uint64();
+      double value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+
+    std::string state_reader::read_string()
+    {
+      const uint32_t size = read_uint32();
+      _require_(size);
+      std::string value(_data_ + _position_, size);
+      _position_ += size;
+      return value;
+    }
+
+    void state_reader::read_doubles(std::vector<double> & values_)
+    {
+      const uint32_t size = read_uint32();
+      _require_((size_t) size * 8);
+      values_.resize(size);
+      for (size_t i = 0; i < size; i++) values_[i] = read_double();
+      return;
+    }
+
+    state_reader state_reader::read_section(uint32_t & tag_)
+    {
+      tag_ = read_uint32();
+      const uint64_t size = read_uint64();
+      _require_(size);
+      state_reader section(_data_ + _position_, size);
+      _position_ += size;
+      return section;
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+// end of falaise/snemo/processing/state_io.cc
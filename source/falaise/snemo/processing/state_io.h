@@ -0,0 +1,160 @@
+/// \file falaise/snemo/processing/state_io.h
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * Description:
+ *
+ *   Compact binary encoding of the report state used by checkpoints. Values
+ *   are written little-endian whatever the host; the reader checks bounds
+ *   and throws on truncated input.
+ *
+ * History:
+ *
+ */
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_STATE_IO_H
+#define FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_STATE_IO_H 1
+
+// Standard library
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdint.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    /// Immutable encoded blocks shared with a writer thread
+    typedef std::vector<std::shared_ptr<const std::string> > state_block_list;
+
+    /// \brief Binary state writer
+    class state_writer
+    {
+    public:
+
+      /// Constructor
+      state_writer();
+
+      /// Append an unsigned 32 bits integer
+      void write_uint32(const uint32_t value_);
+
+      /// Append an unsigned 64 bits integer
+      void write_uint64(const uint64_t value_);
+
+      /// Append a signed 64 bits integer
+      void write_int64(const int64_t value_);
+
+      /// Append a double
+      void write_double(const double value_);
+
+      /// Append a string
+      void write_string(const std::string & value_);
+
+      /// Append a vector of doubles
+      void write_doubles(const std::vector<double> & values_);
+
+      /// Open a tagged section, return its position for 'end_section'
+      size_t begin_section(const uint32_t tag_);
+
+      /// Close a tagged section
+      void end_section(const size_t position_);
+
+      /// Write the header of a last section whose content, of a given size,
+      /// is appended later to the encoded data
+      void write_section_header(const uint32_t tag_, const uint64_t size_);
+
+      /// Return the encoded data
+      const std::string & get_data() const;
+
+      /// Return a mutable reference to the encoded data
+      std::string & grab_data();
+
+    private:
+
+      std::string _data_; //!< Encoded data
+    };
+
+    /// \brief Binary state reader
+    class state_reader
+    {
+    public:
+
+      /// Constructor
+      state_reader(const char * data_, const size_t size_);
+
+      /// Constructor
+      explicit state_reader(const std::string & data_);
+
+      /// Check if all data has been read
+      bool at_end() const;
+
+      /// Read an unsigned 32 bits integer
+      uint32_t read_uint32();
+
+      /// Read an unsigned 64 bits integer
+      uint64_t read_uint64();
+
+      /// Read a signed 64 bits integer
+      int64_t read_int64();
+
+      /// Read a double
+      double read_double();
+
+      /// Read a string
+      std::string read_string();
+
+      /// Read a vector of doubles
+      void read_doubles(std::vector<double> & values_);
+
+      /// Read the next section header, return a reader on its content
+      state_reader read_section(uint32_t & tag_);
+
+    private:
+
+      /// Check that enough bytes remain
+      void _require_(const size_t size_) const;
+
+    private:
+
+      const char * _data_; //!< Encoded data (not owned)
+      size_t _size_;       //!< Size of the data
+      size_t _position_;   //!< Reading position
+    };
+
+    /// Build a section tag from four characters
+    inline uint32_t make_state_tag(const char a_, const char b_, const char c_, const char d_)
+    {
+      return (uint32_t) (unsigned char) a_
+        | ((uint32_t) (unsigned char) b_ << 8)
+        | ((uint32_t) (unsigned char) c_ << 16)
+        | ((uint32_t) (unsigned char) d_ << 24);
+    }
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_PROCESSING_STATE_IO_H
+
+// end of falaise/snemo/processing/state_io.h
+/*
+** Local Variables: --
+** mode: c++ --
+** c-file-style: "gnu" --
+** tab-width: 2 --
+** End: --
+*/
@@ -0,0 +1,200 @@
+// bench_cut_table_renderer.cxx
+//
+// Compare the cut table renderer with the stream based implementation it
+// replaces in cut_report_driver::_report, on identical synthetic rows.
+//
+// Usage: bench_cut_table_renderer [number of cuts] [number of repetitions] [JSON output file]
+
+// Standard library:
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// This project:
+#include <falaise/snemo/processing/cut_table_renderer.h>
+
+// Ourselves:
+#include "bench_results.h"
+
+typedef snemo::processing::cut_table_renderer renderer_type;
+using snemo::processing::testing::time_ms;
+
+namespace {
+
+  /// Stream based table rendering as formerly done by the cut report driver
+  void legacy_table(const renderer_type::row_list_type & rows_, std::ostream & out_)
+  {
+    const size_t name_width = 25;
+    const size_t nbr_width  = 8;
+    size_t column_width = 0;
+    std::ostringstream hline;
+    for (renderer_type::row_list_type::const_iterator irow = rows_.begin();
+         irow != rows_.end(); ++irow) {
+      const std::string & a_cut_name = *irow->name;
+      const size_t npe = irow->processed;
+      const size_t nae = irow->accepted;
+      const size_t nre = irow->rejected;
+      if (hline.str().empty()) {
+        std::ostringstream oss;
+        oss << npe;
+        column_width = oss.str().size();
+        hline << "+" << std::setfill('-') << std::setw(name_width + 6)
+              << "+" << std::setfill('-') << std::setw(column_width + 3)
+              << "+" << std::setfill('-') << std::setw(column_width + 3)
+              << "+" << std::setfill('-') << std::setw(nbr_width + 4)
+              << "+" << std::setfill('-') << std::setw(column_width + 3)
+              << "+" << std::setfill('-') << std::setw(nbr_width + 4)
+              << "+" << std::endl;
+        out_ << hline.str();
+        out_ << "| " << "Cut name" << std::setw(name_width - 2)
+             << "| " << std::setw(column_width + 3)
+             << "| " << "Accepted" << std::setw(column_width + nbr_width - 1)
+             << "| " << "Rejected" << std::setw(column_width + nbr_width - 2)
+             << "|" << std::endl;
+      }
+      if (irow->group_start) out_ << hline.str();
+      out_.setf(std::ios::internal);
+      if (a_cut_name.size() > name_width) {
+        out_ << "| " << a_cut_name.substr(0, name_width) << "... | ";
+      } else {
+        out_ << "| " << a_cut_name << std::setfill(' ')
+             << std::setw(name_width - a_cut_name.size() + 6) << " | ";
+      }
+      out_.setf(std::ios::fixed);
+      out_ << std::setw(column_width) << npe << " | "
+           << std::setw(column_width) << nae << " | "
+           << std::setw(nbr_width) << std::setprecision(2) << (npe > 0 ? 100.0 * nae/npe : 0) << "% | "
+           << std::setw(column_width) << nre << " | "
+           << std::setw(nbr_width) << std::setprecision(2) << (npe > 0 ? 100.0 * nre/npe : 0) << "% | "
+           << std::endl;
+      if (std::next(irow) == rows_.end()) {
+        out_ << hline.str() << std::endl;
+      }
+    }
+    return;
+  }
+
+  /// Stream based meter rendering as formerly done by the cut report driver
+  void legacy_meter(const renderer_type::row_list_type & rows_, std::ostream & out_)
+  {
+    const std::string indent;
+    auto meter = [] (const size_t percent_)
+      {
+        const size_t sz = 10;
+        const size_t idx = (percent_ == 0 ? 0 : percent_/sz+1);
+        std::string a_meter;
+        for (size_t i = 0; i < sz; i++) {
+          if (i < idx) a_meter += "█";
+          else         a_meter += " ";
+        }
+        return a_meter;
+      };
+    size_t digit = 0;
+    size_t norm = 0;
+    for (renderer_type::row_list_type::const_iterator irow = rows_.begin();
+         irow != rows_.end(); ++irow) {
+      const size_t npe = irow->processed;
+      const size_t nae = irow->accepted;
+      const size_t nre = irow->rejected;
+      if (irow->group_start) {
+        digit = std::ceil(log10(npe+1));
+        norm = npe;
+        out_ << std::endl;
+      }
+      const double pae = (npe > 0 ? 100.0 * nae/norm : 0);
+      const double pre = (npe > 0 ? 100.0 * nre/norm : 0);
+      out_.setf(std::ios::fixed);
+      out_.precision(1);
+      out_ << indent << "Cut '" << *irow->name << "' statistics" << std::endl;
+      out_ << indent << " ↳ " << std::setw(digit)  << npe << " processed entries : "
+           << meter(pae) << " " << std::setw(6) << pae << "% (" << std::right << std::setw(digit) << nae << ") "
+           << meter(pre) << " " << std::setw(6) << pre << "% (" << std::right << std::setw(digit) << nre << ") "
+           << std::endl;
+    }
+    return;
+  }
+
+  /// Build synthetic rows: series of ten cuts with decreasing acceptance
+  void make_rows(const size_t ncuts_,
+                 std::vector<std::string> & names_,
+                 renderer_type::row_list_type & rows_)
+  {
+    names_.resize(ncuts_);
+    rows_.resize(ncuts_);
+    uint64_t seed = 12345;
+    uint64_t processed = 0;
+    for (size_t i = 0; i < ncuts_; i++) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      std::ostringstream oss;
+      oss << "cut_" << i << (i % 7 == 0 ? "_with_a_rather_long_descriptive_name" : "");
+      names_[i] = oss.str();
+      renderer_type::row_type & a_row = rows_[i];
+      a_row.name = &names_[i];
+      a_row.group_start = (i % 10 == 0);
+      if (a_row.group_start) processed = 1000000 + (seed >> 44);
+      a_row.processed = processed;
+      a_row.accepted  = (i % 13 == 0 ? processed / 8 : (seed >> 33) % (processed + 1));
+      a_row.rejected  = processed - a_row.accepted;
+      processed = a_row.accepted;
+    }
+    return;
+  }
+
+}
+
+int main(int argc_, char ** argv_)
+{
+  const size_t ncuts       = (argc_ > 1 ? std::strtoul(argv_[1], 0, 10) : 10000);
+  const size_t repetitions = (argc_ > 2 ? std::strtoul(argv_[2], 0, 10) : 20);
+  const std::string output = (argc_ > 3 ? argv_[3] : "");
+
+  std::vector<std::string> names;
+  renderer_type::row_list_type rows;
+  make_rows(ncuts, names, rows);
+
+  renderer_type renderer;
+  int error_code = EXIT_SUCCESS;
+
+  // Check identical output
+  {
+    std::ostringstream legacy_out, renderer_out;
+    legacy_table(rows, legacy_out);
+    renderer.render_table(rows, renderer_out);
+    if (legacy_out.str() != renderer_out.str()) {
+      std::cerr << "error: table outputs differ !" << std::endl;
+      error_code = EXIT_FAILURE;
+    }
+  }
+  {
+    std::ostringstream legacy_out, renderer_out;
+    legacy_meter(rows, legacy_out);
+    renderer.render_meter(rows, renderer_out);
+    if (legacy_out.str() != renderer_out.str()) {
+      std::cerr << "error: meter outputs differ !" << std::endl;
+      error_code = EXIT_FAILURE;
+    }
+  }
+
+  std::ostringstream sink;
+  const double legacy_table_ms = time_ms([&] { sink.str(""); legacy_table(rows, sink); }, repetitions);
+  const double renderer_table_ms = time_ms([&] { sink.str(""); renderer.render_table(rows, sink); }, repetitions);
+  const double legacy_meter_ms = time_ms([&] { sink.str(""); legacy_meter(rows, sink); }, repetitions);
+  const double renderer_meter_ms = time_ms([&] { sink.str(""); renderer.render_meter(rows, sink); }, repetitions);
+
+  snemo::processing::testing::bench_results results("cut_table_renderer");
+  results.add("cuts", ncuts, "count");
+  results.add("table.legacy", legacy_table_ms, "ms");
+  results.add("table.renderer", renderer_table_ms, "ms");
+  results.add("meter.legacy", legacy_meter_ms, "ms");
+  results.add("meter.renderer", renderer_meter_ms, "ms");
+  if (! results.write(output)) {
+    std::cerr << "error: cannot write results to '" << output << "' !" << std::endl;
+    error_code = EXIT_FAILURE;
+  }
+  return error_code;
+}
@@ -0,0 +1,222 @@
+// bench_process_report_module.cxx
+//
+// Benchmark the process report module and its drivers on a cut manager
+// populated with mock cuts and fed with synthetic events:
+//  - report rendering time per format (tree, table, meter),
+//  - per-event overhead of process_report_module::process,
+//  - initialization time of the module.
+//
+// Usage: bench_process_report_module [options]
+//   --cuts N           number of mock cuts (default: 100)
+//   --separator N      number of cuts per serie, 0 for a single serie (default: 10)
+//   --acceptance A     acceptance of the first cut of a serie (default: 0.95)
+//   --step S           acceptance decrease along a serie (default: 0.05)
+//   --events N         number of synthetic events (default: 100000)
+//   --events-per-run N number of events per run (default: 10000)
+//   --repetitions N    number of repetitions for rendering and initialization (default: 20)
+//   --drivers LIST     comma separated list of drivers (default: CRD)
+//   --output FILE      JSON output file (default: standard output)
+
+// Standard library:
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <unistd.h>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/things.h>
+#include <bayeux/datatools/service_manager.h>
+// - Bayeux/cuts:
+#include <bayeux/cuts/cut_service.h>
+#include <bayeux/cuts/cut_manager.h>
+// - Bayeux/dpp:
+#include <bayeux/dpp/base_module.h>
+
+// This project:
+#include <falaise/snemo/processing/process_report_module.h>
+#include <falaise/snemo/processing/cut_report_driver.h>
+
+// Ourselves:
+#include "bench_results.h"
+#include "mock_cut.h"
+#include "synthetic_event_generator.h"
+
+using snemo::processing::testing::time_ms;
+
+namespace {
+
+  struct options_type
+  {
+    options_type()
+      : events(100000), events_per_run(10000), repetitions(20), drivers("CRD")
+    {}
+    snemo::processing::testing::mock_cut_setup cuts;
+    size_t events;
+    size_t events_per_run;
+    size_t repetitions;
+    std::string drivers;
+    std::string output;
+  };
+
+  bool parse_options(int argc_, char ** argv_, options_type & options_)
+  {
+    for (int i = 1; i < argc_; i++) {
+      const std::string option = argv_[i];
+      if (i + 1 >= argc_) return false;
+      const char * value = argv_[++i];
+      if      (option == "--cuts")           options_.cuts.number_of_cuts   = std::strtoul(value, 0, 10);
+      else if (option == "--separator")      options_.cuts.separator_period = std::strtoul(value, 0, 10);
+      else if (option == "--acceptance")     options_.cuts.first_acceptance = std::strtod(value, 0);
+      else if (option == "--step")           options_.cuts.acceptance_step  = std::strtod(value, 0);
+      else if (option == "--events")         options_.events         = std::strtoul(value, 0, 10);
+      else if (option == "--events-per-run") options_.events_per_run = std::strtoul(value, 0, 10);
+      else if (option == "--repetitions")    options_.repetitions    = std::strtoul(value, 0, 10);
+      else if (option == "--drivers")        options_.drivers        = value;
+      else if (option == "--output")         options_.output         = value;
+      else return false;
+    }
+    return options_.repetitions > 0;
+  }
+
+  /// Temporary directory removed with its files at the end of the scope
+  class temporary_directory
+  {
+  public:
+    explicit temporary_directory(const std::string & pattern_)
+      : _path_(pattern_)
+    {
+      if (mkdtemp(&_path_[0]) == 0) {
+        throw std::runtime_error("cannot create temporary directory");
+      }
+    }
+    ~temporary_directory()
+    {
+      if (DIR * dir = opendir(_path_.c_str())) {
+        while (struct dirent * entry = readdir(dir)) {
+          const std::string name = entry->d_name;
+          if (name != "." && name != "..") unlink((_path_ + "/" + name).c_str());
+        }
+        closedir(dir);
+      }
+      rmdir(_path_.c_str());
+    }
+    const std::string & get_path() const { return _path_; }
+  private:
+    std::string _path_;
+  };
+
+  std::vector<std::string> split(const std::string & list_)
+  {
+    std::vector<std::string> tokens;
+    std::istringstream iss(list_);
+    std::string token;
+    while (std::getline(iss, token, ',')) {
+      if (! token.empty()) tokens.push_back(token);
+    }
+    return tokens;
+  }
+
+}
+
+int main(int argc_, char ** argv_)
+{
+  options_type options;
+  if (! parse_options(argc_, argv_, options)) {
+    std::cerr << "usage: " << argv_[0] << " [--cuts N] [--separator N] [--acceptance A] [--step S] "
+              << "[--events N] [--events-per-run N] [--repetitions N] [--drivers LIST] [--output FILE]"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int error_code = EXIT_SUCCESS;
+  // Reports are written to std::clog by the module: discard them
+  std::ostringstream discard;
+  std::streambuf * clog_buffer = std::clog.rdbuf(discard.rdbuf());
+  try {
+    // Mock cut configuration, removed on exit and on error
+    const temporary_directory directory("/tmp/bench_process_report_XXXXXX");
+    std::string manager_config;
+    const std::vector<std::string> cut_list
+      = snemo::processing::testing::write_mock_cut_configuration(options.cuts, directory.get_path(),
+                                                                 manager_config);
+
+    // Services
+    datatools::service_manager services("bench_services", "Benchmark services");
+    services.initialize();
+    datatools::properties cut_service_config;
+    cut_service_config.store_path("cut_manager.config", manager_config);
+    services.load("cuts", "cuts::cut_service", cut_service_config);
+    cuts::cut_manager & the_cut_manager = services.grab<cuts::cut_service>("cuts").grab_cut_manager();
+
+    // Module configuration
+    datatools::properties module_config;
+    module_config.store("output", "clog");
+    module_config.store("Cut_label", "cuts");
+    module_config.store("drivers", split(options.drivers));
+    module_config.store("CRD.print_report", "table");
+    module_config.store("CRD.cuts", cut_list);
+    dpp::module_handle_dict_type modules;
+
+    snemo::processing::testing::bench_results results("process_report_module");
+    results.add("cuts", options.cuts.number_of_cuts, "count");
+    results.add("events", options.events, "count");
+
+    // Initialization time
+    {
+      const double init_ms = time_ms([&] {
+          snemo::processing::process_report_module a_module;
+          a_module.initialize(module_config, services, modules);
+        }, options.repetitions);
+      results.add("module.initialize_reset", init_ms, "ms");
+    }
+
+    // Per-event overhead
+    {
+      snemo::processing::testing::synthetic_event_generator generator(the_cut_manager, cut_list);
+      generator.set_events_per_run(options.events_per_run);
+      datatools::things event;
+      const double reference_ms = time_ms([&] { generator.next(event); }, options.events);
+
+      snemo::processing::process_report_module a_module;
+      a_module.initialize(module_config, services, modules);
+      const double module_ms = time_ms([&] {
+          generator.next(event);
+          a_module.process(event);
+        }, options.events);
+      results.add("event.generator", 1e6 * reference_ms, "ns");
+      results.add("event.generator_and_module", 1e6 * module_ms, "ns");
+      results.add("event.module_overhead", 1e6 * (module_ms - reference_ms), "ns");
+      a_module.reset();
+    }
+
+    // Report rendering time per format
+    const char * formats[] = { "tree", "table", "meter" };
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+      snemo::processing::cut_report_driver a_driver;
+      a_driver.set_cut_manager(the_cut_manager);
+      datatools::properties driver_config;
+      driver_config.store("print_report", formats[i]);
+      driver_config.store("cuts", cut_list);
+      a_driver.initialize(driver_config);
+      std::ostringstream sink;
+      const double render_ms = time_ms([&] { sink.str(""); a_driver.report(sink); }, options.repetitions);
+      results.add(std::string("report.") + formats[i], render_ms, "ms");
+    }
+
+    if (! results.write(options.output)) {
+      throw std::runtime_error("cannot write results to '" + options.output + "'");
+    }
+  } catch (std::exception & error) {
+    std::cerr << "error: " << error.what() << std::endl;
+    error_code = EXIT_FAILURE;
+  }
+  std::clog.rdbuf(clog_buffer);
+  return error_code;
+}
@@ -0,0 +1,99 @@
+// bench_results.h
+//
+// Collect benchmark measurements and write them in a machine readable JSON
+// document, one object per measurement, so results from different builds
+// can be compared with any JSON aware tool.
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_TESTING_BENCH_RESULTS_H
+#define FALAISE_PROCESSREPORT_PLUGIN_TESTING_BENCH_RESULTS_H 1
+
+// Standard library:
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace testing {
+
+      /// \brief Benchmark result collection
+      class bench_results
+      {
+      public:
+
+        /// Single measurement
+        struct entry_type
+        {
+          std::string name;
+          double value;
+          std::string unit;
+        };
+
+        /// Constructor
+        explicit bench_results(const std::string & suite_) : _suite_(suite_) {}
+
+        /// Record a measurement
+        void add(const std::string & name_, const double value_, const std::string & unit_)
+        {
+          entry_type e;
+          e.name  = name_;
+          e.value = value_;
+          e.unit  = unit_;
+          _entries_.push_back(e);
+          return;
+        }
+
+        /// Write results as JSON
+        void write(std::ostream & out_) const
+        {
+          out_ << "{\n  \"suite\": \"" << _suite_ << "\",\n  \"results\": [\n";
+          for (size_t i = 0; i < _entries_.size(); i++) {
+            const entry_type & e = _entries_[i];
+            out_ << "    {\"name\": \"" << e.name << "\", \"value\": " << e.value
+                 << ", \"unit\": \"" << e.unit << "\"}"
+                 << (i + 1 < _entries_.size() ? "," : "") << "\n";
+          }
+          out_ << "  ]\n}\n";
+          return;
+        }
+
+        /// Write results as JSON to a file, or to standard output if the name is empty
+        bool write(const std::string & filename_) const
+        {
+          if (filename_.empty()) {
+            write(std::cout);
+            return true;
+          }
+          std::ofstream fout(filename_.c_str());
+          if (! fout) return false;
+          write(fout);
+          return true;
+        }
+
+      private:
+
+        std::string _suite_;
+        std::vector<entry_type> _entries_;
+      };
+
+      /// Average time in milliseconds of a function over several repetitions
+      template <class Function>
+      double time_ms(Function f_, const size_t repetitions_)
+      {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < repetitions_; i++) f_();
+        const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(stop - start).count() / repetitions_;
+      }
+
+    } // namespace testing
+
+  } // namespace processing
+
+} // namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_TESTING_BENCH_RESULTS_H
@@ -0,0 +1,134 @@
+// mock_cut.cc
+
+// Ourselves:
+#include "mock_cut.h"
+
+// Standard library:
+#include <fstream>
+#include <sstream>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+#include <bayeux/datatools/exception.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace testing {
+
+      // Registration instantiation macro :
+      CUT_REGISTRATION_IMPLEMENT(mock_cut, "snemo::processing::testing::mock_cut")
+
+      mock_cut::mock_cut(datatools::logger::priority logging_priority_)
+        : cuts::i_cut(logging_priority_)
+      {
+        _acceptance_ = 1.0;
+        _calls_ = 0;
+        return;
+      }
+
+      mock_cut::~mock_cut()
+      {
+        if (is_initialized()) mock_cut::reset();
+        return;
+      }
+
+      void mock_cut::set_acceptance(const double acceptance_)
+      {
+        DT_THROW_IF(acceptance_ < 0.0 || acceptance_ > 1.0, std::range_error,
+                    "Invalid acceptance " << acceptance_ << " !");
+        _acceptance_ = acceptance_;
+        return;
+      }
+
+      double mock_cut::get_acceptance() const
+      {
+        return _acceptance_;
+      }
+
+      void mock_cut::initialize(const datatools::properties & configuration_,
+                                datatools::service_manager & /* service_manager_ */,
+                                cuts::cut_handle_dict_type & /* cut_dict_ */)
+      {
+        DT_THROW_IF(is_initialized(), std::logic_error,
+                    "Cut '" << get_name() << "' is already initialized ! ");
+        this->i_cut::_common_initialize(configuration_);
+        if (configuration_.has_key("acceptance")) {
+          set_acceptance(configuration_.fetch_real("acceptance"));
+        }
+        _calls_ = 0;
+        _set_initialized(true);
+        return;
+      }
+
+      void mock_cut::reset()
+      {
+        _set_initialized(false);
+        _acceptance_ = 1.0;
+        _calls_ = 0;
+        this->i_cut::_reset();
+        return;
+      }
+
+      int mock_cut::_accept()
+      {
+        // Accept when floor(n * acceptance) increases
+        const uint64_t before = (uint64_t) (_calls_ * _acceptance_);
+        _calls_++;
+        const uint64_t after = (uint64_t) (_calls_ * _acceptance_);
+        return after > before ? cuts::SELECTION_ACCEPTED : cuts::SELECTION_REJECTED;
+      }
+
+      mock_cut_setup::mock_cut_setup()
+        : number_of_cuts(100), separator_period(10), first_acceptance(0.95), acceptance_step(0.05)
+      {
+        return;
+      }
+
+      std::vector<std::string> write_mock_cut_configuration(const mock_cut_setup & setup_,
+                                                            const std::string & directory_,
+                                                            std::string & manager_config_)
+      {
+        std::vector<std::string> cut_list;
+        const std::string definitions = directory_ + "/mock_cuts.def";
+        std::ofstream fdef(definitions.c_str());
+        DT_THROW_IF(! fdef, std::runtime_error, "Cannot write '" << definitions << "' !");
+        fdef << "#@description Mock cut definitions" << std::endl;
+        fdef << "#@key_label   \"name\"" << std::endl;
+        fdef << "#@meta_label  \"type\"" << std::endl << std::endl;
+        double acceptance = setup_.first_acceptance;
+        for (size_t i = 0; i < setup_.number_of_cuts; i++) {
+          const bool start = setup_.separator_period > 0 && i % setup_.separator_period == 0;
+          if (start) {
+            if (i > 0) {
+              std::ostringstream sep;
+              sep << "-- serie " << i / setup_.separator_period;
+              cut_list.push_back(sep.str());
+            }
+            acceptance = setup_.first_acceptance;
+          }
+          std::ostringstream name;
+          name << "mock_cut_" << i;
+          cut_list.push_back(name.str());
+          fdef << "[name=\"" << name.str() << "\" type=\"snemo::processing::testing::mock_cut\"]" << std::endl;
+          fdef << "acceptance : real = " << acceptance << std::endl << std::endl;
+          acceptance -= setup_.acceptance_step;
+          if (acceptance < 0.0) acceptance = 0.0;
+        }
+
+        manager_config_ = directory_ + "/mock_cut_manager.conf";
+        std::ofstream fconf(manager_config_.c_str());
+        DT_THROW_IF(! fconf, std::runtime_error, "Cannot write '" << manager_config_ << "' !");
+        fconf << "#@description Mock cut manager configuration" << std::endl;
+        fconf << "logging.priority : string = \"fatal\"" << std::endl;
+        fconf << "cuts.configuration_files : string[1] as path = \"" << definitions << "\"" << std::endl;
+        return cut_list;
+      }
+
+    } // namespace testing
+
+  } // namespace processing
+
+} // namespace snemo
@@ -0,0 +1,86 @@
+// mock_cut.h
+//
+// A cut with a configurable acceptance, used to populate a cut manager with
+// synthetic cuts for benchmarks. Decisions are deterministic: over n calls,
+// floor(n * acceptance) of them are accepted.
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_TESTING_MOCK_CUT_H
+#define FALAISE_PROCESSREPORT_PLUGIN_TESTING_MOCK_CUT_H 1
+
+// Standard library:
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Third party:
+// - Bayeux/cuts:
+#include <bayeux/cuts/i_cut.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace testing {
+
+      /// \brief Mock cut with a configurable acceptance
+      class mock_cut : public cuts::i_cut
+      {
+      public:
+
+        /// Constructor
+        mock_cut(datatools::logger::priority logging_priority_ = datatools::logger::PRIO_FATAL);
+
+        /// Destructor
+        virtual ~mock_cut();
+
+        /// Set the acceptance in [0,1]
+        void set_acceptance(const double acceptance_);
+
+        /// Return the acceptance
+        double get_acceptance() const;
+
+        /// Initialization
+        virtual void initialize(const datatools::properties & configuration_,
+                                datatools::service_manager & service_manager_,
+                                cuts::cut_handle_dict_type & cut_dict_);
+
+        /// Reset
+        virtual void reset();
+
+      protected:
+
+        /// Selection
+        virtual int _accept();
+
+      private:
+
+        double _acceptance_; //!< Acceptance
+        uint64_t _calls_;    //!< Number of decisions taken
+
+        // Macro to automate the registration of the cut :
+        CUT_REGISTRATION_INTERFACE(mock_cut)
+      };
+
+      /// Parameters of the synthetic cut configuration
+      struct mock_cut_setup
+      {
+        mock_cut_setup();
+        size_t number_of_cuts;    //!< Number of mock cuts
+        size_t separator_period;  //!< Number of cuts in a serie (0: no separator)
+        double first_acceptance;  //!< Acceptance of the first cut of a serie
+        double acceptance_step;   //!< Acceptance decrease along a serie
+      };
+
+      /// Write a cut manager configuration with mock cuts, return the ordered cut list
+      /// (cut names and separators) suitable for the cut report driver
+      std::vector<std::string> write_mock_cut_configuration(const mock_cut_setup & setup_,
+                                                            const std::string & directory_,
+                                                            std::string & manager_config_);
+
+    } // namespace testing
+
+  } // namespace processing
+
+} // namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_TESTING_MOCK_CUT_H
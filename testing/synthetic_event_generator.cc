@@ -0,0 +1,81 @@
+// synthetic_event_generator.cc
+
+// Ourselves:
+#include "synthetic_event_generator.h"
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/things.h>
+// - Bayeux/cuts:
+#include <bayeux/cuts/cut_manager.h>
+
+// This project (Falaise):
+#include <falaise/snemo/datamodels/event_header.h>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace testing {
+
+      synthetic_event_generator::synthetic_event_generator(cuts::cut_manager & cut_manager_,
+                                                           const std::vector<std::string> & cut_list_)
+        : _eh_label_("EH"), _events_per_run_(10000), _counter_(0)
+      {
+        _series_.push_back(std::vector<cuts::i_cut *>());
+        for (size_t i = 0; i < cut_list_.size(); i++) {
+          const std::string & a_name = cut_list_[i];
+          if (! a_name.empty() && a_name[0] == '-') {
+            _series_.push_back(std::vector<cuts::i_cut *>());
+            continue;
+          }
+          if (! cut_manager_.has(a_name)) continue;
+          _series_.back().push_back(&cut_manager_.grab(a_name));
+        }
+        return;
+      }
+
+      void synthetic_event_generator::set_events_per_run(const uint64_t events_per_run_)
+      {
+        _events_per_run_ = (events_per_run_ > 0 ? events_per_run_ : 1);
+        return;
+      }
+
+      void synthetic_event_generator::set_event_header_label(const std::string & label_)
+      {
+        _eh_label_ = label_;
+        return;
+      }
+
+      uint64_t synthetic_event_generator::get_number_of_events() const
+      {
+        return _counter_;
+      }
+
+      void synthetic_event_generator::next(datatools::things & event_)
+      {
+        if (! event_.has(_eh_label_)) {
+          event_.add<snemo::datamodel::event_header>(_eh_label_);
+        }
+        snemo::datamodel::event_header & eh = event_.grab<snemo::datamodel::event_header>(_eh_label_);
+        eh.grab_id().set(_counter_ / _events_per_run_, _counter_ % _events_per_run_);
+        _counter_++;
+
+        for (size_t iserie = 0; iserie < _series_.size(); iserie++) {
+          const std::vector<cuts::i_cut *> & a_serie = _series_[iserie];
+          for (size_t icut = 0; icut < a_serie.size(); icut++) {
+            cuts::i_cut & a_cut = *a_serie[icut];
+            a_cut.set_user_data(event_);
+            const int status = a_cut.process();
+            a_cut.reset_user_data();
+            if (status != cuts::SELECTION_ACCEPTED) break;
+          }
+        }
+        return;
+      }
+
+    } // namespace testing
+
+  } // namespace processing
+
+} // namespace snemo
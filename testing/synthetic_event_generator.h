@@ -0,0 +1,65 @@
+// synthetic_event_generator.h
+//
+// Produce event records with an event header and apply the cuts of the cut
+// list in order, with short-circuit within each separator-delimited serie,
+// as a cut module of the pipeline would do.
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_TESTING_SYNTHETIC_EVENT_GENERATOR_H
+#define FALAISE_PROCESSREPORT_PLUGIN_TESTING_SYNTHETIC_EVENT_GENERATOR_H 1
+
+// Standard library:
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace datatools {
+  class things;
+}
+
+namespace cuts {
+  class cut_manager;
+  class i_cut;
+}
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace testing {
+
+      /// \brief Synthetic event generator
+      class synthetic_event_generator
+      {
+      public:
+
+        /// Constructor
+        synthetic_event_generator(cuts::cut_manager & cut_manager_,
+                                  const std::vector<std::string> & cut_list_);
+
+        /// Set the number of events per run
+        void set_events_per_run(const uint64_t events_per_run_);
+
+        /// Set the event header bank label
+        void set_event_header_label(const std::string & label_);
+
+        /// Fill the next event and apply the cuts
+        void next(datatools::things & event_);
+
+        /// Return the number of generated events
+        uint64_t get_number_of_events() const;
+
+      private:
+
+        std::vector<std::vector<cuts::i_cut *> > _series_; //!< Cuts grouped by serie
+        std::string _eh_label_;                            //!< Event header bank label
+        uint64_t _events_per_run_;                         //!< Number of events per run
+        uint64_t _counter_;                                //!< Number of generated events
+      };
+
+    } // namespace testing
+
+  } // namespace processing
+
+} // namespace snemo
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_TESTING_SYNTHETIC_EVENT_GENERATOR_H
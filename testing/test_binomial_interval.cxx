@@ -0,0 +1,107 @@
+// test_binomial_interval.cxx
+//
+// Check the binomial confidence intervals against reference values
+// computed independently, their edge cases and the coverage of the
+// Clopper-Pearson interval, which is never below the confidence level.
+
+// Standard library:
+#include <cmath>
+#include <random>
+
+// This project:
+#include <falaise/snemo/processing/binomial_interval.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::binomial_interval;
+
+namespace {
+
+  struct reference_type
+  {
+    uint64_t k;
+    uint64_t n;
+    double cp_low;
+    double cp_high;
+    double wilson_low;
+    double wilson_high;
+  };
+
+  // 95% intervals
+  const reference_type references[] = {
+    {   8,   10, 0.443905, 0.974789, 0.490162, 0.943318 },
+    {   0,   10, 0.000000, 0.308497, 0.000000, 0.277533 },
+    {  10,   10, 0.691503, 1.000000, 0.722467, 1.000000 },
+    { 450, 1000, 0.418852, 0.481443, 0.419415, 0.480967 }
+  };
+
+  void test_references()
+  {
+    for (size_t i = 0; i < sizeof(references) / sizeof(references[0]); i++) {
+      const reference_type & ref = references[i];
+      double low = -1.0, high = -1.0;
+      binomial_interval::clopper_pearson(ref.k, ref.n, 0.95, low, high);
+      PR_CHECK_CLOSE(low, ref.cp_low, 1e-5);
+      PR_CHECK_CLOSE(high, ref.cp_high, 1e-5);
+      binomial_interval::wilson(ref.k, ref.n, 0.95, low, high);
+      PR_CHECK_CLOSE(low, ref.wilson_low, 1e-5);
+      PR_CHECK_CLOSE(high, ref.wilson_high, 1e-5);
+    }
+    return;
+  }
+
+  void test_methods()
+  {
+    PR_CHECK(binomial_interval::get_method("wilson") == binomial_interval::METHOD_WILSON);
+    PR_CHECK(binomial_interval::get_method("clopper_pearson") == binomial_interval::METHOD_CLOPPER_PEARSON);
+    PR_CHECK(binomial_interval::get_label(binomial_interval::METHOD_WILSON) == "wilson");
+    double low = 0.0, high = 0.0;
+    binomial_interval::compute(binomial_interval::METHOD_CLOPPER_PEARSON, 8, 10, 0.95, low, high);
+    PR_CHECK_CLOSE(low, references[0].cp_low, 1e-5);
+
+    // Wider intervals at higher confidence levels
+    double low99 = 0.0, high99 = 0.0;
+    binomial_interval::wilson(8, 10, 0.99, low99, high99);
+    binomial_interval::wilson(8, 10, 0.95, low, high);
+    PR_CHECK(low99 < low && high99 > high);
+
+    // No event: no information
+    binomial_interval::wilson(0, 0, 0.95, low, high);
+    PR_CHECK(low == 0.0 && high == 1.0);
+    binomial_interval::clopper_pearson(0, 0, 0.95, low, high);
+    PR_CHECK(low == 0.0 && high == 1.0);
+    return;
+  }
+
+  void test_coverage()
+  {
+    // Clopper-Pearson is conservative: the true efficiency is inside the
+    // interval at least 95% of the time (checked with a 3 sigma margin)
+    std::mt19937_64 rng(271828);
+    const uint64_t n = 50;
+    const size_t ntrials = 4000;
+    const double efficiencies[] = { 0.05, 0.5, 0.93 };
+    for (size_t e = 0; e < sizeof(efficiencies) / sizeof(efficiencies[0]); e++) {
+      std::binomial_distribution<uint64_t> binomial(n, efficiencies[e]);
+      size_t covered = 0;
+      for (size_t trial = 0; trial < ntrials; trial++) {
+        double low = 0.0, high = 0.0;
+        binomial_interval::clopper_pearson(binomial(rng), n, 0.95, low, high);
+        if (low <= efficiencies[e] && efficiencies[e] <= high) covered++;
+      }
+      const double sigma = std::sqrt(0.95 * 0.05 / ntrials);
+      PR_CHECK((double) covered / ntrials > 0.95 - 3.0 * sigma);
+    }
+    return;
+  }
+
+}
+
+int main()
+{
+  test_references();
+  test_methods();
+  test_coverage();
+  return snemo::processing::testing::test_status();
+}
@@ -0,0 +1,58 @@
+// test_checks.h
+//
+// Minimal checks shared by the unit tests: a failed check prints the
+// failing expression with its location and the test program ends with a
+// failure status, as expected by ctest.
+
+#ifndef FALAISE_PROCESSREPORT_PLUGIN_TESTING_TEST_CHECKS_H
+#define FALAISE_PROCESSREPORT_PLUGIN_TESTING_TEST_CHECKS_H 1
+
+// Standard library:
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace snemo {
+
+  namespace processing {
+
+    namespace testing {
+
+      /// Number of failed checks
+      inline size_t & failed_checks()
+      {
+        static size_t _failed = 0;
+        return _failed;
+      }
+
+      /// Record the result of a check
+      inline void check(const bool passed_, const char * expression_, const char * file_, const int line_)
+      {
+        if (passed_) return;
+        std::cerr << file_ << ":" << line_ << ": check failed: " << expression_ << std::endl;
+        failed_checks()++;
+        return;
+      }
+
+      /// Exit status of the test program
+      inline int test_status()
+      {
+        return failed_checks() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+      }
+
+    }  // end of namespace testing
+
+  }  // end of namespace processing
+
+}  // end of namespace snemo
+
+/// Check a condition
+#define PR_CHECK(condition)                                             \
+  ::snemo::processing::testing::check((condition), #condition, __FILE__, __LINE__)
+
+/// Check that two values agree within an absolute tolerance
+#define PR_CHECK_CLOSE(value, expected, tolerance)                      \
+  ::snemo::processing::testing::check(std::abs((value) - (expected)) <= (tolerance), \
+                                      #value " ~ " #expected, __FILE__, __LINE__)
+
+#endif // FALAISE_PROCESSREPORT_PLUGIN_TESTING_TEST_CHECKS_H
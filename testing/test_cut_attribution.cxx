@@ -0,0 +1,129 @@
+// test_cut_attribution.cxx
+//
+// Check the first failing cut attribution on a hand-made sequence of cut
+// counter differences: two series of cuts evaluated with short-circuit,
+// events that do not reach a serie, undecided events and counters added
+// back from a previous job.
+
+// Standard library:
+#include <vector>
+
+// This project:
+#include <falaise/snemo/processing/cut_attribution.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::cut_attribution;
+
+namespace {
+
+  const size_t N = cut_attribution::COUNTERS_PER_CUT;
+
+  /// Decision of a cut in a hand-made event
+  enum { NOT_EVALUATED = 0, PASS = 1, FAIL = 2 };
+
+  /// Counter differences of an event from the decisions of its cuts
+  std::vector<uint64_t> deltas(const std::vector<int> & decisions_)
+  {
+    std::vector<uint64_t> result(N * decisions_.size(), 0);
+    for (size_t i = 0; i < decisions_.size(); i++) {
+      if (decisions_[i] == NOT_EVALUATED) continue;
+      result[N * i] = 1;
+      result[N * i + (decisions_[i] == PASS ? 1 : 2)] = 1;
+    }
+    return result;
+  }
+
+  void add(cut_attribution & attribution_, const int d0_, const int d1_, const int d2_,
+           const int d3_, const int d4_)
+  {
+    std::vector<int> decisions;
+    decisions.push_back(d0_);
+    decisions.push_back(d1_);
+    decisions.push_back(d2_);
+    decisions.push_back(d3_);
+    decisions.push_back(d4_);
+    const std::vector<uint64_t> event = deltas(decisions);
+    attribution_.add_event(&event[0]);
+    return;
+  }
+
+  void test_sequence()
+  {
+    // Series {0, 1, 2} and {3, 4}
+    std::vector<char> group_start(5, 0);
+    group_start[3] = 1;
+    cut_attribution attribution;
+    attribution.initialize(group_start);
+    PR_CHECK(attribution.get_number_of_cuts() == 5);
+    PR_CHECK(attribution.is_group_start(0));
+    PR_CHECK(attribution.is_group_start(3));
+    PR_CHECK(! attribution.is_group_start(1));
+
+    // Short-circuit: cuts after the first failure are not evaluated
+    add(attribution, PASS, PASS, PASS,          PASS, PASS);
+    add(attribution, PASS, FAIL, NOT_EVALUATED, PASS, FAIL);
+    add(attribution, FAIL, NOT_EVALUATED, NOT_EVALUATED, FAIL, NOT_EVALUATED);
+    add(attribution, PASS, PASS, FAIL,          NOT_EVALUATED, NOT_EVALUATED);
+    add(attribution, PASS, FAIL, NOT_EVALUATED, PASS, PASS);
+    // No failure but a cut not evaluated, e.g. stopped by another filter
+    add(attribution, PASS, NOT_EVALUATED, PASS, PASS, NOT_EVALUATED);
+
+    PR_CHECK(attribution.get_events(0) == 6);
+    PR_CHECK(attribution.get_first_failures(0) == 1);
+    PR_CHECK(attribution.get_first_failures(1) == 2);
+    PR_CHECK(attribution.get_first_failures(2) == 1);
+    PR_CHECK(attribution.get_all_passed(0) == 1);
+    PR_CHECK(attribution.get_undecided(0) == 1);
+
+    // The event with no cut of the second serie evaluated is ignored
+    PR_CHECK(attribution.get_events(3) == 5);
+    PR_CHECK(attribution.get_first_failures(3) == 1);
+    PR_CHECK(attribution.get_first_failures(4) == 1);
+    PR_CHECK(attribution.get_all_passed(3) == 2);
+    PR_CHECK(attribution.get_undecided(3) == 1);
+
+    // Every event reaching a serie is accounted for exactly once
+    for (size_t first = 0; first < 5; first += 3) {
+      const size_t end = (first == 0 ? 3 : 5);
+      uint64_t total = attribution.get_all_passed(first) + attribution.get_undecided(first);
+      for (size_t i = first; i < end; i++) total += attribution.get_first_failures(i);
+      PR_CHECK(total == attribution.get_events(first));
+    }
+
+    // Counters resumed from a previous job
+    const uint64_t groups[cut_attribution::GROUP_COUNTERS] = {10, 7, 1};
+    attribution.add_group_counters(0, groups);
+    attribution.add_first_failures(1, 2);
+    PR_CHECK(attribution.get_events(0) == 16);
+    PR_CHECK(attribution.get_all_passed(0) == 8);
+    PR_CHECK(attribution.get_undecided(0) == 2);
+    PR_CHECK(attribution.get_first_failures(1) == 4);
+    return;
+  }
+
+  void test_single_serie()
+  {
+    // The first cut always starts a serie
+    cut_attribution attribution;
+    attribution.initialize(std::vector<char>(2, 0));
+    PR_CHECK(attribution.is_group_start(0));
+    std::vector<int> decisions(2, PASS);
+    decisions[1] = FAIL;
+    const std::vector<uint64_t> event = deltas(decisions);
+    attribution.add_event(&event[0]);
+    PR_CHECK(attribution.get_events(0) == 1);
+    PR_CHECK(attribution.get_first_failures(1) == 1);
+    PR_CHECK(attribution.get_group_counters().size() == 2 * cut_attribution::GROUP_COUNTERS);
+    return;
+  }
+
+}
+
+int main()
+{
+  test_sequence();
+  test_single_serie();
+  return snemo::processing::testing::test_status();
+}
@@ -0,0 +1,109 @@
+// test_distinct_events.cxx
+//
+// Check the distinct event counters: accuracy of the HyperLogLog estimate
+// against its stated relative error, merging of sketches, and the exact
+// open-addressing set of event ids through its growth.
+
+// Standard library:
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// This project:
+#include <falaise/snemo/processing/hyperloglog.h>
+#include <falaise/snemo/processing/event_id_set.h>
+#include <falaise/snemo/processing/event_report_driver.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::hyperloglog;
+using snemo::processing::event_id_set;
+using snemo::processing::event_report_driver;
+
+namespace {
+
+  void test_hyperloglog()
+  {
+    const size_t counts[] = { 10, 1000, 100000, 1000000 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+      hyperloglog sketch(14);
+      for (int32_t event = 0; event < (int32_t) counts[c]; event++) {
+        const uint64_t key = event_report_driver::make_key(1 + event / 10000, event);
+        sketch.add(key);
+        // Duplicates do not change the estimate
+        if (event % 3 == 0) sketch.add(key);
+      }
+      // Beyond 4 standard errors would be a failure of the estimator
+      const double tolerance = 4.0 * sketch.get_relative_error() * counts[c] + 1.0;
+      PR_CHECK(std::abs(sketch.estimate() - counts[c]) <= tolerance);
+    }
+
+    // Merging two sketches counts the union
+    hyperloglog first(12);
+    hyperloglog second(12);
+    for (uint64_t key = 1; key <= 60000; key++) first.add(key);
+    for (uint64_t key = 40001; key <= 100000; key++) second.add(key);
+    first.merge(second);
+    PR_CHECK(std::abs(first.estimate() - 100000.0) <= 4.0 * first.get_relative_error() * 100000.0);
+    PR_CHECK(first.get_memory_size() == 4096);
+
+    // Registers round trip
+    hyperloglog copy;
+    copy.set_registers(first.get_registers());
+    PR_CHECK(copy.get_precision() == 12);
+    PR_CHECK(copy.estimate() == first.estimate());
+    return;
+  }
+
+  void test_event_id_set()
+  {
+    event_id_set ids;
+    PR_CHECK(ids.size() == 0);
+    // The null key is a valid key
+    PR_CHECK(ids.insert(0));
+    PR_CHECK(! ids.insert(0));
+    const uint64_t nkeys = 100000;
+    bool inserted = true;
+    for (uint64_t i = 1; i <= nkeys; i++) {
+      if (! ids.insert(event_report_driver::make_key(i % 7, i))) inserted = false;
+    }
+    PR_CHECK(inserted);
+    PR_CHECK(ids.size() == nkeys + 1);
+    PR_CHECK(ids.get_capacity() >= ids.size());
+    bool duplicates = true;
+    bool present = true;
+    for (uint64_t i = 1; i <= nkeys; i++) {
+      const uint64_t key = event_report_driver::make_key(i % 7, i);
+      if (ids.insert(key)) duplicates = false;
+      if (! ids.contains(key)) present = false;
+    }
+    PR_CHECK(duplicates);
+    PR_CHECK(present);
+    PR_CHECK(! ids.contains(event_report_driver::make_key(99, 1)));
+
+    std::vector<uint64_t> keys;
+    ids.get_keys(keys);
+    std::sort(keys.begin(), keys.end());
+    PR_CHECK(keys.size() == nkeys + 1);
+    PR_CHECK(std::unique(keys.begin(), keys.end()) == keys.end());
+
+    // Key packing
+    const uint64_t key = event_report_driver::make_key(1234, 567890);
+    PR_CHECK(event_report_driver::get_run_number(key) == 1234);
+    PR_CHECK(event_report_driver::get_event_number(key) == 567890);
+
+    ids.clear();
+    PR_CHECK(ids.size() == 0);
+    PR_CHECK(! ids.contains(0));
+    return;
+  }
+
+}
+
+int main()
+{
+  test_hyperloglog();
+  test_event_id_set();
+  return snemo::processing::testing::test_status();
+}
@@ -0,0 +1,106 @@
+// test_drift_monitor.cxx
+//
+// Check the CUSUM efficiency drift monitor: no change on a stable
+// efficiency, detection and location of a step change, and detection of a
+// slow drift against the frozen reference.
+
+// Standard library:
+#include <cmath>
+#include <vector>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+
+// This project:
+#include <falaise/snemo/processing/drift_monitor.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::drift_monitor;
+
+namespace {
+
+  const size_t window_events = 1000;
+
+  /// Feed a window of events where a single cut accepts k entries
+  void add_window(drift_monitor & monitor_, std::vector<uint64_t> & counters_, const uint64_t k_)
+  {
+    bool complete = false;
+    for (size_t i = 0; i < window_events; i++) complete = monitor_.add_event();
+    PR_CHECK(complete);
+    counters_[0] += window_events;
+    counters_[1] += k_;
+    counters_[2] += window_events - k_;
+    monitor_.close_window(counters_);
+    return;
+  }
+
+  void initialize(drift_monitor & monitor_, std::vector<uint64_t> & counters_)
+  {
+    datatools::properties config;
+    config.store("window_events", (int) window_events);
+    config.store("reference_windows", 20);
+    counters_.assign(drift_monitor::COUNTERS_PER_CUT, 0);
+    monitor_.initialize(config, counters_);
+    return;
+  }
+
+  void test_stable()
+  {
+    drift_monitor monitor;
+    std::vector<uint64_t> counters;
+    initialize(monitor, counters);
+    for (size_t w = 0; w < 200; w++) add_window(monitor, counters, 900);
+    PR_CHECK(monitor.get_changes().empty());
+    return;
+  }
+
+  void test_step()
+  {
+    drift_monitor monitor;
+    std::vector<uint64_t> counters;
+    initialize(monitor, counters);
+    for (size_t w = 0; w < 30; w++) add_window(monitor, counters, 900);
+    for (size_t w = 0; w < 10; w++) add_window(monitor, counters, 800);
+    PR_CHECK(monitor.get_changes().size() == 1);
+    if (monitor.get_changes().size() != 1) return;
+    const drift_monitor::change_type & a_change = monitor.get_changes().front();
+    PR_CHECK(a_change.cut == 0);
+    PR_CHECK(a_change.first_event == 30 * window_events);
+    PR_CHECK(a_change.detection_event == 31 * window_events);
+    PR_CHECK_CLOSE(a_change.before, 0.9, 1e-12);
+    PR_CHECK_CLOSE(a_change.after, 0.8, 1e-12);
+    return;
+  }
+
+  void test_slow_drift()
+  {
+    drift_monitor monitor;
+    std::vector<uint64_t> counters;
+    initialize(monitor, counters);
+    for (size_t w = 0; w < 20; w++) add_window(monitor, counters, 900);
+    // One accepted entry less per window
+    for (size_t w = 1; w <= 60 && monitor.get_changes().empty(); w++) {
+      add_window(monitor, counters, 900 - w);
+    }
+    PR_CHECK(monitor.get_changes().size() == 1);
+    if (monitor.get_changes().empty()) return;
+    const drift_monitor::change_type & a_change = monitor.get_changes().front();
+    // The reference learned before the drift is kept
+    PR_CHECK_CLOSE(a_change.before, 0.9, 1e-12);
+    PR_CHECK(a_change.after < 0.9);
+    PR_CHECK(a_change.first_event >= 20 * window_events);
+    return;
+  }
+
+}
+
+int main()
+{
+  test_stable();
+  test_step();
+  test_slow_drift();
+  return snemo::processing::testing::test_status();
+}
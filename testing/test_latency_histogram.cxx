@@ -0,0 +1,86 @@
+// test_latency_histogram.cxx
+//
+// Check the latency histogram quantiles on a log-uniform sample whose
+// quantiles are known, on the underflow and overflow bins, and after the
+// merge of two histograms.
+
+// Standard library:
+#include <cmath>
+
+// This project:
+#include <falaise/snemo/processing/latency_histogram.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::latency_histogram;
+
+namespace {
+
+  /// Fill a log-uniform sample from 1 us to 1 ms
+  void fill_log_uniform(latency_histogram & histogram_, const size_t n_)
+  {
+    for (size_t i = 0; i < n_; i++) {
+      histogram_.fill(1e3 * std::pow(10.0, 3.0 * (i + 0.5) / n_));
+    }
+    return;
+  }
+
+  void test_quantiles()
+  {
+    latency_histogram histogram;
+    PR_CHECK(histogram.get_quantile(0.5) == 0.0);
+    const size_t n = 100000;
+    fill_log_uniform(histogram, n);
+    PR_CHECK(histogram.get_count() == n);
+    const double qs[] = {0.01, 0.1, 0.5, 0.9, 0.99};
+    for (size_t k = 0; k < sizeof(qs) / sizeof(qs[0]); k++) {
+      const double expected = 1e3 * std::pow(10.0, 3.0 * qs[k]);
+      PR_CHECK_CLOSE(histogram.get_quantile(qs[k]) / expected, 1.0, 1e-2);
+    }
+    // Quantiles never decrease
+    double previous = 0.0;
+    for (int k = 0; k <= 100; k++) {
+      const double value = histogram.get_quantile(0.01 * k);
+      PR_CHECK(value >= previous);
+      previous = value;
+    }
+    PR_CHECK(histogram.get_quantile(1.0) <= 1e6 * std::pow(10.0, 1.0 / latency_histogram::BINS_PER_DECADE));
+
+    // Merging a copy keeps the quantiles
+    latency_histogram merged;
+    fill_log_uniform(merged, n);
+    merged.merge(histogram);
+    PR_CHECK(merged.get_count() == 2 * n);
+    PR_CHECK_CLOSE(merged.get_mean(), histogram.get_mean(), 1e-9 * histogram.get_mean());
+    PR_CHECK_CLOSE(merged.get_quantile(0.5), histogram.get_quantile(0.5), 1e-9 * histogram.get_quantile(0.5));
+    return;
+  }
+
+  void test_outer_bins()
+  {
+    // Underflow is interpolated linearly from zero
+    latency_histogram histogram;
+    histogram.fill(10.0);
+    histogram.fill(50.0);
+    PR_CHECK(latency_histogram::get_bin(50.0) == 0);
+    PR_CHECK(histogram.get_quantile(0.5) >= 0.0);
+    PR_CHECK(histogram.get_quantile(0.5) <= 100.0);
+
+    // Overflow has no upper edge: its mean is returned
+    latency_histogram slow;
+    slow.fill(2e11);
+    slow.fill(4e11);
+    PR_CHECK(latency_histogram::get_bin(2e11) == latency_histogram::NUMBER_OF_BINS - 1);
+    PR_CHECK_CLOSE(slow.get_quantile(0.99), 3e11, 1.0);
+    return;
+  }
+
+}
+
+int main()
+{
+  test_quantiles();
+  test_outer_bins();
+  return snemo::processing::testing::test_status();
+}
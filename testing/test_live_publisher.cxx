@@ -0,0 +1,207 @@
+// test_live_publisher.cxx
+//
+// Check the live counters messages: names and delta round trips, rejection
+// of truncated messages, and, through a local socket, that a large cut
+// table is split below the message size limit, that only changed cuts are
+// sent and that counters pushed while no collector listens, or while its
+// socket buffer is full, are delivered exactly once later on.
+
+// Standard library:
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// System:
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// This project:
+#include <falaise/snemo/processing/live_publisher.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::live_publisher;
+
+namespace {
+
+  const size_t N = live_publisher::COUNTERS_PER_CUT;
+
+  void test_round_trip()
+  {
+    live_publisher::names_type names;
+    names.job     = "host:1234";
+    names.version = 3;
+    names.ncuts   = 10;
+    names.first   = 8;
+    names.names.push_back("electron_cut");
+    names.names.push_back("vertex_cut");
+    names.group_start.push_back(1);
+    names.group_start.push_back(0);
+    std::string message;
+    live_publisher::encode_names(names, message);
+    live_publisher::names_type names_read;
+    live_publisher::delta_type delta_read;
+    PR_CHECK(live_publisher::decode(message.data(), message.size(), names_read, delta_read)
+             == live_publisher::MESSAGE_NAMES);
+    PR_CHECK(names_read.job == names.job);
+    PR_CHECK(names_read.version == 3);
+    PR_CHECK(names_read.ncuts == 10);
+    PR_CHECK(names_read.first == 8);
+    PR_CHECK(names_read.names == names.names);
+    PR_CHECK(names_read.group_start == names.group_start);
+
+    live_publisher::delta_type delta;
+    delta.job     = "host:1234";
+    delta.version = 3;
+    delta.events  = 1000;
+    delta.indexes.push_back(7);
+    delta.indexes.push_back(9);
+    for (size_t i = 0; i < 2 * N; i++) delta.counters.push_back(100 * i + 1);
+    live_publisher::encode_delta(delta, message);
+    PR_CHECK(live_publisher::decode(message.data(), message.size(), names_read, delta_read)
+             == live_publisher::MESSAGE_COUNTERS);
+    PR_CHECK(delta_read.job == delta.job);
+    PR_CHECK(delta_read.version == 3);
+    PR_CHECK(delta_read.events == 1000);
+    PR_CHECK(delta_read.indexes == delta.indexes);
+    PR_CHECK(delta_read.counters == delta.counters);
+
+    PR_CHECK(live_publisher::decode(message.data(), message.size() - 1, names_read, delta_read)
+             == live_publisher::MESSAGE_INVALID);
+    // A names part beyond the table size
+    names.first = 9;
+    live_publisher::encode_names(names, message);
+    PR_CHECK(live_publisher::decode(message.data(), message.size(), names_read, delta_read)
+             == live_publisher::MESSAGE_INVALID);
+    return;
+  }
+
+  /// Minimal collector: totals of a single job
+  struct collector_type
+  {
+    int fd;
+    std::vector<std::string> names;
+    std::vector<uint64_t> counters;
+    uint64_t events;
+    size_t messages;
+    size_t name_messages;
+    size_t max_size;
+    size_t max_entries;
+
+    collector_type() : fd(-1), events(0), messages(0), name_messages(0), max_size(0), max_entries(0) {}
+
+    bool bind(const std::string & path_)
+    {
+      sockaddr_un address;
+      std::memset(&address, 0, sizeof(address));
+      address.sun_family = AF_UNIX;
+      std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+      fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+      int buffer_size = 8 << 20;
+      ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+      return fd >= 0 && ::bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0;
+    }
+
+    void drain()
+    {
+      std::vector<char> buffer(1 << 20);
+      live_publisher::names_type a_names;
+      live_publisher::delta_type a_delta;
+      while (true) {
+        const ssize_t size = ::recv(fd, &buffer[0], buffer.size(), MSG_DONTWAIT);
+        if (size < 0) break;
+        messages++;
+        if ((size_t) size > max_size) max_size = size;
+        const live_publisher::message_type type = live_publisher::decode(&buffer[0], size, a_names, a_delta);
+        PR_CHECK(type != live_publisher::MESSAGE_INVALID);
+        if (type == live_publisher::MESSAGE_NAMES) {
+          name_messages++;
+          names.resize(a_names.ncuts);
+          counters.resize(a_names.ncuts * N, 0);
+          for (size_t i = 0; i < a_names.names.size(); i++) names[a_names.first + i] = a_names.names[i];
+        } else if (type == live_publisher::MESSAGE_COUNTERS) {
+          events += a_delta.events;
+          if (a_delta.indexes.size() > max_entries) max_entries = a_delta.indexes.size();
+          for (size_t i = 0; i < a_delta.indexes.size(); i++) {
+            // Counters of cuts whose name is not known are lost here
+            PR_CHECK(a_delta.indexes[i] < names.size());
+            if (a_delta.indexes[i] >= names.size()) continue;
+            for (size_t j = 0; j < N; j++) counters[a_delta.indexes[i] * N + j] += a_delta.counters[i * N + j];
+          }
+        }
+      }
+      return;
+    }
+  };
+
+  void test_socket()
+  {
+    const std::string path = "test_live_publisher.sock";
+    ::unlink(path.c_str());
+    const size_t ncuts = 5000;
+    std::vector<std::string> names;
+    std::vector<char> group_start;
+    for (size_t i = 0; i < ncuts; i++) {
+      names.push_back("a_rather_long_cut_name_for_the_selection_number_" + std::to_string(i));
+      group_start.push_back(i % 100 == 0);
+    }
+    std::vector<uint64_t> counters(ncuts * N, 0);
+
+    live_publisher publisher;
+    publisher.open(path);
+    publisher.set_cuts(names, group_start);
+
+    // No collector yet: nothing is delivered, nothing is an error
+    for (size_t i = 0; i < ncuts * N; i++) counters[i] = i % 7;
+    PR_CHECK(! publisher.publish(100, counters));
+    PR_CHECK(publisher.get_number_of_dropped() == 1);
+    PR_CHECK(publisher.get_number_of_errors() == 0);
+
+    collector_type collector;
+    PR_CHECK(collector.bind(path));
+    for (size_t i = 0; i < ncuts * N; i++) counters[i] += 1;
+    // The socket buffer only holds a few messages: retry as the collector
+    // drains it, delivered parts must not be sent twice
+    size_t attempts = 1;
+    while (! publisher.publish(200, counters) && attempts < 1000) {
+      collector.drain();
+      attempts++;
+    }
+    collector.drain();
+    PR_CHECK(publisher.get_number_of_errors() == 0);
+    PR_CHECK(collector.names == names);
+    PR_CHECK(collector.name_messages > 1);
+    PR_CHECK(collector.max_size <= live_publisher::MAX_MESSAGE_SIZE);
+    PR_CHECK(collector.events == 200);
+    PR_CHECK(collector.counters == counters);
+
+    // Only the changed cuts are sent, without the names
+    const size_t name_messages = collector.name_messages;
+    collector.max_entries = 0;
+    counters[42 * N + 1] += 5;
+    PR_CHECK(publisher.publish(250, counters));
+    collector.drain();
+    PR_CHECK(collector.name_messages == name_messages);
+    PR_CHECK(collector.max_entries == 1);
+    PR_CHECK(collector.events == 250);
+    PR_CHECK(collector.counters == counters);
+    PR_CHECK(publisher.get_number_of_sent() == 2);
+    PR_CHECK(publisher.get_number_of_dropped() == attempts);
+
+    publisher.close();
+    ::close(collector.fd);
+    ::unlink(path.c_str());
+    return;
+  }
+
+}
+
+int main()
+{
+  test_round_trip();
+  test_socket();
+  return snemo::processing::testing::test_status();
+}
@@ -0,0 +1,127 @@
+// test_mapped_report_file.cxx
+//
+// Check the memory-mapped report file: snapshot records encoded in place
+// through reserve/commit and text written through a stream are read back
+// unchanged, across growth segments, and the snapshot log decodes to the
+// logged snapshots.
+
+// Standard library:
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// This project:
+#include <falaise/snemo/processing/mapped_report_file.h>
+#include <falaise/snemo/processing/report_snapshot.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::mapped_report_file;
+using snemo::processing::report_snapshot;
+
+namespace {
+
+  void log_snapshot(mapped_report_file & file_, const report_snapshot & snapshot_)
+  {
+    const size_t size = snapshot_.get_counters_record_size();
+    snapshot_.encode_counters_record(file_.reserve(size));
+    file_.commit(size);
+    return;
+  }
+
+  void test_snapshot_log()
+  {
+    const std::string filename = "test_mapped_report_file.dat";
+    std::vector<std::string> names;
+    names.push_back("electron_cut");
+    names.push_back("vertex_cut");
+    std::vector<report_snapshot> logged;
+    {
+      mapped_report_file file;
+      // A single page segment so that the file is remapped while logging
+      file.open(filename, 1);
+      const size_t size = report_snapshot::get_names_record_size(names);
+      PR_CHECK(size % 8 == 0);
+      report_snapshot::encode_names_record(names, file.reserve(size));
+      file.commit(size);
+      for (uint64_t k = 0; k < 200; k++) {
+        report_snapshot a_snapshot;
+        a_snapshot.sequence   = k;
+        a_snapshot.last       = (k == 199);
+        a_snapshot.elapsed    = 0.5 * k;
+        a_snapshot.events     = 100 * k;
+        a_snapshot.job_events = 100 * k;
+        a_snapshot.throughput = 200.0;
+        for (size_t c = 0; c < names.size(); c++) {
+          a_snapshot.counters.push_back(100 * k);
+          a_snapshot.counters.push_back(60 * k + c);
+          a_snapshot.counters.push_back(40 * k - c);
+        }
+        log_snapshot(file, a_snapshot);
+        logged.push_back(a_snapshot);
+      }
+      // Committed data is readable while the file is open
+      std::string data;
+      PR_CHECK(mapped_report_file::read(filename, data));
+      PR_CHECK(data.size() == file.get_committed_size());
+      file.close();
+    }
+
+    std::string data;
+    PR_CHECK(mapped_report_file::read(filename, data));
+    std::vector<report_snapshot> decoded;
+    PR_CHECK(report_snapshot::decode_log(data, decoded));
+    PR_CHECK(decoded.size() == logged.size());
+    for (size_t k = 0; k < decoded.size() && k < logged.size(); k++) {
+      PR_CHECK(decoded[k].sequence == logged[k].sequence);
+      PR_CHECK(decoded[k].last == logged[k].last);
+      PR_CHECK(decoded[k].events == logged[k].events);
+      PR_CHECK_CLOSE(decoded[k].elapsed, logged[k].elapsed, 1e-12);
+      PR_CHECK(decoded[k].counters == logged[k].counters);
+    }
+    if (! decoded.empty()) {
+      PR_CHECK(decoded.back().find_cut("vertex_cut") == 1);
+      PR_CHECK(decoded.back().get_accepted(1) == 60 * 199 + 1);
+    }
+
+    // A truncated log keeps its complete records
+    decoded.clear();
+    PR_CHECK(! report_snapshot::decode_log(data.substr(0, data.size() - 4), decoded));
+    PR_CHECK(decoded.size() == logged.size() - 1);
+    std::remove(filename.c_str());
+    return;
+  }
+
+  void test_text()
+  {
+    const std::string filename = "test_mapped_report_file.txt";
+    std::string expected;
+    {
+      mapped_report_file file;
+      file.open(filename, 1);
+      std::ostream out(&file);
+      for (int i = 0; i < 2000; i++) {
+        out << "line " << i << std::endl;
+        expected += "line " + std::to_string(i) + "\n";
+      }
+      PR_CHECK(out.good());
+      file.close();
+    }
+    std::string data;
+    PR_CHECK(mapped_report_file::read(filename, data));
+    PR_CHECK(data == expected);
+    std::remove(filename.c_str());
+    return;
+  }
+
+}
+
+int main()
+{
+  test_snapshot_log();
+  test_text();
+  return snemo::processing::testing::test_status();
+}
@@ -0,0 +1,111 @@
+// test_report_checkpoint.cxx
+//
+// Check the checkpoint file format: round trip through the file, payload
+// completed with shared blocks by the writer thread, and rejection of
+// corrupted files (bad magic, bad checksum, truncated payload, payload
+// size beyond the end of the file).
+
+// Standard library:
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+// This project:
+#include <falaise/snemo/processing/report_checkpoint.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::report_checkpoint;
+
+namespace {
+
+  const std::string filename = "test_report_checkpoint.ckp";
+
+  std::string read_file()
+  {
+    std::ifstream fin(filename.c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+  }
+
+  void write_file(const std::string & content_)
+  {
+    std::ofstream fout(filename.c_str(), std::ios::binary | std::ios::trunc);
+    fout.write(content_.data(), content_.size());
+    return;
+  }
+
+  void test_round_trip()
+  {
+    const std::string payload("checkpoint\0payload", 18);
+    report_checkpoint::write(filename, payload);
+    std::string loaded;
+    PR_CHECK(report_checkpoint::load(filename, loaded));
+    PR_CHECK(loaded == payload);
+    // Magic word, size, payload and checksum
+    PR_CHECK(read_file().size() == 8 + 8 + payload.size() + 8);
+
+    report_checkpoint::write(filename, std::string());
+    PR_CHECK(report_checkpoint::load(filename, loaded));
+    PR_CHECK(loaded.empty());
+    PR_CHECK(! report_checkpoint::load("missing_checkpoint.ckp", loaded));
+    return;
+  }
+
+  void test_writer_thread()
+  {
+    report_checkpoint writer;
+    writer.set_filename(filename);
+    writer.start();
+    std::string payload = "head:";
+    snemo::processing::state_block_list blocks;
+    blocks.push_back(std::make_shared<const std::string>("block1,"));
+    blocks.push_back(std::make_shared<const std::string>("block2"));
+    writer.submit(payload, blocks);
+    writer.stop();
+    PR_CHECK(writer.get_number_of_writes() >= 1);
+    std::string loaded;
+    PR_CHECK(report_checkpoint::load(filename, loaded));
+    PR_CHECK(loaded == "head:block1,block2");
+    return;
+  }
+
+  void test_corrupted()
+  {
+    report_checkpoint::write(filename, "a valid payload");
+    const std::string valid = read_file();
+    std::string loaded;
+
+    std::string bad_magic = valid;
+    bad_magic[0] = 'X';
+    write_file(bad_magic);
+    PR_CHECK(! report_checkpoint::load(filename, loaded));
+
+    std::string bad_checksum = valid;
+    bad_checksum[16] ^= 0x01;
+    write_file(bad_checksum);
+    PR_CHECK(! report_checkpoint::load(filename, loaded));
+
+    write_file(valid.substr(0, valid.size() - 4));
+    PR_CHECK(! report_checkpoint::load(filename, loaded));
+
+    // A huge size must be rejected before any allocation
+    std::string bad_size = valid;
+    bad_size[15] = (char) 0x7F;
+    write_file(bad_size);
+    PR_CHECK(! report_checkpoint::load(filename, loaded));
+    return;
+  }
+
+}
+
+int main()
+{
+  test_round_trip();
+  test_writer_thread();
+  test_corrupted();
+  std::remove(filename.c_str());
+  return snemo::processing::testing::test_status();
+}
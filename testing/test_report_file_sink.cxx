@@ -0,0 +1,77 @@
+// test_report_file_sink.cxx
+//
+// Check the block file sink: text written through a stream is found
+// unchanged in the file after close, and a failure of the writer thread
+// is rethrown on the caller thread instead of being lost.
+
+// Standard library:
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+// This project:
+#include <falaise/snemo/processing/report_file_sink.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::report_file_sink;
+
+namespace {
+
+  void test_round_trip()
+  {
+    const std::string filename = "test_report_file_sink.txt";
+    std::string expected;
+    {
+      report_file_sink sink;
+      sink.open(filename, report_file_sink::COMPRESSION_NONE, 64);
+      std::ostream out(&sink);
+      for (int i = 0; i < 1000; i++) {
+        out << "line " << i << std::endl;
+        expected += "line " + std::to_string(i) + "\n";
+      }
+      sink.flush_block();
+      sink.close();
+      PR_CHECK(out.good());
+      PR_CHECK(sink.get_input_size() == expected.size());
+      PR_CHECK(sink.get_output_size() == expected.size());
+    }
+    std::ifstream fin(filename.c_str(), std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+    PR_CHECK(content == expected);
+    std::remove(filename.c_str());
+    return;
+  }
+
+  void test_write_failure()
+  {
+    // Every write to /dev/full fails with ENOSPC
+    if (::access("/dev/full", W_OK) != 0) return;
+    report_file_sink sink;
+    sink.open("/dev/full", report_file_sink::COMPRESSION_NONE, 16);
+    std::ostream out(&sink);
+    bool thrown = false;
+    try {
+      for (int i = 0; i < 100; i++) out << "some report text" << std::endl;
+      sink.close();
+    } catch (std::exception &) {
+      thrown = true;
+    }
+    PR_CHECK(thrown);
+    PR_CHECK(! sink.is_open());
+    return;
+  }
+
+}
+
+int main()
+{
+  test_round_trip();
+  test_write_failure();
+  return snemo::processing::testing::test_status();
+}
@@ -0,0 +1,136 @@
+// test_sampling_policy.cxx
+//
+// Check the event sampling policies: sampling period and weights of the
+// 'every' mode, rate and reproducibility of the Bernoulli mode, and
+// uniformity of the reservoir mode.
+
+// Standard library:
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux/datatools:
+#include <bayeux/datatools/properties.h>
+
+// This project:
+#include <falaise/snemo/processing/sampling_policy.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::sampling_policy;
+
+namespace {
+
+  void test_every()
+  {
+    datatools::properties config;
+    config.store("mode", "every");
+    config.store("every", 10);
+    sampling_policy policy;
+    policy.initialize(config);
+    PR_CHECK(policy.is_estimate());
+    size_t sampled = 0;
+    bool weights_ok = true;
+    for (size_t i = 0; i < 1000; i++) {
+      if (policy.sample()) {
+        sampled++;
+        if (policy.get_weight() != 10) weights_ok = false;
+      }
+    }
+    PR_CHECK(sampled == 100);
+    PR_CHECK(weights_ok);
+    PR_CHECK(policy.get_number_of_events() == 1000);
+    PR_CHECK_CLOSE(policy.get_scale(), 10.0, 1e-12);
+    return;
+  }
+
+  void test_bernoulli()
+  {
+    datatools::properties config;
+    config.store("mode", "bernoulli");
+    config.store("probability", 0.1);
+    config.store("seed", 314159);
+    sampling_policy first;
+    sampling_policy second;
+    first.initialize(config);
+    second.initialize(config);
+    const size_t nevents = 100000;
+    uint64_t sum_weights = 0;
+    bool same_sequence = true;
+    for (size_t i = 0; i < nevents; i++) {
+      const bool sampled = first.sample();
+      if (sampled != second.sample()) same_sequence = false;
+      if (sampled) sum_weights += first.get_weight();
+    }
+    // Binomial fluctuation of the number of sampled events, 5 sigma
+    const double expected = 0.1 * nevents;
+    const double sigma = std::sqrt(nevents * 0.1 * 0.9);
+    PR_CHECK(std::abs(first.get_number_of_sampled_events() - expected) < 5.0 * sigma);
+    PR_CHECK(same_sequence);
+    // Weights add up to the events seen up to the last sampled one
+    PR_CHECK(sum_weights <= nevents);
+    PR_CHECK(sum_weights + 200 > nevents);
+    return;
+  }
+
+  void test_reservoir()
+  {
+    const size_t reservoir_size = 10;
+    const size_t nevents = 100;
+    const size_t ntrials = 20000;
+    std::vector<size_t> kept(nevents, 0);
+    for (size_t trial = 0; trial < ntrials; trial++) {
+      datatools::properties config;
+      config.store("mode", "reservoir");
+      config.store("reservoir_size", (int) reservoir_size);
+      config.store("seed", (int) trial + 1);
+      sampling_policy policy;
+      policy.initialize(config);
+      std::vector<size_t> reservoir(reservoir_size, nevents);
+      for (size_t event = 0; event < nevents; event++) {
+        if (policy.sample()) reservoir[policy.get_slot()] = event;
+      }
+      for (size_t i = 0; i < reservoir_size; i++) {
+        if (reservoir[i] < nevents) kept[reservoir[i]]++;
+      }
+    }
+    // Each event is kept with probability K/N
+    const double p = (double) reservoir_size / nevents;
+    const double expected = p * ntrials;
+    const double sigma = std::sqrt(ntrials * p * (1.0 - p));
+    size_t outliers = 0;
+    for (size_t event = 0; event < nevents; event++) {
+      if (std::abs(kept[event] - expected) > 5.0 * sigma) outliers++;
+    }
+    PR_CHECK(outliers == 0);
+    return;
+  }
+
+  void test_invalid()
+  {
+    datatools::properties config;
+    config.store("mode", "every");
+    config.store("every", 0);
+    sampling_policy policy;
+    bool thrown = false;
+    try {
+      policy.initialize(config);
+    } catch (std::exception &) {
+      thrown = true;
+    }
+    PR_CHECK(thrown);
+    return;
+  }
+
+}
+
+int main()
+{
+  test_every();
+  test_bernoulli();
+  test_reservoir();
+  test_invalid();
+  return snemo::processing::testing::test_status();
+}
@@ -0,0 +1,133 @@
+// test_state_io.cxx
+//
+// Check the binary state encoding used by checkpoints: round trip of all
+// value types, nested sections, sections whose content is appended later,
+// and rejection of truncated input.
+
+// Standard library:
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// This project:
+#include <falaise/snemo/processing/state_io.h>
+
+// Ourselves:
+#include "test_checks.h"
+
+using snemo::processing::state_writer;
+using snemo::processing::state_reader;
+using snemo::processing::make_state_tag;
+
+namespace {
+
+  void test_round_trip()
+  {
+    std::vector<double> values;
+    values.push_back(0.0);
+    values.push_back(-1.5e-300);
+    values.push_back(std::numeric_limits<double>::infinity());
+    state_writer writer;
+    writer.write_uint32(0xDEADBEEF);
+    writer.write_uint64(0xFFFFFFFFFFFFFFFFULL);
+    writer.write_int64(-42);
+    writer.write_double(3.14159);
+    writer.write_string(std::string("with\0null", 9));
+    writer.write_doubles(values);
+    // Little-endian whatever the host
+    PR_CHECK((unsigned char) writer.get_data()[0] == 0xEF);
+
+    state_reader reader(writer.get_data());
+    PR_CHECK(reader.read_uint32() == 0xDEADBEEF);
+    PR_CHECK(reader.read_uint64() == 0xFFFFFFFFFFFFFFFFULL);
+    PR_CHECK(reader.read_int64() == -42);
+    PR_CHECK(reader.read_double() == 3.14159);
+    PR_CHECK(reader.read_string() == std::string("with\0null", 9));
+    std::vector<double> read_values;
+    reader.read_doubles(read_values);
+    PR_CHECK(read_values == values);
+    PR_CHECK(reader.at_end());
+    return;
+  }
+
+  void test_sections()
+  {
+    const uint32_t outer_tag = make_state_tag('O', 'U', 'T', 'R');
+    const uint32_t inner_tag = make_state_tag('I', 'N', 'N', 'R');
+    const uint32_t late_tag  = make_state_tag('L', 'A', 'T', 'E');
+    state_writer writer;
+    size_t outer = writer.begin_section(outer_tag);
+    writer.write_uint64(1);
+    size_t inner = writer.begin_section(inner_tag);
+    writer.write_string("inner");
+    writer.end_section(inner);
+    writer.write_uint64(2);
+    writer.end_section(outer);
+    // Content appended after the encoded data, as done by the checkpoint writer
+    state_writer late;
+    late.write_uint64(7);
+    late.write_uint64(8);
+    writer.write_section_header(late_tag, late.get_data().size());
+    const std::string data = writer.get_data() + late.get_data();
+
+    state_reader reader(data);
+    uint32_t tag = 0;
+    state_reader outer_reader = reader.read_section(tag);
+    PR_CHECK(tag == outer_tag);
+    PR_CHECK(outer_reader.read_uint64() == 1);
+    state_reader inner_reader = outer_reader.read_section(tag);
+    PR_CHECK(tag == inner_tag);
+    PR_CHECK(inner_reader.read_string() == "inner");
+    PR_CHECK(inner_reader.at_end());
+    PR_CHECK(outer_reader.read_uint64() == 2);
+    PR_CHECK(outer_reader.at_end());
+    state_reader late_reader = reader.read_section(tag);
+    PR_CHECK(tag == late_tag);
+    PR_CHECK(late_reader.read_uint64() == 7);
+    PR_CHECK(late_reader.read_uint64() == 8);
+    PR_CHECK(late_reader.at_end());
+    PR_CHECK(reader.at_end());
+    return;
+  }
+
+  void test_truncated()
+  {
+    state_writer writer;
+    writer.write_string("truncated string");
+    const std::string data = writer.get_data().substr(0, writer.get_data().size() - 1);
+    state_reader reader(data);
+    bool thrown = false;
+    try {
+      reader.read_string();
+    } catch (std::exception &) {
+      thrown = true;
+    }
+    PR_CHECK(thrown);
+
+    // A section larger than the remaining data is rejected
+    state_writer bad;
+    bad.write_section_header(make_state_tag('B', 'A', 'D', '_'), 1000);
+    bad.write_uint64(0);
+    state_reader bad_reader(bad.get_data());
+    uint32_t tag = 0;
+    thrown = false;
+    try {
+      bad_reader.read_section(tag);
+    } catch (std::exception &) {
+      thrown = true;
+    }
+    PR_CHECK(thrown);
+    return;
+  }
+
+}
+
+int main()
+{
+  test_round_trip();
+  test_sections();
+  test_truncated();
+  return snemo::processing::testing::test_status();
+}